@@ -4,6 +4,10 @@ ViewportPredictionSimulate::usage = UsageString@"ViewportPredictionSimulate[`win
 
 ABRSimulate360::usage = UsageString@"ABRSimulate360[`streamingConfig`, {`controller`, `allocator`}, {`networkData`, `viewportData`}] simulates a 360\[Degree] adaptive bitrate streaming configuration on a collection of network series and viewport series.";
 
+ABRSimulate360Sweep::usage = UsageString@"ABRSimulate360Sweep[`streamingConfig`, {{`controller`, `allocator`}, ...}, {`networkData`, `viewportData`}] simulates a list of 360\[Degree] adaptive bitrate streaming configurations on a collection of network series and viewport series.";
+
+ABRSimulate360Fork::usage = UsageString@"ABRSimulate360Fork[`streamingConfig`, {`controller`, `allocator`}, `forkSegment`, {{`controller`, `allocator`}, ...}, {`networkData`, `viewportData`}] simulates branches of 360\[Degree] adaptive bitrate streaming configurations that share a common prefix until `forkSegment` on a collection of network series and viewport series.";
+
 Begin["`Private`"];
 
 $ContextAliases["LLU`"] = "LibraryLinkUtilities`Private`LLU`";
@@ -19,17 +23,60 @@ ViewportPredictionSimulate[windowLength_Integer, segmentSeconds_Real,
 
 LLU`PacletFunctionSet[$ABRSimulate360, {"Object", "TypedOptions", "TypedOptions",
     LibraryDataType[TemporalData, Real], LibraryDataType[TemporalData, Real],
-    "TypedOptions", "TypedOptions"}, "DataStore"];
+    "TypedOptions", "TypedOptions", "Object", Real, "UTF8String", "Boolean", "Boolean", "UTF8String", "UTF8String",
+    Integer, Integer, Integer}, "DataStore"];
 
-Options[ABRSimulate360] = {
+$simulationOptions = {
     "ThroughputPredictor" -> "EMAPredictor",
-    "ViewportPredictor" -> "StaticPredictor"
+    "ViewportPredictor" -> "StaticPredictor",
+    "ViewportSimulator" -> <||>,
+    "DilationStep" -> 0.,
+    "DistributionCachePath" -> None,
+    "UsesNetworkIndex" -> False,
+    "TracePath" -> None,
+    "Seed" -> 0
 };
 
+Options[ABRSimulate360] = Join[$simulationOptions,
+    {"Instrumentation" -> False, "OutputMode" -> "Full", "ReplicaCount" -> 0, "LaneCount" -> 0}];
+
 ABRSimulate360[streamingConfig_Association, {controller : _String | _List, allocator : _String | _List},
     {networkData_TemporalData, viewportData_TemporalData}, options : OptionsPattern[]] :=
         Association @@ $ABRSimulate360[streamingConfig, controller, allocator, networkData, viewportData,
-            OptionValue["ThroughputPredictor"], OptionValue["ViewportPredictor"]];
+            OptionValue["ThroughputPredictor"], OptionValue["ViewportPredictor"], OptionValue["ViewportSimulator"],
+            N@OptionValue["DilationStep"], Replace[OptionValue["DistributionCachePath"], None -> ""],
+            OptionValue["UsesNetworkIndex"], OptionValue["Instrumentation"], OptionValue["OutputMode"],
+            Replace[OptionValue["TracePath"], None -> ""], OptionValue["Seed"], OptionValue["ReplicaCount"],
+            OptionValue["LaneCount"]];
+
+LLU`PacletFunctionSet[$ABRSimulate360Sweep, {"Object", {"TypedOptions", 1}, {"TypedOptions", 1},
+    LibraryDataType[TemporalData, Real], LibraryDataType[TemporalData, Real],
+    "TypedOptions", "TypedOptions", "Object", Real, "UTF8String", "Boolean", "UTF8String", Integer}, "DataStore"];
+
+Options[ABRSimulate360Sweep] = $simulationOptions;
+
+ABRSimulate360Sweep[streamingConfig_Association, configs : {{_String | _List, _String | _List} ..},
+    {networkData_TemporalData, viewportData_TemporalData}, options : OptionsPattern[]] :=
+        Association @@ $ABRSimulate360Sweep[streamingConfig, configs[[All, 1]], configs[[All, 2]],
+            networkData, viewportData,
+            OptionValue["ThroughputPredictor"], OptionValue["ViewportPredictor"], OptionValue["ViewportSimulator"],
+            N@OptionValue["DilationStep"], Replace[OptionValue["DistributionCachePath"], None -> ""],
+            OptionValue["UsesNetworkIndex"], Replace[OptionValue["TracePath"], None -> ""], OptionValue["Seed"]];
+
+LLU`PacletFunctionSet[$ABRSimulate360Fork, {"Object", "TypedOptions", "TypedOptions", Integer,
+    {"TypedOptions", 1}, {"TypedOptions", 1}, LibraryDataType[TemporalData, Real], LibraryDataType[TemporalData, Real],
+    "TypedOptions", "TypedOptions", "Object", Real, "UTF8String", "Boolean", "UTF8String", Integer}, "DataStore"];
+
+Options[ABRSimulate360Fork] = $simulationOptions;
+
+ABRSimulate360Fork[streamingConfig_Association, {controller : _String | _List, allocator : _String | _List},
+    forkSegment_Integer, branches : {{_String | _List, _String | _List} ..},
+    {networkData_TemporalData, viewportData_TemporalData}, options : OptionsPattern[]] :=
+        Association @@ $ABRSimulate360Fork[streamingConfig, controller, allocator, forkSegment,
+            branches[[All, 1]], branches[[All, 2]], networkData, viewportData,
+            OptionValue["ThroughputPredictor"], OptionValue["ViewportPredictor"], OptionValue["ViewportSimulator"],
+            N@OptionValue["DilationStep"], Replace[OptionValue["DistributionCachePath"], None -> ""],
+            OptionValue["UsesNetworkIndex"], Replace[OptionValue["TracePath"], None -> ""], OptionValue["Seed"]];
 
 End[];
 
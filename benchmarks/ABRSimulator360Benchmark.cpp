@@ -0,0 +1,173 @@
+#include <benchmark/benchmark.h>
+
+import System.Base;
+import System.MDArray;
+
+import ABRSimulation360.ABRSimulator360;
+import ABRSimulation360.AggregateControllers.ModelPredictiveController;
+import ABRSimulation360.AggregateControllers.ThroughputBasedController;
+import ABRSimulation360.Base;
+import ABRSimulation360.Benchmarks.SyntheticData;
+import ABRSimulation360.BitrateAllocators.DragonflyAllocator;
+import ABRSimulation360.BitrateAllocators.HybridAllocator;
+import ABRSimulation360.NetworkSimulator;
+import ABRSimulation360.ThroughputPredictors.EMAPredictor;
+import ABRSimulation360.ViewportPredictors.LinearPredictor;
+
+using namespace std;
+using namespace experimental;
+
+// Arguments: tiling count, ladder size.
+static void BM_ABRSimulator360Session(benchmark::State &state) {
+    const auto streamingConfig = SyntheticStreamingConfig(static_cast<int>(state.range(0)),
+                                                          static_cast<int>(state.range(1)));
+    const auto tileCount = streamingConfig.TilingCount * streamingConfig.TilingCount * 6;
+    constexpr auto segmentCount = 60;
+    const auto throughputsMbps = SyntheticNetworkTrace(segmentCount * 10);
+    const NetworkSeriesView networkSeries = {0.1, throughputsMbps};
+    const auto positions = SyntheticViewportTrace(segmentCount * 30);
+    const ViewportSeriesView viewportSeries = {1 / 30., positions};
+
+    double rebufferingSeconds;
+    mdarray<double, dims<2>> bufferedBitratesMbps(segmentCount, tileCount);
+    mdarray<double, dims<2>> distributions(segmentCount, tileCount);
+    mdarray<double, dims<2>> predictedDistributions(segmentCount - 1, tileCount);
+    vector<double> allocationUs(segmentCount - 1);
+    const SimulationSeriesRef simulationSeries = {
+        rebufferingSeconds, bufferedBitratesMbps.to_mdspan(),
+        distributions.to_mdspan(), predictedDistributions.to_mdspan(), allocationUs
+    };
+    const LinearPredictorOptions viewportPredictorOptions;
+    const ABRSimulation360Options options = {.ViewportPredictorOptions = viewportPredictorOptions};
+    for (auto _ : state)
+        ABRSimulator360::Simulate(streamingConfig, ModelPredictiveControllerOptions(), HybridAllocatorOptions(),
+                                  networkSeries, viewportSeries, simulationSeries, options);
+    state.SetItemsProcessed(state.iterations() * segmentCount);
+}
+
+BENCHMARK(BM_ABRSimulator360Session)
+    ->ArgNames({"TilingCount", "LadderSize"})
+    ->ArgsProduct({{1, 2, 4, 8, 16}, {4, 8}})
+    ->Unit(benchmark::kMillisecond);
+
+// Compares a session that dispatches its components through interfaces with a session specialized on their types.
+// Arguments: tiling count.
+template<typename TAllocator, typename TAllocatorOptions, bool IsSpecialized>
+static void BM_ABRSimulator360Dispatch(benchmark::State &state) {
+    const auto streamingConfig = SyntheticStreamingConfig(static_cast<int>(state.range(0)), 8);
+    const auto tileCount = streamingConfig.TilingCount * streamingConfig.TilingCount * 6;
+    constexpr auto segmentCount = 60;
+    const auto throughputsMbps = SyntheticNetworkTrace(segmentCount * 10);
+    const NetworkSeriesView networkSeries = {0.1, throughputsMbps};
+    const auto positions = SyntheticViewportTrace(segmentCount * 30);
+    const ViewportSeriesView viewportSeries = {1 / 30., positions};
+
+    double rebufferingSeconds;
+    mdarray<double, dims<2>> bufferedBitratesMbps(segmentCount, tileCount);
+    mdarray<double, dims<2>> distributions(segmentCount, tileCount);
+    mdarray<double, dims<2>> predictedDistributions(segmentCount - 1, tileCount);
+    vector<double> allocationUs(segmentCount - 1);
+    const SimulationSeriesRef simulationSeries = {
+        rebufferingSeconds, bufferedBitratesMbps.to_mdspan(),
+        distributions.to_mdspan(), predictedDistributions.to_mdspan(), allocationUs
+    };
+    const ThroughputBasedControllerOptions controllerOptions;
+    const TAllocatorOptions allocatorOptions;
+    // Computes the viewport distributions once, which sessions expect in their output.
+    ABRSimulator360::Simulate(streamingConfig, controllerOptions, allocatorOptions,
+                              networkSeries, viewportSeries, simulationSeries);
+    for (auto _ : state)
+        if constexpr (IsSpecialized)
+            BasicABRSession360<EMAPredictor, ThroughputBasedController, TAllocator>(
+                streamingConfig,
+                SessionComponent<ThroughputBasedController>(ThroughputBasedController(streamingConfig)),
+                SessionComponent<TAllocator>(TAllocator(streamingConfig, allocatorOptions)),
+                SessionComponent<EMAPredictor>(EMAPredictor()),
+                NetworkSimulator(networkSeries), viewportSeries, simulationSeries).Run();
+        else
+            ABRSession360(streamingConfig, controllerOptions, allocatorOptions,
+                          NetworkSimulator(networkSeries), viewportSeries, simulationSeries).Run();
+    state.SetItemsProcessed(state.iterations() * segmentCount);
+}
+
+#define BENCHMARK_DISPATCH(T) \
+    BENCHMARK_TEMPLATE(BM_ABRSimulator360Dispatch, T, T##Options, false)->ArgName("TilingCount")->Arg(1)->Arg(4); \
+    BENCHMARK_TEMPLATE(BM_ABRSimulator360Dispatch, T, T##Options, true)->ArgName("TilingCount")->Arg(1)->Arg(4)
+
+BENCHMARK_DISPATCH(DragonflyAllocator);
+BENCHMARK_DISPATCH(HybridAllocator);
+
+// Arguments: client count.
+static void BM_ABRSimulator360SharedLink(benchmark::State &state) {
+    const auto clientCount = static_cast<int>(state.range(0));
+    const auto streamingConfig = SyntheticStreamingConfig(4, 8);
+    const auto tileCount = streamingConfig.TilingCount * streamingConfig.TilingCount * 6;
+    constexpr auto segmentCount = 60;
+    auto capacitiesMbps = SyntheticNetworkTrace(segmentCount * 10);
+    for (auto &capacityMbps : capacitiesMbps) capacityMbps *= clientCount;
+    const NetworkSeriesView linkSeries = {0.1, capacitiesMbps};
+    const auto positions = SyntheticViewportTrace(segmentCount * 30);
+    const vector<ViewportSeriesView> viewportSeries(clientCount, {1 / 30., positions});
+    vector<double> startSeconds(clientCount);
+    for (auto i = 0; i < clientCount; ++i) startSeconds[i] = i * streamingConfig.SegmentSeconds / clientCount;
+
+    vector<unique_ptr<SimulationSeriesBuffer>> buffers;
+    vector<SimulationSeriesRef> out;
+    for (auto i = 0; i < clientCount; ++i)
+        out.push_back(buffers.emplace_back(make_unique<SimulationSeriesBuffer>(segmentCount, tileCount))->Ref());
+    for (auto _ : state)
+        ABRSimulator360::SimulateSharedLink(streamingConfig, ThroughputBasedControllerOptions(),
+                                            HybridAllocatorOptions(), linkSeries, viewportSeries, startSeconds,
+                                            EqualSharePolicy(), out);
+    state.SetItemsProcessed(state.iterations() * clientCount * segmentCount);
+}
+
+BENCHMARK(BM_ABRSimulator360SharedLink)
+    ->ArgName("ClientCount")
+    ->RangeMultiplier(8)->Range(8, 4096)
+    ->Unit(benchmark::kMillisecond);
+
+// Arguments: lane count (0 for sessions simulated one by one).
+static void BM_ABRSimulator360Batch(benchmark::State &state) {
+    const auto laneCount = static_cast<int>(state.range(0));
+    const auto streamingConfig = SyntheticStreamingConfig(4, 8);
+    const auto tileCount = streamingConfig.TilingCount * streamingConfig.TilingCount * 6;
+    constexpr auto sessionCount = 256, segmentCount = 60;
+    const auto throughputsMbps = SyntheticNetworkTrace(segmentCount * 10);
+    const NetworkSeriesView networkSeries = {0.1, throughputsMbps};
+    const auto positions = SyntheticViewportTrace(segmentCount * 30);
+    const ViewportSeriesView viewportSeries = {1 / 30., positions};
+
+    vector<unique_ptr<SimulationSeriesBuffer>> buffers;
+    vector<SimulationSeriesRef> out;
+    for (auto i = 0; i < sessionCount; ++i)
+        out.push_back(buffers.emplace_back(make_unique<SimulationSeriesBuffer>(segmentCount, tileCount))->Ref());
+    // Computes the viewport distributions once, which sessions expect in their output.
+    for (const auto &series : out)
+        ABRSimulator360::Simulate(streamingConfig, ThroughputBasedControllerOptions(), HybridAllocatorOptions(),
+                                  networkSeries, viewportSeries, series);
+    const vector networkSimulators(sessionCount, NetworkSimulator(networkSeries));
+    const vector allViewportSeries(sessionCount, viewportSeries);
+    for (auto _ : state)
+        if (laneCount == 0)
+            for (const auto &series : out)
+                BasicABRSession360<EMAPredictor, ThroughputBasedController, HybridAllocator>(
+                    streamingConfig,
+                    SessionComponent<ThroughputBasedController>(ThroughputBasedController(streamingConfig)),
+                    SessionComponent<HybridAllocator>(HybridAllocator(streamingConfig)),
+                    SessionComponent<EMAPredictor>(EMAPredictor()),
+                    NetworkSimulator(networkSeries), viewportSeries, series).Run();
+        else
+            for (auto beginID = 0; beginID < sessionCount; beginID += laneCount)
+                BasicABRSessionBatch360<EMAPredictor, ThroughputBasedController, HybridAllocator>(
+                    streamingConfig, ThroughputBasedController(streamingConfig), HybridAllocator(streamingConfig),
+                    EMAPredictor(), span(networkSimulators).subspan(beginID, laneCount),
+                    span(allViewportSeries).subspan(beginID, laneCount),
+                    span(out).subspan(beginID, laneCount)).Run();
+    state.SetItemsProcessed(state.iterations() * sessionCount * segmentCount);
+}
+
+BENCHMARK(BM_ABRSimulator360Batch)
+    ->ArgName("LaneCount")
+    ->Arg(0)->Arg(8)->Arg(64)
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,34 @@
+#include <benchmark/benchmark.h>
+
+import System.Base;
+
+import ABRSimulation360.AggregateControllers.IAggregateController;
+import ABRSimulation360.AggregateControllers.ModelPredictiveController;
+import ABRSimulation360.Base;
+import ABRSimulation360.Benchmarks.SyntheticData;
+
+using namespace std;
+
+// Arguments: window length, buffer resolution in milliseconds (0 for exhaustive search), ladder size.
+static void BM_ModelPredictiveController(benchmark::State &state) {
+    const auto streamingConfig = SyntheticStreamingConfig(1, static_cast<int>(state.range(2)));
+    ModelPredictiveControllerOptions options;
+    options.WindowLength = static_cast<int>(state.range(0));
+    options.BufferResolutionSeconds = state.range(1) / 1000.;
+    ModelPredictiveController controller(streamingConfig, options);
+
+    const array throughputsMbps = {10., 20., 40., 80.};
+    const array buffersSeconds = {1., 2.5, 4.};
+    auto i = 0;
+    for (auto _ : state) {
+        const AggregateControllerContext context = {throughputsMbps[i % 4], buffersSeconds[i % 3]};
+        benchmark::DoNotOptimize(controller.GetAggregateBitrateMbps(context));
+        ++i;
+    }
+}
+
+BENCHMARK(BM_ModelPredictiveController)
+    ->ArgNames({"WindowLength", "BufferResolutionMs", "LadderSize"})
+    ->ArgsProduct({{1, 2, 3, 4, 5, 6}, {0}, {4}})
+    ->ArgsProduct({{1, 2, 3, 4}, {0}, {8}})
+    ->ArgsProduct({{1, 2, 4, 8, 12, 16}, {50, 100}, {4, 8}});
@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+
+import System.Base;
+
+import ABRSimulation360.Base;
+import ABRSimulation360.Benchmarks.SyntheticData;
+import ABRSimulation360.BitrateAllocators.BOLAAllocator;
+import ABRSimulation360.BitrateAllocators.DragonflyAllocator;
+import ABRSimulation360.BitrateAllocators.FlareAllocator;
+import ABRSimulation360.BitrateAllocators.HybridAllocator;
+import ABRSimulation360.BitrateAllocators.IBitrateAllocator;
+import ABRSimulation360.BitrateAllocators.OnlineLearningAllocator;
+import ABRSimulation360.BitrateAllocators.ProbDASHAllocator;
+import ABRSimulation360.ViewportSimulator;
+
+using namespace std;
+
+// Arguments: tiling count, ladder size.
+template<typename TAllocator>
+static void BM_BitrateAllocator(benchmark::State &state) {
+    const auto streamingConfig = SyntheticStreamingConfig(static_cast<int>(state.range(0)),
+                                                          static_cast<int>(state.range(1)));
+    const auto tileCount = streamingConfig.TilingCount * streamingConfig.TilingCount * 6;
+    TAllocator allocator(streamingConfig);
+
+    // Alternates between segments so that stateful allocators see changing predictions.
+    constexpr auto segmentCount = 8;
+    const auto positions = SyntheticViewportTrace(segmentCount * 30);
+    vector<vector<double>> distributions(segmentCount);
+    for (auto i = 0; i < segmentCount; ++i) distributions[i] = SyntheticViewportDistribution(tileCount, i);
+    DilatedViewportSimulator dilatedViewportSimulator(streamingConfig.ViewportConfig, streamingConfig.TilingCount);
+    const array buffersSeconds = {1., 2.5, 4.};
+    const auto maxBitrateMbps = streamingConfig.BitratesPerFaceMbps.back() * 6;
+    vector<int> bitrateIDs(tileCount);
+    auto i = 0;
+    for (auto _ : state) {
+        const auto segmentID = i % segmentCount;
+        dilatedViewportSimulator.SetPositions(span(positions).subspan(segmentID * 30, 30));
+        const auto DilatedDistribution = [&](double dilation) {
+            return dilatedViewportSimulator.ToDistribution(dilation);
+        };
+        const BitrateAllocatorContext context = {
+            maxBitrateMbps / (1 << i % 4), buffersSeconds[i % 3], distributions[segmentID],
+            distributions[(segmentID + segmentCount - 1) % segmentCount], DilatedDistribution
+        };
+        allocator.GetBitrateIDs(context, bitrateIDs);
+        benchmark::DoNotOptimize(bitrateIDs.data());
+        ++i;
+    }
+}
+
+#define BENCHMARK_ALLOCATOR(T) \
+    BENCHMARK_TEMPLATE(BM_BitrateAllocator, T) \
+        ->ArgNames({"TilingCount", "LadderSize"}) \
+        ->ArgsProduct({{1, 2, 4, 8, 16}, {4, 8}})
+
+BENCHMARK_ALLOCATOR(BOLAAllocator);
+BENCHMARK_ALLOCATOR(DragonflyAllocator);
+BENCHMARK_ALLOCATOR(FlareAllocator);
+BENCHMARK_ALLOCATOR(HybridAllocator);
+BENCHMARK_ALLOCATOR(OnlineLearningAllocator);
+BENCHMARK_ALLOCATOR(ProbDASHAllocator);
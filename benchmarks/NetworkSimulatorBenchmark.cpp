@@ -0,0 +1,25 @@
+#include <benchmark/benchmark.h>
+
+import System.Base;
+
+import ABRSimulation360.Base;
+import ABRSimulation360.Benchmarks.SyntheticData;
+import ABRSimulation360.NetworkSimulator;
+
+using namespace std;
+
+// Arguments: interval of the network series in milliseconds, segment size in kilobytes, whether to index the series.
+static void BM_NetworkSimulatorDownload(benchmark::State &state) {
+    const auto intervalSeconds = state.range(0) / 1000.;
+    const auto sizeMB = state.range(1) / 1000.;
+    const auto throughputsMbps = SyntheticNetworkTrace(static_cast<int>(600 / intervalSeconds));
+    const NetworkSeriesView networkSeries = {intervalSeconds, throughputsMbps};
+    const NetworkTraceIndex index(networkSeries);
+    auto simulator = state.range(2) ? NetworkSimulator(index) : NetworkSimulator(networkSeries);
+
+    for (auto _ : state) benchmark::DoNotOptimize(simulator.Download(sizeMB));
+}
+
+BENCHMARK(BM_NetworkSimulatorDownload)
+    ->ArgNames({"IntervalMs", "SizeKB", "UsesIndex"})
+    ->ArgsProduct({{10, 100, 1000}, {500, 5000}, {0, 1}});
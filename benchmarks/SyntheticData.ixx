@@ -0,0 +1,65 @@
+export module ABRSimulation360.Benchmarks.SyntheticData;
+
+import System.Base;
+import System.Math;
+
+import ABRSimulation360.Base;
+
+using namespace std;
+
+/// Creates a streaming configuration for benchmarks.
+/// @param tilingCount The number of tiles in each direction on a cubemap face.
+/// @param ladderSize The number of available bitrates, which double from 1 megabit per second per face.
+/// @returns A streaming configuration with one-second segments and a five-second buffer.
+export StreamingConfig SyntheticStreamingConfig(int tilingCount, int ladderSize) {
+    vector<double> bitratesPerFaceMbps(ladderSize);
+    for (auto i = 0; i < ladderSize; ++i) bitratesPerFaceMbps[i] = ldexp(1., i);
+    return {1., move(bitratesPerFaceMbps), tilingCount, {90., 1.}, 5.};
+}
+
+/// Creates a viewport series following a random walk with occasional fast turns.
+/// @param sampleCount The number of viewport positions.
+/// @param seed The seed of the random walk.
+/// @returns A list of viewport positions.
+export vector<SphericalPosition> SyntheticViewportTrace(int sampleCount, unsigned seed = 0) {
+    default_random_engine randomEngine(seed);
+    normal_distribution pitchStep(0., 1.), yawStep(0., 3.);
+    bernoulli_distribution turns(0.02);
+    vector<SphericalPosition> positions(sampleCount);
+    SphericalPosition position = {0., 0.};
+    for (auto &_position : positions) {
+        const auto yawDegrees = position.YawDegrees + yawStep(randomEngine) + (turns(randomEngine) ? 90. : 0.);
+        position = {
+            SphericalPosition::ClampPitchDegrees(position.PitchDegrees + pitchStep(randomEngine)),
+            SphericalPosition::WrapYawDegrees(yawDegrees)
+        };
+        _position = position;
+    }
+    return positions;
+}
+
+/// Creates a network series with log-normally distributed throughputs.
+/// @param intervalCount The number of intervals.
+/// @param seed The seed of the throughputs.
+/// @returns A list of throughputs in megabits per second.
+export vector<double> SyntheticNetworkTrace(int intervalCount, unsigned seed = 0) {
+    default_random_engine randomEngine(seed);
+    lognormal_distribution throughputMbps(log(20.), 0.5);
+    vector<double> throughputsMbps(intervalCount);
+    for (auto &_throughputMbps : throughputsMbps) _throughputMbps = throughputMbps(randomEngine);
+    return throughputsMbps;
+}
+
+/// Creates a random viewport distribution.
+/// @param tileCount The number of tiles.
+/// @param seed The seed of the distribution.
+/// @returns A viewport distribution that sums to 1.
+export vector<double> SyntheticViewportDistribution(int tileCount, unsigned seed = 0) {
+    default_random_engine randomEngine(seed);
+    exponential_distribution weight(1.);
+    vector<double> distribution(tileCount);
+    for (auto &probability : distribution) probability = weight(randomEngine);
+    const auto totalWeight = Math::Total(span<const double>(distribution));
+    for (auto &probability : distribution) probability /= totalWeight;
+    return distribution;
+}
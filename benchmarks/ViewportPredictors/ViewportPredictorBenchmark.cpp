@@ -0,0 +1,45 @@
+#include <benchmark/benchmark.h>
+
+import System.Base;
+
+import ABRSimulation360.Base;
+import ABRSimulation360.Benchmarks.SyntheticData;
+import ABRSimulation360.ViewportPredictors.IViewportPredictor;
+import ABRSimulation360.ViewportPredictors.LinearPredictor;
+import ABRSimulation360.ViewportPredictors.OfflinePredictor;
+import ABRSimulation360.ViewportPredictors.StaticPredictor;
+
+using namespace std;
+
+// Arguments: sampling rate in hertz, prediction window in milliseconds.
+template<typename TPredictor>
+static void BM_ViewportPredictor(benchmark::State &state) {
+    const auto intervalSeconds = 1. / static_cast<double>(state.range(0));
+    const auto windowSeconds = state.range(1) / 1000.;
+    const auto sampleCountPerSecond = static_cast<int>(state.range(0));
+    // Covers 32 seconds of playback plus the longest prediction window.
+    const auto positions = SyntheticViewportTrace(sampleCountPerSecond * 40);
+    optional<TPredictor> predictor;
+    vector<SphericalPosition> buffer;
+    auto i = 0;
+    for (auto _ : state) {
+        // Restarts the session at the end of the trace, which is amortized over 32 predictions.
+        if (i % 32 == 0) {
+            predictor.emplace(intervalSeconds);
+            if constexpr (is_same_v<TPredictor, OfflinePredictor>) predictor->Initialize({intervalSeconds, positions});
+        }
+        // Advances by one second of playback before each prediction, as in a session with one-second segments.
+        predictor->Update(span(positions).subspan(i % 32 * sampleCountPerSecond, sampleCountPerSecond));
+        benchmark::DoNotOptimize(predictor->PredictPositions(1., windowSeconds, buffer).data());
+        ++i;
+    }
+}
+
+#define BENCHMARK_PREDICTOR(T) \
+    BENCHMARK_TEMPLATE(BM_ViewportPredictor, T) \
+        ->ArgNames({"SamplingRate", "WindowMs"}) \
+        ->ArgsProduct({{10, 30, 100}, {1000, 4000}})
+
+BENCHMARK_PREDICTOR(LinearPredictor);
+BENCHMARK_PREDICTOR(OfflinePredictor);
+BENCHMARK_PREDICTOR(StaticPredictor);
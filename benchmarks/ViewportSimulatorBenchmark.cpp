@@ -0,0 +1,51 @@
+#include <benchmark/benchmark.h>
+
+import System.Base;
+
+import ABRSimulation360.Base;
+import ABRSimulation360.Benchmarks.SyntheticData;
+import ABRSimulation360.ViewportSimulator;
+
+using namespace std;
+
+// Arguments: tiling count, grid resolution in centidegrees (0 for exact computation).
+static void BM_ViewportSimulatorSingle(benchmark::State &state) {
+    const auto tilingCount = static_cast<int>(state.range(0));
+    ViewportSimulatorOptions options;
+    options.GridDegrees = state.range(1) / 100.;
+    ViewportSimulator simulator({90., 1.}, tilingCount, options);
+
+    const auto positions = SyntheticViewportTrace(1024);
+    auto i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(simulator.ToDistribution(positions[i % positions.size()]));
+        ++i;
+    }
+}
+
+// Arguments: tiling count, grid resolution in centidegrees (0 for exact computation), number of positions per batch.
+static void BM_ViewportSimulatorBatched(benchmark::State &state) {
+    const auto tilingCount = static_cast<int>(state.range(0));
+    const auto batchSize = static_cast<int>(state.range(2));
+    ViewportSimulatorOptions options;
+    options.GridDegrees = state.range(1) / 100.;
+    ViewportSimulator simulator({90., 1.}, tilingCount, options);
+
+    const auto positions = SyntheticViewportTrace(batchSize * 16);
+    vector<double> distribution(tilingCount * tilingCount * 6);
+    auto i = 0;
+    for (auto _ : state) {
+        simulator.ToDistribution(span(positions).subspan(i % 16 * batchSize, batchSize), distribution);
+        benchmark::DoNotOptimize(distribution.data());
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations() * batchSize);
+}
+
+BENCHMARK(BM_ViewportSimulatorSingle)
+    ->ArgNames({"TilingCount", "GridCentidegrees"})
+    ->ArgsProduct({{1, 2, 4, 8, 16}, {0, 50}});
+
+BENCHMARK(BM_ViewportSimulatorBatched)
+    ->ArgNames({"TilingCount", "GridCentidegrees", "BatchSize"})
+    ->ArgsProduct({{1, 2, 4, 8, 16}, {0, 50}, {10, 30}});
@@ -7,13 +7,22 @@ import System.Parallel;
 
 import ABRSimulation360.AggregateControllers.AggregateControllerFactory;
 import ABRSimulation360.AggregateControllers.IAggregateController;
+import ABRSimulation360.AggregateControllers.ThroughputBasedController;
 import ABRSimulation360.Base;
 import ABRSimulation360.BitrateAllocators.BitrateAllocatorFactory;
+import ABRSimulation360.BitrateAllocators.DragonflyAllocator;
+import ABRSimulation360.BitrateAllocators.HybridAllocator;
 import ABRSimulation360.BitrateAllocators.IBitrateAllocator;
+import ABRSimulation360.DistributionCache;
+import ABRSimulation360.Instrumentation;
 import ABRSimulation360.NetworkSimulator;
+import ABRSimulation360.QoE;
+import ABRSimulation360.Random;
 import ABRSimulation360.ThroughputPredictors.EMAPredictor;
 import ABRSimulation360.ThroughputPredictors.IThroughputPredictor;
+import ABRSimulation360.ThroughputPredictors.MovingAveragePredictor;
 import ABRSimulation360.ThroughputPredictors.ThroughputPredictorFactory;
+import ABRSimulation360.Tracing;
 import ABRSimulation360.ViewportPredictors.IViewportPredictor;
 import ABRSimulation360.ViewportPredictors.OfflinePredictor;
 import ABRSimulation360.ViewportPredictors.StaticPredictor;
@@ -30,6 +39,10 @@ export struct SimulationSeriesRef {
     mdspan<double, dims<2>> ViewportDistributions; ///< A list of viewport distributions.
     mdspan<double, dims<2>> PredictedViewportDistributions; ///< A list of predicted viewport distributions.
     span<double> AllocationUs; ///< A list of allocation time in microseconds.
+    /// A 2D array of stage durations in microseconds indexed by segment and stage (empty for no instrumentation).
+    mdspan<double, dims<2>> StageUs = {};
+    /// A 2D array of simulation counters indexed by segment and counter (empty for no instrumentation).
+    mdspan<int64_t, dims<2>> Counters = {};
 };
 
 /// Refers to a collection of simulation series.
@@ -39,6 +52,10 @@ export struct SimulationDataRef {
     mdspan<double, dims<3>> ViewportDistributions; ///< A 2D array of viewport distributions.
     mdspan<double, dims<3>> PredictedViewportDistributions; ///< A 2D array of predicted viewport distributions.
     mdspan<double, dims<2>> AllocationUs; ///< A 2D array of allocation time in microseconds.
+    /// A 3D array of stage durations in microseconds indexed by path, segment, and stage (empty for no instrumentation).
+    mdspan<double, dims<3>> StageUs = {};
+    /// A 3D array of simulation counters indexed by path, segment, and counter (empty for no instrumentation).
+    mdspan<int64_t, dims<3>> Counters = {};
 
     /// Returns the path at the specified index.
     /// @param index The index of the path.
@@ -48,7 +65,86 @@ export struct SimulationDataRef {
         const auto distributions = submdspan(ViewportDistributions, index, full_extent, full_extent);
         const auto predictedDistribution = submdspan(PredictedViewportDistributions, index, full_extent, full_extent);
         const span allocationUs(&AllocationUs[index, 0], AllocationUs.extent(1));
-        return {RebufferingSeconds[index], bitratesMbps, distributions, predictedDistribution, allocationUs};
+        SimulationSeriesRef series = {
+            RebufferingSeconds[index], bitratesMbps, distributions, predictedDistribution, allocationUs
+        };
+        if (StageUs.data_handle()) {
+            series.StageUs = submdspan(StageUs, index, full_extent, full_extent);
+            series.Counters = submdspan(Counters, index, full_extent, full_extent);
+        }
+        return series;
+    }
+};
+
+/// Refers to a collection of compact simulation series,
+/// which hold bitrate IDs instead of bitrates and single-precision viewport distributions.
+export struct CompactSimulationDataRef {
+    span<double> RebufferingSeconds; ///< A list of total rebuffering durations in seconds.
+    mdspan<uint8_t, dims<3>> BitrateIDs; ///< A 3D array of buffered bitrate IDs.
+    mdspan<float, dims<3>> ViewportDistributions; ///< A 2D array of viewport distributions.
+    mdspan<float, dims<3>> PredictedViewportDistributions; ///< A 2D array of predicted viewport distributions.
+    mdspan<double, dims<2>> AllocationUs; ///< A 2D array of allocation time in microseconds.
+};
+
+/// Refers to a collection of quality-of-experience summaries.
+export struct SummaryDataRef {
+    /// A 2D array of session metrics indexed by path and metric.
+    mdspan<double, dims<2>> SessionQoE;
+    /// A 3D array of segment metrics indexed by path, segment, and metric (empty for no segment metrics).
+    mdspan<double, dims<3>> SegmentQoE = {};
+};
+
+/// Holds the simulation series of a session.
+export struct SimulationSeriesBuffer {
+    double RebufferingSeconds = 0.; ///< The total rebuffering duration in seconds.
+    mdarray<double, dims<2>> BufferedBitratesMbps; ///< A 2D array of buffered bitrates in megabits per second.
+    mdarray<double, dims<2>> ViewportDistributions; ///< A list of viewport distributions.
+    mdarray<double, dims<2>> PredictedViewportDistributions; ///< A list of predicted viewport distributions.
+    vector<double> AllocationUs; ///< A list of allocation time in microseconds.
+
+    /// Creates a simulation series buffer with the specified dimensions.
+    /// @param segmentCount The number of segments, which must be positive.
+    /// @param tileCount The number of tiles.
+    SimulationSeriesBuffer(int segmentCount, int tileCount)
+        : BufferedBitratesMbps(segmentCount, tileCount), ViewportDistributions(segmentCount, tileCount),
+          PredictedViewportDistributions(segmentCount - 1, tileCount), AllocationUs(segmentCount - 1) {
+    }
+
+    SimulationSeriesBuffer(const SimulationSeriesBuffer &) = delete;
+    SimulationSeriesBuffer &operator=(const SimulationSeriesBuffer &) = delete;
+
+    /// Returns a reference to the simulation series.
+    /// @returns A reference to the simulation series, which remains valid until the buffer is destroyed.
+    [[nodiscard]] SimulationSeriesRef Ref() {
+        return {
+            RebufferingSeconds, BufferedBitratesMbps.to_mdspan(), ViewportDistributions.to_mdspan(),
+            PredictedViewportDistributions.to_mdspan(), AllocationUs
+        };
+    }
+};
+
+/// Refers to a collection of simulation series stacked over configurations.
+export struct SweepDataRef {
+    mdspan<double, dims<2>> RebufferingSeconds; ///< A 2D array of total rebuffering durations in seconds.
+    mdspan<double, dims<4>> BufferedBitratesMbps; ///< A 4D array of buffered bitrates in megabits per second.
+    mdspan<double, dims<3>> ViewportDistributions; ///< A 2D array of viewport distributions shared by configurations.
+    mdspan<double, dims<4>> PredictedViewportDistributions; ///< A 3D array of predicted viewport distributions.
+    mdspan<double, dims<3>> AllocationUs; ///< A 3D array of allocation time in microseconds.
+
+    /// Returns the path at the specified configuration and session indices.
+    /// @param configIndex The index of the configuration.
+    /// @param sessionIndex The index of the session.
+    /// @returns The path at the specified configuration and session indices.
+    [[nodiscard]] SimulationSeriesRef operator[](int configIndex, int sessionIndex) const {
+        const auto bitratesMbps = submdspan(BufferedBitratesMbps, configIndex, sessionIndex, full_extent, full_extent);
+        const auto distributions = submdspan(ViewportDistributions, sessionIndex, full_extent, full_extent);
+        const auto predictedDistributions =
+            submdspan(PredictedViewportDistributions, configIndex, sessionIndex, full_extent, full_extent);
+        const span allocationUs(&AllocationUs[configIndex, sessionIndex, 0], AllocationUs.extent(2));
+        return {
+            RebufferingSeconds[configIndex, sessionIndex], bitratesMbps, distributions, predictedDistributions,
+            allocationUs
+        };
     }
 };
 
@@ -58,116 +154,766 @@ export struct ABRSimulation360Options {
     const BaseThroughputPredictorOptions &ThroughputPredictorOptions = EMAPredictorOptions();
     /// The options for the viewport predictor.
     const BaseViewportPredictorOptions &ViewportPredictorOptions = StaticPredictorOptions();
+    /// The options for the viewport simulator.
+    ViewportSimulatorOptions ViewportSimulatorOptions = {};
+    /// The quantization step for dilation factors of dilated viewport distributions (0 for no quantization).
+    double DilationStep = 0.;
+    /// The persistent cache of viewport distributions (null for no caching).
+    DistributionCache *DistributionCache = nullptr;
+    /// Whether to index network series so that downloads take logarithmic time.
+    bool UsesNetworkIndex = false;
+    /// The per-thread histograms of instrumented stage durations (null for no histograms).
+    StageHistograms *StageHistograms = nullptr;
+    /// The tracer of values traced by components, where the session ID is the index of the path
+    /// (offset by the configuration or branch index times the number of paths when stacked; null for no tracing).
+    Tracer *Tracer = nullptr;
+    /// The seed of the random streams drawn by components in simulations of collections,
+    /// which are keyed by the seed, the index of the path, the replica, and the segment.
+    uint64_t Seed = 0;
+    /// The number of sessions simulated in lockstep as lanes of a batch in simulations of collections
+    /// whose components support batching, which are neither instrumented nor traced (0 for no batching).
+    int LaneCount = 0;
 };
 
-/// Simulates the dynamics of 360° adaptive bitrate streaming.
-export class ABRSimulator360 {
+/// Holds a component of a session by value if its type is concrete, or behind its interface otherwise.
+/// Calls on a concrete component are resolved at compile time, while calls on an interface are dispatched at run time.
+/// @tparam T The type of the component, which is either a final class or an interface with a Clone method.
+export template<typename T>
+class SessionComponent {
+    static constexpr auto IsInterface = is_abstract_v<T>;
+
+    conditional_t<IsInterface, unique_ptr<T>, T> _value;
+
 public:
-    /// Simulates a 360° adaptive bitrate streaming configuration on a network series and viewport series.
+    /// Creates a component that holds a concrete value.
+    /// @param value The component.
+    explicit SessionComponent(T &&value) requires (!IsInterface) : _value(move(value)) {
+    }
+
+    /// Creates a component behind its interface.
+    /// @param value The component.
+    explicit SessionComponent(unique_ptr<T> value) requires IsInterface : _value(move(value)) {
+    }
+
+    SessionComponent(const SessionComponent &other) requires (!IsInterface) = default;
+
+    SessionComponent(const SessionComponent &other) requires IsInterface : _value(other._value->Clone()) {
+    }
+
+    SessionComponent(SessionComponent &&) noexcept = default;
+    SessionComponent &operator=(SessionComponent &&) noexcept = default;
+
+    T *operator->() {
+        if constexpr (IsInterface) return _value.get();
+        else return &_value;
+    }
+
+    const T *operator->() const {
+        if constexpr (IsInterface) return _value.get();
+        else return &_value;
+    }
+
+    T &operator*() {
+        return *operator->();
+    }
+
+    const T &operator*() const {
+        return *operator->();
+    }
+};
+
+// Simulates the steps of a segment that a session and each lane of a session batch share,
+// which are the buffer and playback arithmetic and the decision on the bitrates of a requested segment.
+class SegmentSimulator {
+    StreamingConfig _streamingConfig;
+    int _tileCount;
+    vector<double> _bitratesMbps;
+
+    ViewportSimulator _viewportSimulator;
+    DilatedViewportSimulator _dilatedViewportSimulator;
+    ScratchArena _scratchArena;
+    vector<SphericalPosition> _positionBuffer;
+    SparseDistribution _sparseDistribution;
+
+public:
+    SegmentSimulator(const StreamingConfig &streamingConfig, const ABRSimulation360Options &options) :
+        _streamingConfig(streamingConfig),
+        _tileCount(streamingConfig.TilingCount * streamingConfig.TilingCount * 6),
+        _bitratesMbps(streamingConfig.BitratesPerFaceMbps / (_tileCount / 6)),
+        _viewportSimulator(streamingConfig.ViewportConfig, streamingConfig.TilingCount,
+                           options.ViewportSimulatorOptions),
+        _dilatedViewportSimulator(streamingConfig.ViewportConfig, streamingConfig.TilingCount, options.DilationStep) {
+    }
+
+    // Returns the buffer level before a segment is requested from a playback position.
+    [[nodiscard]] double BufferSeconds(int endSegmentID, int beginSegmentID, double secondsInSegment) const {
+        return (endSegmentID - beginSegmentID) * _streamingConfig.SegmentSeconds - secondsInSegment;
+    }
+
+    // Returns the time for which a client idles before requesting a segment because its buffer is full.
+    [[nodiscard]] double IdleSeconds(double bufferSeconds) const {
+        return max(bufferSeconds + _streamingConfig.SegmentSeconds - _streamingConfig.MaxBufferSeconds, 0.);
+    }
+
+    // Updates a viewport predictor with the positions played for a duration from a playback position.
+    void ObservePlayback(IViewportPredictor &viewportPredictor, ViewportSeriesView viewportSeries,
+                         int beginSegmentID, double secondsInSegment, double seconds) const {
+        const auto currentSeconds = beginSegmentID * _streamingConfig.SegmentSeconds + secondsInSegment;
+        const auto positions = viewportSeries.Window(currentSeconds, seconds).Values;
+        if (!positions.empty()) viewportPredictor.Update(positions);
+    }
+
+    // Advances a playback position, which is a segment ID and the time into the segment, by a duration.
+    void AdvancePlayback(int &beginSegmentID, double &secondsInSegment, double seconds) const {
+        const auto segmentSeconds = _streamingConfig.SegmentSeconds;
+        const auto _secondsInSegment = secondsInSegment + fmod(seconds, segmentSeconds);
+        const auto wraps = _secondsInSegment >= segmentSeconds;
+        beginSegmentID += Math::Floor(seconds / segmentSeconds) + wraps;
+        secondsInSegment = _secondsInSegment - (wraps ? segmentSeconds : 0.);
+    }
+
+    // Releases the scratch memory of the previous segment.
+    void BeginSegment() {
+        _scratchArena.Reset();
+    }
+
+    // Stores the lowest bitrates as the buffered bitrates of the first segment and returns its size in megabytes.
+    double StoreFirstBitrates(SimulationSeriesRef out) {
+        return StoreBitrates(out, 0, _scratchArena.Allocate<int>(_tileCount));
+    }
+
+    // Predicts the viewport positions of the segment to request.
+    template<bool IsInstrumented>
+    [[nodiscard]] span<const SphericalPosition> PredictPositions(SegmentProbe<IsInstrumented> &probe,
+                                                                 const IViewportPredictor &viewportPredictor,
+                                                                 double bufferSeconds) {
+        return probe.Measure(SimulationStage::ViewportPrediction, [&] {
+            return viewportPredictor.PredictPositions(bufferSeconds, _streamingConfig.SegmentSeconds, _positionBuffer);
+        });
+    }
+
+    // Decides the bitrates of a segment from its predicted viewport positions and returns its size in megabytes.
+    template<bool IsInstrumented, typename TAllocator>
+    double RequestSegment(SegmentProbe<IsInstrumented> &probe, TAllocator &allocator, SimulationSeriesRef out,
+                          ViewportSeriesView viewportSeries, int endSegmentID, span<const SphericalPosition> positions,
+                          double aggregateBitrateMbps, double bufferSeconds) {
+        const auto segmentSeconds = _streamingConfig.SegmentSeconds;
+        const span distribution(&out.PredictedViewportDistributions[endSegmentID - 1, 0], _tileCount);
+        // Reuses the actual distribution when the prediction is exactly the next segment (e.g., offline predictors).
+        // Otherwise, the distribution is computed in sparse form for allocators and converted to dense form for output.
+        const auto sparseDistribution = probe.Measure(SimulationStage::ViewportDistribution, [&] {
+            const auto segmentPositions = viewportSeries.Window(endSegmentID * segmentSeconds, segmentSeconds).Values;
+            if (positions.data() == segmentPositions.data() && positions.size() == segmentPositions.size()) {
+                ranges::copy_n(&out.ViewportDistributions[endSegmentID, 0], _tileCount, distribution.begin());
+                _sparseDistribution.Assign(span<const double>(distribution));
+                return SparseDistributionView(_sparseDistribution);
+            }
+            const auto simulatedDistribution = _viewportSimulator.ToSparseDistribution<IsInstrumented>(positions);
+            simulatedDistribution.ToDense(distribution);
+            return simulatedDistribution;
+        });
+        const span prevDistribution(&out.ViewportDistributions[endSegmentID - 1, 0], _tileCount);
+        _dilatedViewportSimulator.SetPositions(positions);
+        const auto DilatedDistribution = [&](double dilation) {
+            return probe.Measure(SimulationStage::DilatedDistribution, [&] {
+                return _dilatedViewportSimulator.ToDistribution<IsInstrumented>(dilation);
+            });
+        };
+        const BitrateAllocatorContext allocatorContext = {
+            aggregateBitrateMbps, bufferSeconds, distribution, prevDistribution, DilatedDistribution, sparseDistribution
+        };
+        const auto [bitrateIDs, allocationTime] = MeasureTimedValue([&] {
+            const auto _bitrateIDs = _scratchArena.Allocate<int, IsInstrumented>(_tileCount);
+            allocator.GetBitrateIDs(allocatorContext, _bitrateIDs);
+            return span<const int>(_bitrateIDs);
+        });
+        out.AllocationUs[endSegmentID - 1] = chrono::duration<double, micro>(allocationTime).count();
+        probe.Add(SimulationStage::BitrateAllocation, out.AllocationUs[endSegmentID - 1]);
+        return StoreBitrates(out, endSegmentID, bitrateIDs);
+    }
+
+    // Returns the cumulative counts of the work in counted calls, leaving network intervals to the caller.
+    [[nodiscard]] SimulationCounts Counts() const {
+        return {
+            _viewportSimulator.FrustumTestCount() + _dilatedViewportSimulator.FrustumTestCount(), 0,
+            _dilatedViewportSimulator.HitCount() + _dilatedViewportSimulator.MissCount(),
+            _scratchArena.AllocationCount()
+        };
+    }
+
+private:
+    // Stores the buffered bitrates of a segment and returns its size in megabytes.
+    double StoreBitrates(SimulationSeriesRef out, int segmentID, span<const int> bitrateIDs) {
+        const span bitratesMbps(&out.BufferedBitratesMbps[segmentID, 0], _tileCount);
+        ranges::transform(bitrateIDs, bitratesMbps.begin(), [&](int bitrateID) {
+            return _bitratesMbps[bitrateID];
+        });
+        return Math::Total(span<const double>(bitratesMbps)) * _streamingConfig.SegmentSeconds / 8;
+    }
+};
+
+/// Represents a 360° adaptive bitrate streaming session that is simulated segment by segment.
+/// A session is specialized on the types of its throughput predictor, aggregate controller, and bitrate allocator,
+/// each of which is either a concrete type whose calls are resolved at compile time or an interface.
+/// A session can be forked into independent sessions that continue from its current state,
+/// optionally with a different aggregate controller or bitrate allocator if all components are interfaces.
+/// Viewport distributions must have been computed into the output before the session is created.
+/// A session without a network simulator downloads from a network that is simulated outside the session,
+/// such as a link shared with other sessions, one Request and Complete call per segment including the first.
+/// Sessions whose output includes stage durations are instrumented, and others run without any instrumentation code.
+/// Values traced while a segment is simulated are tagged with the ID of the segment being downloaded.
+/// @tparam TThroughputPredictor The type of the throughput predictor.
+/// @tparam TController The type of the aggregate controller.
+/// @tparam TAllocator The type of the bitrate allocator.
+export template<typename TThroughputPredictor, typename TController, typename TAllocator>
+class BasicABRSession360 {
+    static constexpr auto IsPolymorphic =
+        is_abstract_v<TThroughputPredictor> && is_abstract_v<TController> && is_abstract_v<TAllocator>;
+
+    StreamingConfig _streamingConfig;
+    ViewportSeriesView _viewportSeries;
+    SimulationSeriesRef _out;
+    int _segmentCount;
+
+    optional<NetworkSimulator> _networkSimulator;
+    SessionComponent<TThroughputPredictor> _throughputPredictor;
+    unique_ptr<IViewportPredictor> _viewportPredictor;
+    SessionComponent<TController> _controller;
+    SessionComponent<TAllocator> _allocator;
+    SegmentSimulator _segmentSimulator;
+
+    int _beginSegmentID = 0;
+    double _secondsInSegment = 0.;
+    int _endSegmentID = 1;
+    bool _isFinished = false;
+    double _requestBufferSeconds = 0.;
+    double _requestSizeMB = 0.;
+
+public:
+    /// Creates a session with the specified components and downloads its first segment if it has a network simulator.
+    /// @param streamingConfig The adaptive bitrate streaming configuration.
+    /// @param controller The aggregate controller.
+    /// @param allocator The bitrate allocator.
+    /// @param throughputPredictor The throughput predictor, which takes the place of the throughput predictor options.
+    /// @param networkSimulator The network simulator of the session (null for a network simulated outside the session).
+    /// @param viewportSeries A viewport series.
+    /// @param out The simulation series output.
+    /// @param options The options for 360° adaptive bitrate streaming simulation.
+    BasicABRSession360(const StreamingConfig &streamingConfig,
+                       SessionComponent<TController> controller,
+                       SessionComponent<TAllocator> allocator,
+                       SessionComponent<TThroughputPredictor> throughputPredictor,
+                       optional<NetworkSimulator> networkSimulator,
+                       ViewportSeriesView viewportSeries,
+                       SimulationSeriesRef out,
+                       const ABRSimulation360Options &options = {}) :
+        _streamingConfig(streamingConfig), _viewportSeries(viewportSeries), _out(out),
+        _segmentCount(Math::Round(viewportSeries.DurationSeconds() / streamingConfig.SegmentSeconds)),
+        _networkSimulator(networkSimulator),
+        _throughputPredictor(move(throughputPredictor)),
+        _viewportPredictor(ViewportPredictorFactory::Create(viewportSeries.IntervalSeconds,
+                                                            options.ViewportPredictorOptions)),
+        _controller(move(controller)),
+        _allocator(move(allocator)),
+        _segmentSimulator(streamingConfig, options) {
+        // Initializes offline components.
+        if (auto *const viewportPredictor = dynamic_cast<OfflinePredictor *>(_viewportPredictor.get()))
+            viewportPredictor->Initialize(viewportSeries);
+
+        // Downloads the first segment at the lowest bitrates.
+        _out.RebufferingSeconds = 0.;
+        if (!_networkSimulator) {
+            _endSegmentID = 0;
+            return;
+        }
+        DownloadSegment<false>(_segmentSimulator.StoreFirstBitrates(_out));
+        if (_endSegmentID >= _segmentCount) Finish();
+    }
+
+    /// Creates a session and downloads its first segment.
     /// @param streamingConfig The adaptive bitrate streaming configuration.
     /// @param controllerOptions The options for the aggregate controller.
     /// @param allocatorOptions The options for the bitrate allocator.
-    /// @param networkSeries A network series.
+    /// @param networkSimulator The network simulator of the session.
     /// @param viewportSeries A viewport series.
     /// @param out The simulation series output.
     /// @param options The options for 360° adaptive bitrate streaming simulation.
-    static void Simulate(const StreamingConfig &streamingConfig,
-                         const BaseAggregateControllerOptions &controllerOptions,
-                         const BaseBitrateAllocatorOptions &allocatorOptions,
-                         NetworkSeriesView networkSeries,
-                         ViewportSeriesView viewportSeries,
-                         SimulationSeriesRef out,
-                         const ABRSimulation360Options &options = {}) {
-        const auto segmentSeconds = streamingConfig.SegmentSeconds;
-        const auto segmentCount = Math::Round(viewportSeries.DurationSeconds() / segmentSeconds);
-        const auto tilingCount = streamingConfig.TilingCount;
-        const auto tileCountPerFace = tilingCount * tilingCount, tileCount = tileCountPerFace * 6;
-        const auto bitratesMbps = streamingConfig.BitratesPerFaceMbps / tileCountPerFace;
-        const auto viewportConfig = streamingConfig.ViewportConfig;
-        const auto maxBufferSeconds = streamingConfig.MaxBufferSeconds;
-
-        const auto throughputPredictor = ThroughputPredictorFactory::Create(options.ThroughputPredictorOptions);
-        const auto viewportPredictor = ViewportPredictorFactory::Create(
-            viewportSeries.IntervalSeconds, options.ViewportPredictorOptions);
-        const auto controller = AggregateControllerFactory::Create(streamingConfig, controllerOptions);
-        const auto allocator = BitrateAllocatorFactory::Create(streamingConfig, allocatorOptions);
-        NetworkSimulator networkSimulator(networkSeries);
-        ViewportSimulator viewportSimulator(viewportConfig, tilingCount);
+    BasicABRSession360(const StreamingConfig &streamingConfig,
+                       const BaseAggregateControllerOptions &controllerOptions,
+                       const BaseBitrateAllocatorOptions &allocatorOptions,
+                       NetworkSimulator networkSimulator,
+                       ViewportSeriesView viewportSeries,
+                       SimulationSeriesRef out,
+                       const ABRSimulation360Options &options = {}) requires IsPolymorphic :
+        BasicABRSession360(streamingConfig,
+                           SessionComponent<TController>(
+                               AggregateControllerFactory::Create(streamingConfig, controllerOptions)),
+                           SessionComponent<TAllocator>(
+                               BitrateAllocatorFactory::Create(streamingConfig, allocatorOptions)),
+                           SessionComponent<TThroughputPredictor>(
+                               ThroughputPredictorFactory::Create(options.ThroughputPredictorOptions)),
+                           networkSimulator, viewportSeries, out, options) {
+    }
 
-        // Initializes offline components.
-        if (auto *const _viewportPredictor = dynamic_cast<OfflinePredictor *>(viewportPredictor.get()))
-            _viewportPredictor->Initialize(viewportSeries);
+    BasicABRSession360(BasicABRSession360 &&) noexcept = default;
 
-        auto beginSegmentID = 0;
-        auto secondsInSegment = 0.;
-        out.RebufferingSeconds = 0.;
+    /// Returns the ID of the next segment to download.
+    /// @returns The ID of the next segment to download.
+    [[nodiscard]] int SegmentID() const {
+        return _endSegmentID;
+    }
 
-        // Computes the viewport distributions.
-        for (auto segmentID = 0; segmentID < segmentCount; ++segmentID) {
-            const auto positions = viewportSeries.Window(segmentID * segmentSeconds, segmentSeconds).Values;
-            const auto distribution = viewportSimulator.ToDistribution(positions);
-            ranges::copy(distribution, &out.ViewportDistributions[segmentID, 0]);
+    /// Returns whether the session has been simulated to the end.
+    /// @returns Whether the session has been simulated to the end.
+    [[nodiscard]] bool IsFinished() const {
+        return _isFinished;
+    }
+
+    /// Downloads the next segment, and plays the remaining buffer content after the last segment.
+    /// The session must have a network simulator.
+    void Step() {
+        if (_isFinished) return;
+        if (_out.StageUs.data_handle()) SimulateSegment<true>(_endSegmentID);
+        else SimulateSegment<false>(_endSegmentID);
+        if (++_endSegmentID == _segmentCount) Finish();
+    }
+
+    /// Returns the time for which the session idles before requesting the next segment because its buffer is full.
+    /// @returns The idle time in seconds.
+    [[nodiscard]] double IdleSeconds() const {
+        return !_isFinished && _endSegmentID > 0 ? _segmentSimulator.IdleSeconds(BufferSeconds(_endSegmentID)) : 0.;
+    }
+
+    /// Idles if necessary and requests the next segment from a network simulated outside the session.
+    /// The idle time must have passed on the network, and the request must be completed before the next one.
+    /// Segments downloaded this way are not instrumented.
+    /// @returns The size of the requested segment in megabytes.
+    double Request() {
+        if (_endSegmentID == 0) return _requestSizeMB = _segmentSimulator.StoreFirstBitrates(_out);
+        SegmentProbe<false> probe;
+        _requestBufferSeconds = BeginSegment(probe, _endSegmentID);
+        return _requestSizeMB = RequestSegment(probe, _endSegmentID, _requestBufferSeconds);
+    }
+
+    /// Completes the requested segment once it has been downloaded from a network simulated outside the session,
+    /// and plays the remaining buffer content after the last segment.
+    /// @param downloadSeconds The download time of the requested segment in seconds.
+    void Complete(double downloadSeconds) {
+        _throughputPredictor->Update(_requestSizeMB, downloadSeconds);
+        if (_endSegmentID > 0) {
+            SegmentProbe<false> probe;
+            CompleteSegment(probe, _requestBufferSeconds, downloadSeconds);
         }
+        if (++_endSegmentID >= _segmentCount) Finish();
+    }
+
+    /// Simulates the session until the specified segment is the next segment to download or the session finishes.
+    /// @param segmentID The ID of the segment.
+    void RunUntil(int segmentID) {
+        while (!_isFinished && _endSegmentID < segmentID) Step();
+    }
+
+    /// Simulates the session to the end.
+    void Run() {
+        while (!_isFinished) Step();
+    }
 
-        const auto DownloadSegment = [&](int segmentID, span<const int> bitrateIDs) {
-            const auto _bitratesMbps = views::iota(0, tileCount) | views::transform([&](int tileID) {
-                return bitratesMbps[bitrateIDs[tileID]];
-            }) | ranges::to<vector>();
-            const auto totalSizeMB = Math::Total(_bitratesMbps) * segmentSeconds / 8;
-            const auto downloadInfo = networkSimulator.Download(totalSizeMB);
-            ranges::copy(_bitratesMbps, &out.BufferedBitratesMbps[segmentID, 0]);
-            throughputPredictor->Update(downloadInfo.Value, downloadInfo.Seconds);
-            return downloadInfo;
+    /// Forks the session into an independent session that continues from the current state.
+    /// The output of the simulated prefix is copied to the output of the fork.
+    /// @param out The simulation series output of the fork.
+    /// @param controllerOptions The options for the aggregate controller of the fork (null to copy the current controller).
+    /// @param allocatorOptions The options for the bitrate allocator of the fork (null to copy the current allocator).
+    /// @returns The forked session.
+    [[nodiscard]] BasicABRSession360 Fork(SimulationSeriesRef out,
+                                          const BaseAggregateControllerOptions *controllerOptions = nullptr,
+                                          const BaseBitrateAllocatorOptions *allocatorOptions = nullptr) const {
+        BasicABRSession360 session(*this, out);
+        if constexpr (IsPolymorphic) {
+            if (controllerOptions)
+                session._controller = SessionComponent<TController>(
+                    AggregateControllerFactory::Create(_streamingConfig, *controllerOptions));
+            if (allocatorOptions)
+                session._allocator = SessionComponent<TAllocator>(
+                    BitrateAllocatorFactory::Create(_streamingConfig, *allocatorOptions));
+        } else if (controllerOptions || allocatorOptions)
+            throw invalid_argument("Only sessions with polymorphic components can fork with different components.");
+        return session;
+    }
+
+private:
+    // Copies the state of a session with a different output.
+    BasicABRSession360(const BasicABRSession360 &other, SimulationSeriesRef out) :
+        _streamingConfig(other._streamingConfig), _viewportSeries(other._viewportSeries), _out(out),
+        _segmentCount(other._segmentCount), _networkSimulator(other._networkSimulator),
+        _throughputPredictor(other._throughputPredictor), _viewportPredictor(other._viewportPredictor->Clone()),
+        _controller(other._controller), _allocator(other._allocator), _segmentSimulator(other._segmentSimulator),
+        _beginSegmentID(other._beginSegmentID), _secondsInSegment(other._secondsInSegment),
+        _endSegmentID(other._endSegmentID), _isFinished(other._isFinished),
+        _requestBufferSeconds(other._requestBufferSeconds), _requestSizeMB(other._requestSizeMB) {
+        _out.RebufferingSeconds = other._out.RebufferingSeconds;
+        const auto CopyRows = [&](auto from, auto to, int rowCount) {
+            if (from.data_handle() == to.data_handle()) return;
+            for (auto i = 0; i < rowCount; ++i) ranges::copy_n(&from[i, 0], from.extent(1), &to[i, 0]);
         };
+        CopyRows(other._out.BufferedBitratesMbps, _out.BufferedBitratesMbps, _endSegmentID);
+        CopyRows(other._out.ViewportDistributions, _out.ViewportDistributions, _segmentCount);
+        CopyRows(other._out.PredictedViewportDistributions, _out.PredictedViewportDistributions, _endSegmentID - 1);
+        if (other._out.AllocationUs.data() != _out.AllocationUs.data())
+            ranges::copy_n(other._out.AllocationUs.begin(), _endSegmentID - 1, _out.AllocationUs.begin());
+        if (other._out.StageUs.data_handle() && _out.StageUs.data_handle()) {
+            CopyRows(other._out.StageUs, _out.StageUs, _endSegmentID - 1);
+            CopyRows(other._out.Counters, _out.Counters, _endSegmentID - 1);
+        }
+    }
+
+    // Downloads content from the network simulator of the session and returns the download time in seconds.
+    template<bool IsInstrumented>
+    double DownloadSegment(double sizeMB) {
+        const auto downloadInfo = _networkSimulator->Download<IsInstrumented>(sizeMB);
+        _throughputPredictor->Update(downloadInfo.Value, downloadInfo.Seconds);
+        return downloadInfo.Seconds;
+    }
+
+    [[nodiscard]] double BufferSeconds(int endSegmentID) const {
+        return _segmentSimulator.BufferSeconds(endSegmentID, _beginSegmentID, _secondsInSegment);
+    }
+
+    void PlayVideo(double seconds) {
+        _segmentSimulator.ObservePlayback(*_viewportPredictor, _viewportSeries, _beginSegmentID, _secondsInSegment,
+                                          seconds);
+        _segmentSimulator.AdvancePlayback(_beginSegmentID, _secondsInSegment, seconds);
+    }
+
+    template<bool IsInstrumented>
+    void SimulateSegment(int endSegmentID) {
+        auto probe = Probe<IsInstrumented>(endSegmentID - 1);
+        SimulationCounts beginCounts{};
+        if constexpr (IsInstrumented) beginCounts = Counts();
+        const auto bufferSeconds = BeginSegment(probe, endSegmentID);
+        const auto sizeMB = RequestSegment(probe, endSegmentID, bufferSeconds);
+        const auto downloadSeconds = probe.Measure(SimulationStage::NetworkSimulation, [&] {
+            return DownloadSegment<IsInstrumented>(sizeMB);
+        });
+        CompleteSegment(probe, bufferSeconds, downloadSeconds);
+        if constexpr (IsInstrumented) probe.Count(beginCounts, Counts());
+    }
+
+    // Idles until the buffer has room for a segment, and returns the buffer level before idling.
+    template<bool IsInstrumented>
+    double BeginSegment(SegmentProbe<IsInstrumented> &probe, int endSegmentID) {
+        _segmentSimulator.BeginSegment();
+        TraceScope::SetSegmentID(endSegmentID);
+        RandomScope::SetSegmentID(endSegmentID);
+        const auto bufferSeconds = BufferSeconds(endSegmentID);
+        if (const auto idleSeconds = _segmentSimulator.IdleSeconds(bufferSeconds); idleSeconds > 0.) {
+            if (_networkSimulator)
+                probe.Measure(SimulationStage::NetworkSimulation, [&] { _networkSimulator->WaitFor(idleSeconds); });
+            probe.Measure(SimulationStage::ViewportPrediction, [&] { PlayVideo(idleSeconds); });
+        }
+        return bufferSeconds;
+    }
+
+    // Decides the bitrates of a segment and returns its size in megabytes.
+    template<bool IsInstrumented>
+    double RequestSegment(SegmentProbe<IsInstrumented> &probe, int endSegmentID, double bufferSeconds) {
+        const auto throughputMbps = _throughputPredictor->PredictThroughputMbps();
+        const AggregateControllerContext controllerContext = {throughputMbps, bufferSeconds};
+        const auto aggregateBitrateMbps = probe.Measure(SimulationStage::AggregateControl, [&] {
+            return _controller->GetAggregateBitrateMbps(controllerContext);
+        });
+        const auto positions = _segmentSimulator.PredictPositions(probe, *_viewportPredictor, bufferSeconds);
+        return _segmentSimulator.RequestSegment(probe, *_allocator, _out, _viewportSeries, endSegmentID, positions,
+                                                aggregateBitrateMbps, bufferSeconds);
+    }
+
+    // Plays the buffer content while a segment downloads and accounts for rebuffering.
+    template<bool IsInstrumented>
+    void CompleteSegment(SegmentProbe<IsInstrumented> &probe, double bufferSeconds, double downloadSeconds) {
+        probe.Measure(SimulationStage::ViewportPrediction, [&] { PlayVideo(min(downloadSeconds, bufferSeconds)); });
+        if (downloadSeconds > bufferSeconds) _out.RebufferingSeconds += downloadSeconds - bufferSeconds;
+    }
+
+    template<bool IsInstrumented>
+    [[nodiscard]] SegmentProbe<IsInstrumented> Probe(int segmentIndex) {
+        if constexpr (!IsInstrumented) return {};
+        else
+            return {
+                span(&_out.StageUs[segmentIndex, 0], SimulationStageCount),
+                span(&_out.Counters[segmentIndex, 0], SimulationCounterCount)
+            };
+    }
+
+    [[nodiscard]] SimulationCounts Counts() const {
+        auto counts = _segmentSimulator.Counts();
+        if (_networkSimulator)
+            counts[to_underlying(SimulationCounter::NetworkIntervals)] = _networkSimulator->WalkedIntervalCount();
+        return counts;
+    }
+
+    // Plays the remaining buffer content.
+    void Finish() {
+        PlayVideo((_segmentCount - _beginSegmentID) * _streamingConfig.SegmentSeconds - _secondsInSegment);
+        _isFinished = true;
+    }
+};
+
+/// Represents a 360° adaptive bitrate streaming session whose components are dispatched at run time.
+export using ABRSession360 = BasicABRSession360<IThroughputPredictor, IAggregateController, IBitrateAllocator>;
+
+/// Represents components that keep no state across segments, so that a single component serves all lanes of a session batch.
+export template<typename T>
+concept LaneSharedComponent =
+    same_as<T, ThroughputBasedController> || same_as<T, HybridAllocator> || same_as<T, DragonflyAllocator>;
+
+// Holds the throughput predictors of the lanes of a session batch, one per lane.
+template<typename T>
+class ThroughputPredictorLanes {
+    vector<T> _predictors;
+
+public:
+    ThroughputPredictorLanes(const T &predictor, int laneCount) : _predictors(laneCount, predictor) {
+    }
+
+    void Update(span<const double> downloadedMB, span<const double> downloadSeconds) {
+        for (size_t laneID = 0; laneID < downloadedMB.size(); ++laneID)
+            _predictors[laneID].Update(downloadedMB[laneID], downloadSeconds[laneID]);
+    }
+
+    void PredictThroughputsMbps(span<double> throughputsMbps) const {
+        for (size_t laneID = 0; laneID < throughputsMbps.size(); ++laneID)
+            throughputsMbps[laneID] = _predictors[laneID].PredictThroughputMbps();
+    }
+};
+
+// Holds the exponential moving average predictors of the lanes of a session batch as arrays across lanes.
+template<>
+class ThroughputPredictorLanes<EMAPredictor> : public EMAPredictorLanes {
+public:
+    using EMAPredictorLanes::EMAPredictorLanes;
+};
+
+// Holds the moving average predictors of the lanes of a session batch as arrays across lanes.
+template<>
+class ThroughputPredictorLanes<MovingAveragePredictor> : public MovingAveragePredictorLanes {
+public:
+    using MovingAveragePredictorLanes::MovingAveragePredictorLanes;
+};
 
-        const auto PlayVideo = [&](double seconds) {
-            const auto currentSeconds = beginSegmentID * segmentSeconds + secondsInSegment;
-            const auto positions = viewportSeries.Window(currentSeconds, seconds).Values;
-            if (!positions.empty()) viewportPredictor->Update(positions);
+/// Represents a batch of 360° adaptive bitrate streaming sessions that are simulated in lockstep segment by segment,
+/// each of which is a lane of the batch.
+/// Throughput predictor states, buffer levels, and rebuffering durations are stored as arrays across lanes,
+/// so that the per-segment arithmetic of all lanes runs in vectorizable loops,
+/// and the aggregate controller, bitrate allocator, and viewport simulators are shared by all lanes.
+/// Lanes are ordered by decreasing numbers of segments, so that the lanes in progress always form a prefix of the batch,
+/// and lanes that idle before requesting a segment or rebuffer while downloading are handled by masks.
+/// The output of each lane is identical to that of a session simulated on its own except for allocation time.
+/// Batches are neither instrumented nor traced, and viewport predictors must not draw random numbers.
+/// @tparam TThroughputPredictor The type of the throughput predictor.
+/// @tparam TController The type of the aggregate controller.
+/// @tparam TAllocator The type of the bitrate allocator.
+export template<typename TThroughputPredictor, LaneSharedComponent TController, LaneSharedComponent TAllocator>
+class BasicABRSessionBatch360 {
+    TController _controller;
+    TAllocator _allocator;
+    ThroughputPredictorLanes<TThroughputPredictor> _throughputPredictors;
+    SegmentSimulator _segmentSimulator;
 
-            beginSegmentID += Math::Floor(seconds / segmentSeconds);
-            secondsInSegment += fmod(seconds, segmentSeconds);
-            if (secondsInSegment >= segmentSeconds) ++beginSegmentID, secondsInSegment -= segmentSeconds;
+    vector<ViewportSeriesView> _viewportSeries;
+    vector<SimulationSeriesRef> _out;
+    vector<int> _segmentCounts;
+    vector<NetworkSimulator> _networkSimulators;
+    vector<unique_ptr<IViewportPredictor>> _viewportPredictors;
+
+    vector<int> _beginSegmentIDs;
+    vector<double> _secondsInSegments;
+    vector<double> _rebufferingSeconds;
+    vector<double> _bufferSeconds, _idleSeconds, _playSeconds;
+    vector<double> _throughputsMbps, _aggregateBitratesMbps;
+    vector<double> _sizesMB, _downloadedMB, _downloadSeconds;
+
+    int _laneCount = 0;
+    int _endSegmentID = 1;
+
+public:
+    /// Creates a batch of sessions with the specified components and downloads their first segments.
+    /// @param streamingConfig The adaptive bitrate streaming configuration.
+    /// @param controller The aggregate controller shared by all lanes.
+    /// @param allocator The bitrate allocator shared by all lanes.
+    /// @param throughputPredictor The throughput predictor, from whose state the throughput predictor of each lane starts.
+    /// @param networkSimulators A list of network simulators, one per lane.
+    /// @param viewportSeries A list of viewport series, one per lane.
+    /// @param out A list of simulation series outputs, one per lane.
+    /// @param options The options for 360° adaptive bitrate streaming simulation.
+    BasicABRSessionBatch360(const StreamingConfig &streamingConfig,
+                            TController controller,
+                            TAllocator allocator,
+                            const TThroughputPredictor &throughputPredictor,
+                            span<const NetworkSimulator> networkSimulators,
+                            span<const ViewportSeriesView> viewportSeries,
+                            span<const SimulationSeriesRef> out,
+                            const ABRSimulation360Options &options = {}) :
+        _controller(move(controller)),
+        _allocator(move(allocator)),
+        _throughputPredictors(throughputPredictor, static_cast<int>(viewportSeries.size())),
+        _segmentSimulator(streamingConfig, options),
+        _laneCount(static_cast<int>(viewportSeries.size())) {
+        if (networkSimulators.size() != _laneCount || out.size() != _laneCount)
+            throw invalid_argument("The numbers of network simulators, viewport series, and outputs must be equal.");
+
+        // Orders lanes by decreasing numbers of segments.
+        const auto SegmentCount = [&](int i) {
+            return Math::Round(viewportSeries[i].DurationSeconds() / streamingConfig.SegmentSeconds);
         };
+        auto sessionIDs = views::iota(0, _laneCount) | ranges::to<vector>();
+        ranges::stable_sort(sessionIDs, greater(), SegmentCount);
+        for (const auto i : sessionIDs) {
+            _viewportSeries.push_back(viewportSeries[i]);
+            _out.push_back(out[i]);
+            _segmentCounts.push_back(SegmentCount(i));
+            _networkSimulators.push_back(networkSimulators[i]);
+            _viewportPredictors.push_back(ViewportPredictorFactory::Create(viewportSeries[i].IntervalSeconds,
+                                                                           options.ViewportPredictorOptions));
+        }
+        for (auto *const lanes : {&_bufferSeconds, &_idleSeconds, &_playSeconds, &_throughputsMbps,
+                                  &_aggregateBitratesMbps, &_sizesMB, &_downloadedMB, &_downloadSeconds,
+                                  &_secondsInSegments, &_rebufferingSeconds})
+            lanes->resize(_laneCount);
+        _beginSegmentIDs.resize(_laneCount);
 
-        // Downloads the first segment at the lowest bitrates.
-        DownloadSegment(0, vector(tileCount, 0));
-
-        // Downloads the remaining segments.
-        for (auto endSegmentID = 1; endSegmentID < segmentCount; ++endSegmentID) {
-            const auto bufferSeconds = (endSegmentID - beginSegmentID) * segmentSeconds - secondsInSegment;
-            if (bufferSeconds > maxBufferSeconds - segmentSeconds) {
-                const auto idleSeconds = bufferSeconds + segmentSeconds - maxBufferSeconds;
-                networkSimulator.WaitFor(idleSeconds);
-                PlayVideo(idleSeconds);
+        // Downloads the first segments at the lowest bitrates.
+        for (auto laneID = 0; laneID < _laneCount; ++laneID) {
+            _out[laneID].RebufferingSeconds = 0.;
+            DownloadSegment(laneID, _segmentSimulator.StoreFirstBitrates(_out[laneID]));
+        }
+        UpdateThroughputPredictors();
+        FinishLanes();
+    }
+
+    /// Returns the ID of the next segment to download.
+    /// @returns The ID of the next segment to download.
+    [[nodiscard]] int SegmentID() const {
+        return _endSegmentID;
+    }
+
+    /// Returns whether all sessions have been simulated to the end.
+    /// @returns Whether all sessions have been simulated to the end.
+    [[nodiscard]] bool IsFinished() const {
+        return _laneCount == 0;
+    }
+
+    /// Downloads the next segment of all lanes in progress.
+    void Step() {
+        if (_laneCount == 0) return;
+        SimulateSegment(_endSegmentID++);
+        FinishLanes();
+    }
+
+    /// Simulates all sessions to the end.
+    void Run() {
+        while (_laneCount > 0) Step();
+    }
+
+private:
+    void DownloadSegment(int laneID, double sizeMB) {
+        const auto downloadInfo = _networkSimulators[laneID].Download(sizeMB);
+        _downloadedMB[laneID] = downloadInfo.Value, _downloadSeconds[laneID] = downloadInfo.Seconds;
+    }
+
+    void UpdateThroughputPredictors() {
+        _throughputPredictors.Update(span(_downloadedMB).first(_laneCount),
+                                     span(_downloadSeconds).first(_laneCount));
+    }
+
+    // Updates the viewport predictor of a lane with the positions played from the current playback position.
+    void ObservePlayback(int laneID, double seconds) {
+        _segmentSimulator.ObservePlayback(*_viewportPredictors[laneID], _viewportSeries[laneID],
+                                          _beginSegmentIDs[laneID], _secondsInSegments[laneID], seconds);
+    }
+
+    // Advances the playback positions of the lanes in progress, where lanes that do not play are given zero durations.
+    void AdvancePlayback(span<const double> seconds) {
+        for (auto laneID = 0; laneID < _laneCount; ++laneID)
+            _segmentSimulator.AdvancePlayback(_beginSegmentIDs[laneID], _secondsInSegments[laneID], seconds[laneID]);
+    }
+
+    void SimulateSegment(int endSegmentID) {
+        _segmentSimulator.BeginSegment();
+
+        // Idles the lanes whose buffers have no room for a segment.
+        for (auto laneID = 0; laneID < _laneCount; ++laneID) {
+            _bufferSeconds[laneID] =
+                _segmentSimulator.BufferSeconds(endSegmentID, _beginSegmentIDs[laneID], _secondsInSegments[laneID]);
+            _idleSeconds[laneID] = _segmentSimulator.IdleSeconds(_bufferSeconds[laneID]);
+        }
+        for (auto laneID = 0; laneID < _laneCount; ++laneID)
+            if (const auto idleSeconds = _idleSeconds[laneID]; idleSeconds > 0.) {
+                _networkSimulators[laneID].WaitFor(idleSeconds);
+                ObservePlayback(laneID, idleSeconds);
             }
+        AdvancePlayback(_idleSeconds);
 
-            const auto throughputMbps = throughputPredictor->PredictThroughputMbps();
-            const AggregateControllerContext controllerContext = {throughputMbps, bufferSeconds};
-            const auto aggregateBitrateMbps = controller->GetAggregateBitrateMbps(controllerContext);
-
-            const auto positions = viewportPredictor->PredictPositions(bufferSeconds, segmentSeconds);
-            const auto distribution = viewportSimulator.ToDistribution(positions);
-            ranges::copy(distribution, &out.PredictedViewportDistributions[endSegmentID - 1, 0]);
-            const span prevDistribution(&out.ViewportDistributions[endSegmentID - 1, 0], tileCount);
-            const auto DilatedDistribution = [&](double dilation) {
-                const auto dilatedFovDegrees = (1 - dilation) * viewportConfig.FoVDegrees + dilation * 180;
-                ViewportSimulator _viewportSimulator({dilatedFovDegrees, viewportConfig.AspectRatio}, tilingCount);
-                return _viewportSimulator.ToDistribution(positions);
-            };
-            const BitrateAllocatorContext allocatorContext =
-                {aggregateBitrateMbps, bufferSeconds, distribution, prevDistribution, DilatedDistribution};
-            const auto [bitrateIDs, allocationTime] =
-                MeasureTimedValue([&] { return allocator->GetBitrateIDs(allocatorContext); });
-            out.AllocationUs[endSegmentID - 1] = chrono::duration<double, micro>(allocationTime).count();
-
-            const auto downloadSeconds = DownloadSegment(endSegmentID, bitrateIDs).Seconds;
-            if (downloadSeconds <= bufferSeconds) PlayVideo(downloadSeconds);
-            else PlayVideo(bufferSeconds), out.RebufferingSeconds += downloadSeconds - bufferSeconds;
+        // Decides the aggregate bitrates of all lanes, and then the bitrates of each lane.
+        _throughputPredictors.PredictThroughputsMbps(span(_throughputsMbps).first(_laneCount));
+        for (auto laneID = 0; laneID < _laneCount; ++laneID)
+            _aggregateBitratesMbps[laneID] =
+                _controller.GetAggregateBitrateMbps({_throughputsMbps[laneID], _bufferSeconds[laneID]});
+        for (auto laneID = 0; laneID < _laneCount; ++laneID) _sizesMB[laneID] = RequestSegment(laneID, endSegmentID);
+
+        for (auto laneID = 0; laneID < _laneCount; ++laneID) DownloadSegment(laneID, _sizesMB[laneID]);
+        UpdateThroughputPredictors();
+
+        // Plays the buffer content while segments download, and accounts for rebuffering in lanes that run out of it.
+        for (auto laneID = 0; laneID < _laneCount; ++laneID) {
+            _playSeconds[laneID] = min(_downloadSeconds[laneID], _bufferSeconds[laneID]);
+            _rebufferingSeconds[laneID] += max(_downloadSeconds[laneID] - _bufferSeconds[laneID], 0.);
         }
+        for (auto laneID = 0; laneID < _laneCount; ++laneID) ObservePlayback(laneID, _playSeconds[laneID]);
+        AdvancePlayback(_playSeconds);
+    }
 
-        // Plays the remaining buffer content.
-        PlayVideo((segmentCount - beginSegmentID) * segmentSeconds - secondsInSegment);
+    // Decides the bitrates of a segment of a lane and returns its size in megabytes.
+    double RequestSegment(int laneID, int endSegmentID) {
+        SegmentProbe<false> probe;
+        const auto bufferSeconds = _bufferSeconds[laneID];
+        const auto positions = _segmentSimulator.PredictPositions(probe, *_viewportPredictors[laneID], bufferSeconds);
+        return _segmentSimulator.RequestSegment(probe, _allocator, _out[laneID], _viewportSeries[laneID],
+                                                endSegmentID, positions, _aggregateBitratesMbps[laneID],
+                                                bufferSeconds);
+    }
+
+    // Retires the lanes that have downloaded all of their segments, which are the last lanes in progress.
+    void FinishLanes() {
+        while (_laneCount > 0 && _segmentCounts[_laneCount - 1] <= _endSegmentID) {
+            --_laneCount;
+            _out[_laneCount].RebufferingSeconds = _rebufferingSeconds[_laneCount];
+        }
+    }
+};
+
+/// Simulates the dynamics of 360° adaptive bitrate streaming.
+export class ABRSimulator360 {
+public:
+    /// Simulates a 360° adaptive bitrate streaming configuration on a network series and viewport series.
+    /// Components draw from the random stream of the enclosing random scope, so the seed option must be zero.
+    /// @param streamingConfig The adaptive bitrate streaming configuration.
+    /// @param controllerOptions The options for the aggregate controller.
+    /// @param allocatorOptions The options for the bitrate allocator.
+    /// @param networkSeries A network series.
+    /// @param viewportSeries A viewport series.
+    /// @param out The simulation series output.
+    /// @param options The options for 360° adaptive bitrate streaming simulation.
+    static void Simulate(const StreamingConfig &streamingConfig,
+                         const BaseAggregateControllerOptions &controllerOptions,
+                         const BaseBitrateAllocatorOptions &allocatorOptions,
+                         NetworkSeriesView networkSeries,
+                         ViewportSeriesView viewportSeries,
+                         SimulationSeriesRef out,
+                         const ABRSimulation360Options &options = {}) {
+        if (options.Seed != 0)
+            throw invalid_argument("Simulations of single series draw from the enclosing random scope, "
+                                   "so the seed must be zero.");
+        SimulateSeries(streamingConfig, controllerOptions, allocatorOptions, networkSeries, viewportSeries, out,
+                       options);
     }
 
     /// Simulates a 360° adaptive bitrate streaming configuration on a collection of network series and viewport series.
@@ -185,9 +931,534 @@ public:
                          ViewportDataView viewportData,
                          SimulationDataRef out,
                          const ABRSimulation360Options &options = {}) {
+        if (!out.StageUs.data_handle()
+            && SimulateBatched(streamingConfig, controllerOptions, allocatorOptions, networkData, viewportData, options,
+                               [&](span<const int> sessionIDs, auto &&simulate) {
+                                   vector<SimulationSeriesRef> series;
+                                   for (const auto i : sessionIDs) {
+                                       series.push_back(out[i]);
+                                       ComputeViewportDistributions(streamingConfig, viewportData[i],
+                                                                    series.back().ViewportDistributions, options);
+                                   }
+                                   simulate(sessionIDs, series);
+                               }))
+            return;
+        Parallel::For(0, viewportData.PathCount(), [&](int i) {
+            const TraceScope traceScope(options.Tracer, i);
+            const RandomScope randomScope(options.Seed, i);
+            SimulateSeries(streamingConfig, controllerOptions, allocatorOptions,
+                           networkData[i], viewportData[i], out[i], options);
+        });
+    }
+
+    /// Simulates a 360° adaptive bitrate streaming configuration on a collection of network series and viewport series
+    /// into compact simulation series.
+    /// Each session is simulated into a buffer of its own and converted as it completes,
+    /// so that full-precision series are held only for sessions in progress.
+    /// Bitrate IDs are single bytes, so the bitrate ladder can have at most 256 bitrates.
+    /// @param streamingConfig The adaptive bitrate streaming configuration.
+    /// @param controllerOptions The options for the aggregate controller.
+    /// @param allocatorOptions The options for the bitrate allocator.
+    /// @param networkData A collection of network series.
+    /// @param viewportData A collection of viewport series.
+    /// @param out The compact simulation data output.
+    /// @param options The options for 360° adaptive bitrate streaming simulation.
+    static void Simulate(const StreamingConfig &streamingConfig,
+                         const BaseAggregateControllerOptions &controllerOptions,
+                         const BaseBitrateAllocatorOptions &allocatorOptions,
+                         NetworkDataView networkData,
+                         ViewportDataView viewportData,
+                         CompactSimulationDataRef out,
+                         const ABRSimulation360Options &options = {}) {
+        if (streamingConfig.BitratesPerFaceMbps.size() > numeric_limits<uint8_t>::max() + 1)
+            throw invalid_argument("Compact simulation series only hold bitrate IDs of up to 256 bitrates.");
+        const QoEEvaluator evaluator(streamingConfig);
+        SimulateBuffered(streamingConfig, controllerOptions, allocatorOptions, networkData, viewportData, options,
+                         [&](int i, const SimulationSeriesRef &series) {
+                             out.RebufferingSeconds[i] = series.RebufferingSeconds;
+                             for (auto segmentID = 0; segmentID < series.BufferedBitratesMbps.extent(0); ++segmentID)
+                                 for (auto tileID = 0; tileID < series.BufferedBitratesMbps.extent(1); ++tileID) {
+                                     const auto bitrateMbps = series.BufferedBitratesMbps[segmentID, tileID];
+                                     out.BitrateIDs[i, segmentID, tileID] =
+                                         static_cast<uint8_t>(evaluator.BitrateID(bitrateMbps));
+                                     out.ViewportDistributions[i, segmentID, tileID] =
+                                         static_cast<float>(series.ViewportDistributions[segmentID, tileID]);
+                                 }
+                             for (auto segmentID = 0; segmentID < series.AllocationUs.size(); ++segmentID) {
+                                 for (auto tileID = 0; tileID < series.BufferedBitratesMbps.extent(1); ++tileID)
+                                     out.PredictedViewportDistributions[i, segmentID, tileID] =
+                                         static_cast<float>(series.PredictedViewportDistributions[segmentID, tileID]);
+                                 out.AllocationUs[i, segmentID] = series.AllocationUs[segmentID];
+                             }
+                         });
+    }
+
+    /// Simulates a 360° adaptive bitrate streaming configuration on a collection of network series and viewport series
+    /// into quality-of-experience summaries.
+    /// Each session is simulated into a buffer of its own and summarized as it completes,
+    /// so that simulation series are held only for sessions in progress.
+    /// @param streamingConfig The adaptive bitrate streaming configuration.
+    /// @param controllerOptions The options for the aggregate controller.
+    /// @param allocatorOptions The options for the bitrate allocator.
+    /// @param networkData A collection of network series.
+    /// @param viewportData A collection of viewport series.
+    /// @param out The summary data output.
+    /// @param options The options for 360° adaptive bitrate streaming simulation.
+    static void Simulate(const StreamingConfig &streamingConfig,
+                         const BaseAggregateControllerOptions &controllerOptions,
+                         const BaseBitrateAllocatorOptions &allocatorOptions,
+                         NetworkDataView networkData,
+                         ViewportDataView viewportData,
+                         SummaryDataRef out,
+                         const ABRSimulation360Options &options = {}) {
+        const QoEEvaluator evaluator(streamingConfig);
+        SimulateBuffered(streamingConfig, controllerOptions, allocatorOptions, networkData, viewportData, options,
+                         [&](int i, const SimulationSeriesRef &series) {
+                             const span sessionQoE(&out.SessionQoE[i, 0], out.SessionQoE.extent(1));
+                             const auto segmentQoE = out.SegmentQoE.data_handle()
+                                                         ? submdspan(out.SegmentQoE, i, full_extent, full_extent)
+                                                         : mdspan<double, dims<2>>();
+                             evaluator.Evaluate(series.BufferedBitratesMbps, series.ViewportDistributions,
+                                                series.RebufferingSeconds, sessionQoE, segmentQoE);
+                         });
+    }
+
+    /// Simulates replicas of a 360° adaptive bitrate streaming configuration on a collection of network series and viewport series,
+    /// each of which draws its own random numbers.
+    /// Viewport distributions, network indices, and the first segment are computed once per session and shared by all replicas,
+    /// and replicas are forked from the session after its first segment, which involves no random numbers.
+    /// Each replica draws from random streams keyed by the seed, the index of the path, and the index of the replica,
+    /// so that the results do not depend on the number of threads or the order in which replicas run.
+    /// @param streamingConfig The adaptive bitrate streaming configuration.
+    /// @param controllerOptions The options for the aggregate controller.
+    /// @param allocatorOptions The options for the bitrate allocator.
+    /// @tparam TNetworkData The type of the collection of network series, such as NetworkDataView or NetworkTraceFile.
+    /// @tparam TViewportData The type of the collection of viewport series, such as ViewportDataView or ViewportTraceFile.
+    /// @param networkData A collection of network series.
+    /// @param viewportData A collection of viewport series.
+    /// @param out The simulation data output stacked over replicas.
+    /// @param options The options for 360° adaptive bitrate streaming simulation.
+    template<typename TNetworkData, typename TViewportData>
+    static void SimulateReplicas(const StreamingConfig &streamingConfig,
+                                 const BaseAggregateControllerOptions &controllerOptions,
+                                 const BaseBitrateAllocatorOptions &allocatorOptions,
+                                 const TNetworkData &networkData,
+                                 const TViewportData &viewportData,
+                                 SweepDataRef out,
+                                 const ABRSimulation360Options &options = {}) {
+        const auto replicaCount = static_cast<int>(out.RebufferingSeconds.extent(0));
+        const auto sessionCount = viewportData.PathCount();
+        if (replicaCount == 0) return;
+
+        const auto Run = [&]<typename TThroughputPredictor, typename TController, typename TAllocator>(
+            TThroughputPredictor &&throughputPredictor, TController &&controller, TAllocator &&allocator) {
+            using Session = BasicABRSession360<TThroughputPredictor, TController, TAllocator>;
+            // Forks all replicas of a session before any of them runs,
+            // so that no replica writes to the output of the first replica while it is still being copied.
+            vector<optional<NetworkTraceIndex>> networkIndices(sessionCount);
+            vector<optional<Session>> replicas(replicaCount * sessionCount);
+            Parallel::For(0, sessionCount, [&](int i) {
+                const auto distributions = submdspan(out.ViewportDistributions, i, full_extent, full_extent);
+                ComputeViewportDistributions(streamingConfig, viewportData[i], distributions, options);
+                if (options.UsesNetworkIndex) networkIndices[i].emplace(networkData[i]);
+                const TraceScope traceScope(options.Tracer, i);
+                const auto networkSimulator = networkIndices[i]
+                                                  ? NetworkSimulator(*networkIndices[i])
+                                                  : NetworkSimulator(networkData[i]);
+                Session session(streamingConfig, SessionComponent<TController>(TController(controller)),
+                                SessionComponent<TAllocator>(TAllocator(allocator)),
+                                SessionComponent<TThroughputPredictor>(TThroughputPredictor(throughputPredictor)),
+                                networkSimulator, viewportData[i], out[0, i], options);
+                for (auto replicaIndex = 1; replicaIndex < replicaCount; ++replicaIndex)
+                    replicas[replicaIndex * sessionCount + i].emplace(session.Fork(out[replicaIndex, i]));
+                replicas[i].emplace(move(session));
+            });
+            Parallel::For(0, replicaCount * sessionCount, [&](int k) {
+                const auto replicaIndex = k / sessionCount, sessionIndex = k % sessionCount;
+                const TraceScope traceScope(options.Tracer, k);
+                const RandomScope randomScope(options.Seed, sessionIndex, replicaIndex);
+                replicas[k]->Run();
+                replicas[k].reset();
+            });
+        };
+        visit(Run, ThroughputPredictorFactory::CreateVariant(options.ThroughputPredictorOptions),
+              AggregateControllerFactory::CreateVariant(streamingConfig, controllerOptions),
+              BitrateAllocatorFactory::CreateVariant(streamingConfig, allocatorOptions));
+    }
+
+    /// Simulates a list of 360° adaptive bitrate streaming configurations on a collection of network series and viewport series.
+    /// Viewport distributions are computed once per session and shared by all configurations.
+    /// @param streamingConfig The adaptive bitrate streaming configuration.
+    /// @param controllerOptions A list of options for the aggregate controller, one per configuration.
+    /// @param allocatorOptions A list of options for the bitrate allocator, one per configuration.
+    /// @tparam TNetworkData The type of the collection of network series, such as NetworkDataView or NetworkTraceFile.
+    /// @tparam TViewportData The type of the collection of viewport series, such as ViewportDataView or ViewportTraceFile.
+    /// @param networkData A collection of network series.
+    /// @param viewportData A collection of viewport series.
+    /// @param out The simulation data output stacked over configurations.
+    /// @param options The options for 360° adaptive bitrate streaming simulation.
+    template<typename TNetworkData, typename TViewportData>
+    static void Sweep(const StreamingConfig &streamingConfig,
+                      span<const BaseAggregateControllerOptions *const> controllerOptions,
+                      span<const BaseBitrateAllocatorOptions *const> allocatorOptions,
+                      const TNetworkData &networkData,
+                      const TViewportData &viewportData,
+                      SweepDataRef out,
+                      const ABRSimulation360Options &options = {}) {
+        if (controllerOptions.size() != allocatorOptions.size())
+            throw invalid_argument("The numbers of controller and allocator options must be equal.");
+        const auto configCount = static_cast<int>(controllerOptions.size());
+        const auto sessionCount = viewportData.PathCount();
+
+        vector<optional<NetworkTraceIndex>> networkIndices(sessionCount);
+        Parallel::For(0, sessionCount, [&](int i) {
+            const auto distributions = submdspan(out.ViewportDistributions, i, full_extent, full_extent);
+            ComputeViewportDistributions(streamingConfig, viewportData[i], distributions, options);
+            if (options.UsesNetworkIndex) networkIndices[i].emplace(networkData[i]);
+        });
+        Parallel::For(0, configCount * sessionCount, [&](int k) {
+            const auto configIndex = k / sessionCount, sessionIndex = k % sessionCount;
+            const TraceScope traceScope(options.Tracer, k);
+            const RandomScope randomScope(options.Seed, sessionIndex);
+            const auto &networkIndex = networkIndices[sessionIndex];
+            const auto networkSimulator = networkIndex
+                                              ? NetworkSimulator(*networkIndex)
+                                              : NetworkSimulator(networkData[sessionIndex]);
+            RunSession(streamingConfig, *controllerOptions[configIndex], *allocatorOptions[configIndex],
+                       networkSimulator, viewportData[sessionIndex], out[configIndex, sessionIndex], options);
+        });
+    }
+
+    /// Simulates branches of 360° adaptive bitrate streaming configurations that share a common prefix on a collection of network series and viewport series.
+    /// Each session is simulated once with the prefix configuration until the fork segment,
+    /// and then forked into one branch per configuration that continues independently.
+    /// @param streamingConfig The adaptive bitrate streaming configuration.
+    /// @param controllerOptions The options for the aggregate controller of the prefix.
+    /// @param allocatorOptions The options for the bitrate allocator of the prefix.
+    /// @param forkSegmentID The ID of the first segment downloaded by the branches.
+    /// @param branchControllerOptions A list of options for the aggregate controller, one per branch (null to continue with the prefix controller).
+    /// @param branchAllocatorOptions A list of options for the bitrate allocator, one per branch (null to continue with the prefix allocator).
+    /// @tparam TNetworkData The type of the collection of network series, such as NetworkDataView or NetworkTraceFile.
+    /// @tparam TViewportData The type of the collection of viewport series, such as ViewportDataView or ViewportTraceFile.
+    /// @param networkData A collection of network series.
+    /// @param viewportData A collection of viewport series.
+    /// @param out The simulation data output stacked over branches.
+    /// @param options The options for 360° adaptive bitrate streaming simulation.
+    template<typename TNetworkData, typename TViewportData>
+    static void Fork(const StreamingConfig &streamingConfig,
+                     const BaseAggregateControllerOptions &controllerOptions,
+                     const BaseBitrateAllocatorOptions &allocatorOptions,
+                     int forkSegmentID,
+                     span<const BaseAggregateControllerOptions *const> branchControllerOptions,
+                     span<const BaseBitrateAllocatorOptions *const> branchAllocatorOptions,
+                     const TNetworkData &networkData,
+                     const TViewportData &viewportData,
+                     SweepDataRef out,
+                     const ABRSimulation360Options &options = {}) {
+        if (branchControllerOptions.size() != branchAllocatorOptions.size())
+            throw invalid_argument("The numbers of controller and allocator options must be equal.");
+        const auto branchCount = static_cast<int>(branchControllerOptions.size());
+        const auto sessionCount = viewportData.PathCount();
+        if (branchCount == 0) return;
+
+        // Simulates each prefix in the output of the first branch, then forks all branches before any of them runs,
+        // so that no branch writes to an output that is still being copied.
+        vector<optional<NetworkTraceIndex>> networkIndices(sessionCount);
+        vector<optional<ABRSession360>> branches(branchCount * sessionCount);
+        Parallel::For(0, sessionCount, [&](int i) {
+            const auto distributions = submdspan(out.ViewportDistributions, i, full_extent, full_extent);
+            ComputeViewportDistributions(streamingConfig, viewportData[i], distributions, options);
+            if (options.UsesNetworkIndex) networkIndices[i].emplace(networkData[i]);
+            const TraceScope traceScope(options.Tracer, i);
+            const RandomScope randomScope(options.Seed, i);
+            const auto networkSimulator = networkIndices[i]
+                                              ? NetworkSimulator(*networkIndices[i])
+                                              : NetworkSimulator(networkData[i]);
+            ABRSession360 prefix(streamingConfig, controllerOptions, allocatorOptions, networkSimulator,
+                                 viewportData[i], out[0, i], options);
+            prefix.RunUntil(forkSegmentID);
+            for (auto branchIndex = 0; branchIndex < branchCount; ++branchIndex)
+                branches[branchIndex * sessionCount + i].emplace(prefix.Fork(
+                    out[branchIndex, i], branchControllerOptions[branchIndex], branchAllocatorOptions[branchIndex]));
+        });
+        Parallel::For(0, branchCount * sessionCount, [&](int k) {
+            const TraceScope traceScope(options.Tracer, k);
+            const RandomScope randomScope(options.Seed, k % sessionCount);
+            branches[k]->Run();
+            branches[k].reset();
+        });
+    }
+
+    /// Simulates 360° adaptive bitrate streaming clients that share a bottleneck link as a discrete-event simulation.
+    /// Each client is a session with its own components on a viewport series of its own,
+    /// which requests segments from the link when it starts, when its previous segment completes,
+    /// or when its buffer has drained enough after idling. Events are processed in time order from a heap,
+    /// and sessions are specialized on the concrete types of their components and stored contiguously,
+    /// so that thousands of clients can share a link in a single thread.
+    /// @param streamingConfig The adaptive bitrate streaming configuration.
+    /// @param controllerOptions The options for the aggregate controller.
+    /// @param allocatorOptions The options for the bitrate allocator.
+    /// @param linkSeries A network series of link capacities.
+    /// @param viewportSeries A list of viewport series, one per client.
+    /// @param startSeconds A list of times at which clients start in seconds, one per client.
+    /// @param policy The policy that shares the link among concurrent downloads.
+    /// @param out A list of simulation series outputs, one per client.
+    /// @param options The options for 360° adaptive bitrate streaming simulation.
+    static void SimulateSharedLink(const StreamingConfig &streamingConfig,
+                                   const BaseAggregateControllerOptions &controllerOptions,
+                                   const BaseBitrateAllocatorOptions &allocatorOptions,
+                                   NetworkSeriesView linkSeries,
+                                   span<const ViewportSeriesView> viewportSeries,
+                                   span<const double> startSeconds,
+                                   const ILinkSharePolicy &policy,
+                                   span<const SimulationSeriesRef> out,
+                                   const ABRSimulation360Options &options = {}) {
+        const auto clientCount = static_cast<int>(viewportSeries.size());
+        if (startSeconds.size() != clientCount || out.size() != clientCount)
+            throw invalid_argument("The numbers of viewport series, start times, and outputs must be equal.");
+        Parallel::For(0, clientCount, [&](int i) {
+            ComputeViewportDistributions(streamingConfig, viewportSeries[i], out[i].ViewportDistributions, options);
+        });
+
+        const auto Run = [&]<typename TThroughputPredictor, typename TController, typename TAllocator>(
+            TThroughputPredictor &&throughputPredictor, TController &&controller, TAllocator &&allocator) {
+            using Session = BasicABRSession360<TThroughputPredictor, TController, TAllocator>;
+            vector<Session> sessions;
+            sessions.reserve(clientCount);
+            for (auto i = 0; i < clientCount; ++i) {
+                sessions.emplace_back(streamingConfig, SessionComponent<TController>(TController(controller)),
+                                      SessionComponent<TAllocator>(TAllocator(allocator)),
+                                      SessionComponent<TThroughputPredictor>(TThroughputPredictor(throughputPredictor)),
+                                      nullopt, viewportSeries[i], out[i], options);
+            }
+
+            // Requests are events ordered by time, and downloads are ordered by the link.
+            using Request = pair<double, int>;
+            priority_queue<Request, vector<Request>, greater<>> requests;
+            for (auto i = 0; i < clientCount; ++i) requests.emplace(startSeconds[i], i);
+            vector<double> requestSeconds(clientCount);
+            SharedLinkSimulator link(linkSeries);
+            while (!requests.empty() || link.DownloadCount() > 0) {
+                const auto endSeconds = requests.empty() ? numeric_limits<double>::infinity() : requests.top().first;
+                if (const auto clientID = link.AdvanceUntil(endSeconds)) {
+                    auto &session = sessions[*clientID];
+                    const TraceScope traceScope(options.Tracer, *clientID);
+                    const RandomScope randomScope(options.Seed, *clientID);
+                    session.Complete(link.Seconds() - requestSeconds[*clientID]);
+                    if (!session.IsFinished()) requests.emplace(link.Seconds() + session.IdleSeconds(), *clientID);
+                } else {
+                    const auto clientID = requests.top().second;
+                    requests.pop();
+                    const TraceScope traceScope(options.Tracer, clientID);
+                    const RandomScope randomScope(options.Seed, clientID);
+                    const auto sizeMB = sessions[clientID].Request();
+                    requestSeconds[clientID] = link.Seconds();
+                    link.Start(clientID, sizeMB, policy.Weight(clientID, sizeMB));
+                }
+            }
+        };
+        visit(Run, ThroughputPredictorFactory::CreateVariant(options.ThroughputPredictorOptions),
+              AggregateControllerFactory::CreateVariant(streamingConfig, controllerOptions),
+              BitrateAllocatorFactory::CreateVariant(streamingConfig, allocatorOptions));
+    }
+
+    /// Estimates the errors of precomputed viewport distributions on a collection of viewport series.
+    /// The error of a session is the mean total variation distance between precomputed and exact viewport distributions
+    /// over the first viewport position of each segment, which keeps the cost of the exact computation small.
+    /// @param streamingConfig The adaptive bitrate streaming configuration.
+    /// @param viewportData A collection of viewport series.
+    /// @param simulatorOptions The options for the viewport simulator.
+    /// @param out The approximation errors, one per session (0 for exact computation).
+    static void ViewportApproximationErrors(const StreamingConfig &streamingConfig,
+                                            ViewportDataView viewportData,
+                                            const ViewportSimulatorOptions &simulatorOptions,
+                                            span<double> out) {
+        const auto segmentSeconds = streamingConfig.SegmentSeconds;
         Parallel::For(0, viewportData.PathCount(), [&](int i) {
-            Simulate(streamingConfig, controllerOptions, allocatorOptions,
-                     networkData[i], viewportData[i], out[i], options);
+            const auto viewportSeries = viewportData[i];
+            const auto segmentCount = Math::Round(viewportSeries.DurationSeconds() / segmentSeconds);
+            vector<SphericalPosition> positions;
+            for (auto segmentID = 0; segmentID < segmentCount; ++segmentID) {
+                const auto segmentPositions = viewportSeries.Window(segmentID * segmentSeconds, segmentSeconds).Values;
+                if (!segmentPositions.empty()) positions.push_back(segmentPositions.front());
+            }
+            ViewportSimulator simulator(streamingConfig.ViewportConfig, streamingConfig.TilingCount, simulatorOptions);
+            out[i] = simulator.ApproximationError(positions);
+        });
+    }
+
+    /// Simulates a 360° adaptive bitrate streaming configuration on a collection of network series and viewport series,
+    /// where each session is simulated into a buffer of its own that is passed to a reducer as the session completes.
+    /// Sessions without segments are skipped, and sessions are simulated in batches of lanes if enabled by the options.
+    /// @tparam TNetworkData The type of the collection of network series, such as NetworkDataView or NetworkTraceFile.
+    /// @tparam TViewportData The type of the collection of viewport series, such as ViewportDataView or ViewportTraceFile.
+    /// @param streamingConfig The adaptive bitrate streaming configuration.
+    /// @param controllerOptions The options for the aggregate controller.
+    /// @param allocatorOptions The options for the bitrate allocator.
+    /// @param networkData A collection of network series.
+    /// @param viewportData A collection of viewport series.
+    /// @param options The options for 360° adaptive bitrate streaming simulation.
+    /// @param reduce A callable that is passed the index and simulation series of each session, possibly concurrently.
+    template<typename TNetworkData, typename TViewportData, typename F>
+    static void SimulateBuffered(const StreamingConfig &streamingConfig,
+                                 const BaseAggregateControllerOptions &controllerOptions,
+                                 const BaseBitrateAllocatorOptions &allocatorOptions,
+                                 const TNetworkData &networkData,
+                                 const TViewportData &viewportData,
+                                 const ABRSimulation360Options &options,
+                                 F &&reduce) {
+        const auto tileCount = streamingConfig.TilingCount * streamingConfig.TilingCount * 6;
+        const auto SegmentCount = [&](int i) {
+            return Math::Round(viewportData[i].DurationSeconds() / streamingConfig.SegmentSeconds);
+        };
+        if (SimulateBatched(streamingConfig, controllerOptions, allocatorOptions, networkData, viewportData, options,
+                            [&](span<const int> sessionIDs, auto &&simulate) {
+                                deque<SimulationSeriesBuffer> buffers;
+                                vector<int> bufferedIDs;
+                                vector<SimulationSeriesRef> series;
+                                for (const auto i : sessionIDs) {
+                                    const auto segmentCount = SegmentCount(i);
+                                    if (segmentCount < 1) continue;
+                                    bufferedIDs.push_back(i);
+                                    series.push_back(buffers.emplace_back(segmentCount, tileCount).Ref());
+                                    ComputeViewportDistributions(streamingConfig, viewportData[i],
+                                                                 series.back().ViewportDistributions, options);
+                                }
+                                simulate(bufferedIDs, series);
+                                for (size_t laneID = 0; laneID < series.size(); ++laneID)
+                                    reduce(bufferedIDs[laneID], series[laneID]);
+                            }))
+            return;
+        Parallel::For(0, viewportData.PathCount(), [&](int i) {
+            const auto viewportSeries = viewportData[i];
+            const auto segmentCount = SegmentCount(i);
+            if (segmentCount < 1) return;
+
+            const TraceScope traceScope(options.Tracer, i);
+            const RandomScope randomScope(options.Seed, i);
+            SimulationSeriesBuffer buffer(segmentCount, tileCount);
+            const auto series = buffer.Ref();
+            SimulateSeries(streamingConfig, controllerOptions, allocatorOptions, networkData[i], viewportSeries, series,
+                           options);
+            reduce(i, series);
         });
     }
+
+private:
+    // Simulates a session on a network series and viewport series in the enclosing random scope.
+    static void SimulateSeries(const StreamingConfig &streamingConfig,
+                               const BaseAggregateControllerOptions &controllerOptions,
+                               const BaseBitrateAllocatorOptions &allocatorOptions,
+                               NetworkSeriesView networkSeries,
+                               ViewportSeriesView viewportSeries,
+                               SimulationSeriesRef out,
+                               const ABRSimulation360Options &options) {
+        ComputeViewportDistributions(streamingConfig, viewportSeries, out.ViewportDistributions, options);
+        optional<NetworkTraceIndex> networkIndex;
+        if (options.UsesNetworkIndex) networkIndex.emplace(networkSeries);
+        const auto networkSimulator = networkIndex ? NetworkSimulator(*networkIndex) : NetworkSimulator(networkSeries);
+        RunSession(streamingConfig, controllerOptions, allocatorOptions, networkSimulator, viewportSeries, out,
+                   options);
+        if (options.StageHistograms && out.StageUs.data_handle()) options.StageHistograms->Add(out.StageUs);
+    }
+
+    // Simulates a session specialized on the concrete types of its components, which are resolved once per session.
+    static void RunSession(const StreamingConfig &streamingConfig,
+                           const BaseAggregateControllerOptions &controllerOptions,
+                           const BaseBitrateAllocatorOptions &allocatorOptions,
+                           const NetworkSimulator &networkSimulator,
+                           ViewportSeriesView viewportSeries,
+                           SimulationSeriesRef out,
+                           const ABRSimulation360Options &options) {
+        const auto Run = [&]<typename TThroughputPredictor, typename TController, typename TAllocator>(
+            TThroughputPredictor &&throughputPredictor, TController &&controller, TAllocator &&allocator) {
+            BasicABRSession360<TThroughputPredictor, TController, TAllocator>(
+                streamingConfig, SessionComponent<TController>(move(controller)),
+                SessionComponent<TAllocator>(move(allocator)),
+                SessionComponent<TThroughputPredictor>(move(throughputPredictor)),
+                networkSimulator, viewportSeries, out, options).Run();
+        };
+        visit(Run, ThroughputPredictorFactory::CreateVariant(options.ThroughputPredictorOptions),
+              AggregateControllerFactory::CreateVariant(streamingConfig, controllerOptions),
+              BitrateAllocatorFactory::CreateVariant(streamingConfig, allocatorOptions));
+    }
+
+    // Simulates sessions in batches of lanes if batching is enabled and supported by the components,
+    // and returns whether the sessions have been simulated.
+    // The preparer of each batch is passed the IDs of its sessions and a callable that simulates a subset of them
+    // into a list of outputs, whose viewport distributions must have been computed.
+    template<typename TNetworkData, typename TViewportData, typename F>
+    static bool SimulateBatched(const StreamingConfig &streamingConfig,
+                                const BaseAggregateControllerOptions &controllerOptions,
+                                const BaseBitrateAllocatorOptions &allocatorOptions,
+                                const TNetworkData &networkData,
+                                const TViewportData &viewportData,
+                                const ABRSimulation360Options &options,
+                                F &&prepareBatch) {
+        const auto laneCount = options.LaneCount;
+        if (laneCount <= 0 || options.Tracer
+            || dynamic_cast<const OfflinePredictorOptions *>(&options.ViewportPredictorOptions))
+            return false;
+
+        const auto Run = [&]<typename TThroughputPredictor, typename TController, typename TAllocator>(
+            TThroughputPredictor &&throughputPredictor, TController &&controller, TAllocator &&allocator) {
+            if constexpr (!LaneSharedComponent<TController> || !LaneSharedComponent<TAllocator>) return false;
+            else {
+                using Batch = BasicABRSessionBatch360<TThroughputPredictor, TController, TAllocator>;
+                // Batches sessions of similar durations, so that few lanes of a batch finish early.
+                const auto sessionCount = viewportData.PathCount();
+                auto sessionIDs = views::iota(0, sessionCount) | ranges::to<vector>();
+                ranges::stable_sort(sessionIDs, greater(), [&](int i) {
+                    return viewportData[i].DurationSeconds();
+                });
+                Parallel::For(0, (sessionCount + laneCount - 1) / laneCount, [&](int batchID) {
+                    const auto beginID = batchID * laneCount;
+                    const auto SimulateLanes = [&](span<const int> laneSessionIDs,
+                                                   span<const SimulationSeriesRef> out) {
+                        deque<NetworkTraceIndex> networkIndices;
+                        vector<NetworkSimulator> networkSimulators;
+                        vector<ViewportSeriesView> viewportSeries;
+                        for (const auto i : laneSessionIDs) {
+                            if (options.UsesNetworkIndex)
+                                networkSimulators.emplace_back(networkIndices.emplace_back(networkData[i]));
+                            else networkSimulators.emplace_back(networkData[i]);
+                            viewportSeries.push_back(viewportData[i]);
+                        }
+                        Batch(streamingConfig, TController(controller), TAllocator(allocator), throughputPredictor,
+                              networkSimulators, viewportSeries, out, options).Run();
+                    };
+                    prepareBatch(span(sessionIDs).subspan(beginID, min(laneCount, sessionCount - beginID)),
+                                 SimulateLanes);
+                });
+                return true;
+            }
+        };
+        return visit(Run, ThroughputPredictorFactory::CreateVariant(options.ThroughputPredictorOptions),
+                     AggregateControllerFactory::CreateVariant(streamingConfig, controllerOptions),
+                     BitrateAllocatorFactory::CreateVariant(streamingConfig, allocatorOptions));
+    }
+
+    static void ComputeViewportDistributions(const StreamingConfig &streamingConfig,
+                                             ViewportSeriesView viewportSeries,
+                                             mdspan<double, dims<2>> distributions,
+                                             const ABRSimulation360Options &options) {
+        const auto segmentSeconds = streamingConfig.SegmentSeconds;
+        const auto segmentCount = Math::Round(viewportSeries.DurationSeconds() / segmentSeconds);
+        const auto tilingCount = streamingConfig.TilingCount;
+        const auto tileCount = tilingCount * tilingCount * 6;
+        auto *const cache = options.DistributionCache;
+        uint64_t cacheKey = 0;
+        if (cache) {
+            cacheKey = DistributionCache::Key(viewportSeries, streamingConfig, options.ViewportSimulatorOptions);
+            if (cache->TryLoad(cacheKey, distributions)) return;
+        }
+
+        ViewportSimulator viewportSimulator(streamingConfig.ViewportConfig, tilingCount,
+                                            options.ViewportSimulatorOptions);
+        for (auto segmentID = 0; segmentID < segmentCount; ++segmentID) {
+            const auto positions = viewportSeries.Window(segmentID * segmentSeconds, segmentSeconds).Values;
+            viewportSimulator.ToDistribution(positions, span(&distributions[segmentID, 0], tileCount));
+        }
+        if (cache) cache->Store(cacheKey, distributions);
+    }
 };
@@ -17,6 +17,16 @@ using namespace std;
     if (const auto *const _options = dynamic_cast<const CONCAT(T, Options) *>(&options)) \
         return make_unique<T>(streamingConfig, *_options);
 
+#define TRY_CREATE_VARIANT(T) \
+    if (const auto *const _options = dynamic_cast<const CONCAT(T, Options) *>(&options)) \
+        return AggregateControllerVariant(in_place_type<T>, streamingConfig, *_options);
+
+/// Represents a built-in aggregate controller held by value, so that calls on it can be resolved at compile time.
+export using AggregateControllerVariant = variant<
+    ModelPredictiveController,
+    ThroughputBasedController
+>;
+
 /// Represents a factory for aggregate controllers.
 export class AggregateControllerFactory {
 public:
@@ -32,4 +42,17 @@ public:
                  ))
         throw runtime_error("Unknown aggregate controller options.");
     }
+
+    /// Creates an aggregate controller of a built-in type with the specified configuration and options.
+    /// @param streamingConfig The adaptive bitrate streaming configuration.
+    /// @param options The options for the aggregate controller.
+    /// @returns An aggregate controller with the specified configuration and options.
+    [[nodiscard]] static AggregateControllerVariant CreateVariant(const StreamingConfig &streamingConfig,
+                                                                  const BaseAggregateControllerOptions &options) {
+        FOR_EACH(TRY_CREATE_VARIANT, (
+                     ModelPredictiveController,
+                     ThroughputBasedController
+                 ))
+        throw runtime_error("Unknown aggregate controller options.");
+    }
 };
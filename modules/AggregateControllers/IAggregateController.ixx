@@ -35,6 +35,10 @@ export class IAggregateController {
 public:
     virtual ~IAggregateController() = default;
 
+    /// Creates a copy of the aggregate controller including its state.
+    /// @returns A copy of the aggregate controller.
+    [[nodiscard]] virtual unique_ptr<IAggregateController> Clone() const = 0;
+
     /// Gets the aggregate bitrate decision in megabits per second given the specified context.
     /// @param context The context for the aggregate controller.
     /// @returns The aggregate bitrate decision in megabits per second given the specified context.
@@ -18,6 +18,8 @@ export struct ModelPredictiveControllerOptions : BaseAggregateControllerOptions
     double TargetBufferRatio = 0.6; ///< The target buffer level (normalized by the maximum buffer level).
     double BufferCostWeight = 1.; ///< The weight of buffer cost.
     double SwitchingCostWeight = 0.5; ///< The weight of switching cost.
+    /// The resolution of buffer levels for dynamic programming in seconds (0 for exhaustive search).
+    double BufferResolutionSeconds = 0.;
 };
 
 export {
@@ -25,17 +27,25 @@ export {
                         WindowLength,
                         TargetBufferRatio,
                         BufferCostWeight,
-                        SwitchingCostWeight
+                        SwitchingCostWeight,
+                        BufferResolutionSeconds
                     ))
 }
 
 /// A model predictive controller decides aggregate bitrates by optimizing an objective function over multiple segments.
-export class ModelPredictiveController : public BaseDiscreteAggregateController {
+/// The optimization is either an exhaustive search or a backward dynamic program over discretized buffer levels,
+/// which is exact when all reachable buffer levels lie on the discretization grid.
+export class ModelPredictiveController final : public BaseDiscreteAggregateController {
     int _windowLength;
     double _targetBufferSeconds;
     double _bufferCostWeight, _switchingCostWeight;
+    double _bufferResolutionSeconds;
+    int _bufferLevelCount = 0;
 
     int _prevBitrateID = 0;
+    vector<double> _downloadSeconds;
+    vector<double> _immediateObjectives, _values, _futureValues;
+    vector<int> _nextBufferLevels;
 
 public:
     /// Creates a model predictive controller with the specified configuration and options.
@@ -45,46 +55,128 @@ public:
                                        const ModelPredictiveControllerOptions &options = {}) :
         BaseDiscreteAggregateController(streamingConfig, options), _windowLength(options.WindowLength),
         _targetBufferSeconds(options.TargetBufferRatio * _maxBufferSeconds),
-        _bufferCostWeight(options.BufferCostWeight), _switchingCostWeight(options.SwitchingCostWeight) {
+        _bufferCostWeight(options.BufferCostWeight), _switchingCostWeight(options.SwitchingCostWeight),
+        _bufferResolutionSeconds(options.BufferResolutionSeconds) {
+        if (_bufferResolutionSeconds > 0.)
+            _bufferLevelCount = Math::Round(_maxBufferSeconds / _bufferResolutionSeconds) + 1;
+    }
+
+    [[nodiscard]] unique_ptr<IAggregateController> Clone() const override {
+        return make_unique<ModelPredictiveController>(*this);
     }
 
     [[nodiscard]] double GetAggregateBitrateMbps(const AggregateControllerContext &context) override {
         const auto throughputMbps = context.ThroughputMbps * _throughputDiscount;
-        const auto downloadSeconds = _bitratesMbps | views::transform([&](double bitrateMbps) {
+        _downloadSeconds.resize(_bitratesMbps.size());
+        ranges::transform(_bitratesMbps, _downloadSeconds.begin(), [&](double bitrateMbps) {
             return bitrateMbps * _segmentSeconds / throughputMbps;
-        }) | ranges::to<vector>();
-
-        const function<pair<optional<int>, double>(int, double, int, int)> OptBitrateIDAndObjective =
-            [&](int segmentID, double bufferSeconds, int prevBitrateID, int step) {
-            const auto endBitrateID = step == -1 ? -1 : static_cast<int>(_bitratesMbps.size());
-
-            optional<int> optBitrateID;
-            auto optObjective = -numeric_limits<double>::infinity();
-            for (auto bitrateID = prevBitrateID; bitrateID != endBitrateID; bitrateID += step) {
-                if (downloadSeconds[bitrateID] > bufferSeconds) continue;
-
-                auto nextBufferSeconds = bufferSeconds - downloadSeconds[bitrateID];
-                auto objective = Objective(bitrateID, nextBufferSeconds, prevBitrateID);
-                nextBufferSeconds = min(nextBufferSeconds + _segmentSeconds, _maxBufferSeconds);
-                if (segmentID < _windowLength - 1) {
-                    const auto [optNextBitrateID, optFutureObjective]
-                        = OptBitrateIDAndObjective(segmentID + 1, nextBufferSeconds, bitrateID, step);
-                    if (!optNextBitrateID) continue;
-                    objective += optFutureObjective;
-                }
-                if (objective > optObjective) optBitrateID = bitrateID, optObjective = objective;
-            }
-            return pair(optBitrateID, optObjective);
-        };
+        });
 
         const auto bufferSeconds = context.BufferSeconds;
-        const auto [optBitrateID0, optObjective0] = OptBitrateIDAndObjective(0, bufferSeconds, _prevBitrateID, -1);
+        const auto OptBitrateIDAndObjective = [&](int step) {
+            return _bufferLevelCount > 0
+                       ? DynamicProgramming(bufferSeconds, step)
+                       : ExhaustiveSearch(0, bufferSeconds, _prevBitrateID, step);
+        };
+        const auto [optBitrateID0, optObjective0] = OptBitrateIDAndObjective(-1);
         if (!optBitrateID0) return _bitratesMbps[_prevBitrateID = 0];
-        const auto [optBitrateID1, optObjective1] = OptBitrateIDAndObjective(0, bufferSeconds, _prevBitrateID, 1);
+        const auto [optBitrateID1, optObjective1] = OptBitrateIDAndObjective(1);
         return _bitratesMbps[_prevBitrateID = optObjective1 > optObjective0 ? *optBitrateID1 : *optBitrateID0];
     }
 
 private:
+    [[nodiscard]] pair<optional<int>, double> ExhaustiveSearch(int segmentID, double bufferSeconds,
+                                                               int prevBitrateID, int step) const {
+        const auto endBitrateID = step == -1 ? -1 : static_cast<int>(_bitratesMbps.size());
+
+        optional<int> optBitrateID;
+        auto optObjective = -numeric_limits<double>::infinity();
+        for (auto bitrateID = prevBitrateID; bitrateID != endBitrateID; bitrateID += step) {
+            if (_downloadSeconds[bitrateID] > bufferSeconds) continue;
+
+            auto nextBufferSeconds = bufferSeconds - _downloadSeconds[bitrateID];
+            auto objective = Objective(bitrateID, nextBufferSeconds, prevBitrateID);
+            nextBufferSeconds = min(nextBufferSeconds + _segmentSeconds, _maxBufferSeconds);
+            if (segmentID < _windowLength - 1) {
+                const auto [optNextBitrateID, optFutureObjective]
+                    = ExhaustiveSearch(segmentID + 1, nextBufferSeconds, bitrateID, step);
+                if (!optNextBitrateID) continue;
+                objective += optFutureObjective;
+            }
+            if (objective > optObjective) optBitrateID = bitrateID, optObjective = objective;
+        }
+        return {optBitrateID, optObjective};
+    }
+
+    [[nodiscard]] pair<optional<int>, double> DynamicProgramming(double bufferSeconds, int step) {
+        const auto bitrateCount = static_cast<int>(_bitratesMbps.size());
+        const auto infinity = numeric_limits<double>::infinity();
+
+        // Tabulates the objective without switching cost and the next buffer level for each (buffer level, bitrate).
+        _immediateObjectives.resize(_bufferLevelCount * bitrateCount);
+        _nextBufferLevels.resize(_bufferLevelCount * bitrateCount);
+        for (auto level = 0; level < _bufferLevelCount; ++level) {
+            const auto levelSeconds = min(level * _bufferResolutionSeconds, _maxBufferSeconds);
+            for (auto bitrateID = 0; bitrateID < bitrateCount; ++bitrateID) {
+                const auto index = level * bitrateCount + bitrateID;
+                if (_downloadSeconds[bitrateID] > levelSeconds) {
+                    _immediateObjectives[index] = -infinity, _nextBufferLevels[index] = 0;
+                    continue;
+                }
+                const auto nextBufferSeconds = levelSeconds - _downloadSeconds[bitrateID];
+                _immediateObjectives[index] = _utilities[bitrateID] * _segmentSeconds
+                    - _bufferCostWeight * BufferCost(nextBufferSeconds);
+                _nextBufferLevels[index] = BufferLevel(min(nextBufferSeconds + _segmentSeconds, _maxBufferSeconds));
+            }
+        }
+
+        // Indexed by (previous bitrate, buffer level), holds the optimal objective of the remaining segments.
+        _futureValues.assign(bitrateCount * _bufferLevelCount, 0.);
+        _values.resize(bitrateCount * _bufferLevelCount);
+        for (auto segmentID = _windowLength - 1; segmentID > 0; --segmentID) {
+            for (auto prevBitrateID = 0; prevBitrateID < bitrateCount; ++prevBitrateID) {
+                const auto endBitrateID = step == -1 ? -1 : bitrateCount;
+                for (auto level = 0; level < _bufferLevelCount; ++level) {
+                    auto optObjective = -infinity;
+                    for (auto bitrateID = prevBitrateID; bitrateID != endBitrateID; bitrateID += step) {
+                        const auto index = level * bitrateCount + bitrateID;
+                        const auto immediateObjective = _immediateObjectives[index];
+                        if (immediateObjective == -infinity) continue;
+                        const auto futureObjective =
+                            _futureValues[bitrateID * _bufferLevelCount + _nextBufferLevels[index]];
+                        if (futureObjective == -infinity) continue;
+                        const auto objective = immediateObjective
+                            - _switchingCostWeight * SwitchingCost(prevBitrateID, bitrateID) + futureObjective;
+                        optObjective = max(optObjective, objective);
+                    }
+                    _values[prevBitrateID * _bufferLevelCount + level] = optObjective;
+                }
+            }
+            swap(_values, _futureValues);
+        }
+
+        // Decides the first segment from the exact buffer level.
+        const auto endBitrateID = step == -1 ? -1 : bitrateCount;
+        optional<int> optBitrateID;
+        auto optObjective = -infinity;
+        for (auto bitrateID = _prevBitrateID; bitrateID != endBitrateID; bitrateID += step) {
+            if (_downloadSeconds[bitrateID] > bufferSeconds) continue;
+
+            auto nextBufferSeconds = bufferSeconds - _downloadSeconds[bitrateID];
+            auto objective = Objective(bitrateID, nextBufferSeconds, _prevBitrateID);
+            nextBufferSeconds = min(nextBufferSeconds + _segmentSeconds, _maxBufferSeconds);
+            const auto futureObjective = _futureValues[bitrateID * _bufferLevelCount + BufferLevel(nextBufferSeconds)];
+            if (futureObjective == -infinity) continue;
+            objective += futureObjective;
+            if (objective > optObjective) optBitrateID = bitrateID, optObjective = objective;
+        }
+        return {optBitrateID, optObjective};
+    }
+
+    [[nodiscard]] int BufferLevel(double bufferSeconds) const {
+        return min(Math::Round(bufferSeconds / _bufferResolutionSeconds), _bufferLevelCount - 1);
+    }
+
     [[nodiscard]] double BufferCost(double bufferSeconds) const {
         const auto deviation = max(1 - bufferSeconds / _targetBufferSeconds, 0.);
         return deviation * deviation;
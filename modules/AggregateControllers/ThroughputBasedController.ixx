@@ -16,7 +16,7 @@ export {
 }
 
 /// A throughput-based controller decides aggregate bitrates using only the predicted throughputs.
-export class ThroughputBasedController : public BaseAggregateController {
+export class ThroughputBasedController final : public BaseAggregateController {
 public:
     /// Creates a throughput-based controller with the specified configuration and options.
     /// @param streamingConfig The adaptive bitrate streaming configuration.
@@ -26,6 +26,10 @@ public:
         BaseAggregateController(streamingConfig, options) {
     }
 
+    [[nodiscard]] unique_ptr<IAggregateController> Clone() const override {
+        return make_unique<ThroughputBasedController>(*this);
+    }
+
     [[nodiscard]] double GetAggregateBitrateMbps(const AggregateControllerContext &context) override {
         return context.ThroughputMbps * _throughputDiscount;
     }
@@ -20,6 +20,112 @@ struct TimedValue {
     bool operator!=(const TimedValue &) const = default;
 };
 
+export template<typename TSignature>
+class FunctionRef;
+
+/// Refers to a callable object without owning it.
+/// Unlike a function wrapper, a reference never allocates and forwards calls through a single function pointer,
+/// which is resolved at compile time when the referring code is inlined into the code that creates the reference.
+/// The callable object must outlive the reference.
+/// @tparam R The return type.
+/// @tparam Args The parameter types.
+export template<typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+    void *_callable = nullptr;
+    R (*_invoke)(void *, Args...) = nullptr;
+
+public:
+    FunctionRef() = default;
+
+    /// Creates a reference to a callable object.
+    /// @param callable A callable object that outlives the reference.
+    template<typename F> requires (!is_same_v<remove_cvref_t<F>, FunctionRef> && is_invocable_r_v<R, F &, Args...>)
+    FunctionRef(F &&callable) :
+        _callable(const_cast<void *>(static_cast<const void *>(addressof(callable)))),
+        _invoke([](void *_callable, Args... args) -> R {
+            return invoke(*static_cast<remove_reference_t<F> *>(_callable), std::forward<Args>(args)...);
+        }) {
+    }
+
+    /// Calls the referenced callable object.
+    /// @param args The arguments.
+    /// @returns The result of the call.
+    R operator()(Args... args) const {
+        return _invoke(_callable, std::forward<Args>(args)...);
+    }
+
+    /// Returns whether the reference refers to a callable object.
+    /// @returns Whether the reference refers to a callable object.
+    explicit operator bool() const {
+        return _invoke != nullptr;
+    }
+};
+
+/// Provides scratch memory for temporaries that are released all at once.
+/// Memory that does not fit in the arena is allocated separately and folded into the arena on the next reset,
+/// so that a steady workload stops allocating after its first iteration.
+export class ScratchArena {
+    vector<byte> _buffer;
+    size_t _offset = 0;
+    vector<unique_ptr<byte[]>> _overflowBlocks;
+    size_t _overflowSize = 0;
+    int64_t _allocationCount = 0;
+
+public:
+    /// Creates a scratch arena with the specified initial capacity.
+    /// @param capacity The initial capacity in bytes.
+    explicit ScratchArena(size_t capacity = 0) : _buffer(capacity) {
+    }
+
+    ScratchArena(const ScratchArena &other) : _buffer(other._buffer.size() + other._overflowSize) {
+    }
+
+    ScratchArena &operator=(const ScratchArena &other) {
+        if (this != &other) *this = ScratchArena(other);
+        return *this;
+    }
+
+    ScratchArena(ScratchArena &&) noexcept = default;
+    ScratchArena &operator=(ScratchArena &&) noexcept = default;
+
+    /// Allocates a value-initialized array that remains valid until the next reset.
+    /// @tparam T The type of the array elements.
+    /// @tparam IsCounted Whether the array is added to the allocation count.
+    /// @param count The number of array elements.
+    /// @returns The allocated array.
+    template<typename T, bool IsCounted = false> requires is_trivially_destructible_v<T>
+    [[nodiscard]] span<T> Allocate(size_t count) {
+        static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+        const auto size = count * sizeof(T);
+        const auto offset = (_offset + alignof(T) - 1) / alignof(T) * alignof(T);
+        if constexpr (IsCounted) ++_allocationCount;
+        byte *data;
+        if (offset + size <= _buffer.size()) data = _buffer.data() + offset, _offset = offset + size;
+        else {
+            data = _overflowBlocks.emplace_back(make_unique_for_overwrite<byte[]>(size)).get();
+            _overflowSize += size + alignof(T);
+        }
+        const span array(reinterpret_cast<T *>(data), count);
+        ranges::uninitialized_value_construct(array);
+        return array;
+    }
+
+    /// Returns the number of counted arrays allocated since the arena was created.
+    /// @returns The number of counted arrays allocated since the arena was created.
+    [[nodiscard]] int64_t AllocationCount() const {
+        return _allocationCount;
+    }
+
+    /// Releases all arrays allocated since the last reset.
+    void Reset() {
+        _offset = 0;
+        if (_overflowBlocks.empty()) return;
+        _overflowBlocks.clear();
+        _buffer = vector<byte>(_buffer.size() + _overflowSize);
+        _overflowSize = 0;
+    }
+};
+
 /// Represents a position on a unit sphere.
 export struct SphericalPosition {
     double PitchDegrees; ///< The pitch angle in degrees (from -90 to 90).
@@ -44,14 +150,14 @@ export struct SphericalPosition {
     }
 
     /// Returns the difference between two yaw angles after unwrapping in degrees.
+    /// The computation is branch-free so that loops over arrays of yaw angles can be vectorized.
     /// @param yaw1Degrees The first yaw angle in degrees.
     /// @param yaw2Degrees The second yaw angle in degrees.
     /// @returns The difference between the two yaw angles after unwrapping in degrees.
     [[nodiscard]] static double YawDifferenceDegrees(double yaw1Degrees, double yaw2Degrees) {
-        auto diffDegrees = yaw2Degrees - yaw1Degrees;
-        if (diffDegrees > 180.) diffDegrees -= 360;
-        else if (diffDegrees < -180.) diffDegrees += 360;
-        return diffDegrees;
+        const auto diffDegrees = yaw2Degrees - yaw1Degrees;
+        const auto unwrappedDegrees = diffDegrees > 180. ? diffDegrees - 360 : diffDegrees;
+        return diffDegrees < -180. ? diffDegrees + 360 : unwrappedDegrees;
     }
 
     /// Unwraps a list of yaw angles to the linear space.
@@ -117,3 +223,72 @@ export using ViewportSeriesView = LLU::TimeSeriesView<SphericalPosition>;
 /// Represents a constant view of a collection of viewport series.
 /// The values of each viewport series represent viewport positions.
 export using ViewportDataView = LLU::TemporalDataView<SphericalPosition>;
+
+/// Refers to a sparse viewport distribution, in which every tile has a baseline probability
+/// and listed tiles have a scaled weight in addition, so that operations scale with the number of listed tiles.
+/// Mixing with the uniform distribution only changes the baseline and scale.
+export struct SparseDistributionView {
+    int TileCount = 0; ///< The number of tiles (0 for no distribution).
+    span<const int> TileIDs; ///< A list of IDs of listed tiles in ascending order.
+    span<const double> Weights; ///< A list of weights of listed tiles.
+    double Scale = 1.; ///< The scale of weights.
+    double Baseline = 0.; ///< The baseline probability of every tile.
+
+    /// Returns whether the view refers to a distribution.
+    /// @returns Whether the view refers to a distribution.
+    explicit operator bool() const {
+        return TileCount > 0;
+    }
+
+    /// Returns the probability of a listed tile.
+    /// @param index The index of the tile in the list.
+    /// @returns The probability of the tile.
+    [[nodiscard]] double Probability(size_t index) const {
+        return Baseline + Scale * Weights[index];
+    }
+
+    /// Returns the convex combination of the distribution and the uniform distribution.
+    /// @param weight The weight of the distribution.
+    /// @returns The mixed distribution, which refers to the same listed tiles.
+    [[nodiscard]] SparseDistributionView MixUniform(double weight) const {
+        return {TileCount, TileIDs, Weights, Scale * weight, Baseline * weight + (1 - weight) / TileCount};
+    }
+
+    /// Converts the distribution to a dense distribution.
+    /// @param distribution The output dense distribution with one entry per tile.
+    void ToDense(span<double> distribution) const {
+        ranges::fill(distribution, Baseline);
+        for (size_t i = 0; i < TileIDs.size(); ++i) distribution[TileIDs[i]] = Probability(i);
+    }
+};
+
+/// Holds a sparse viewport distribution.
+export struct SparseDistribution {
+    int TileCount = 0; ///< The number of tiles (0 for no distribution).
+    vector<int> TileIDs; ///< A list of IDs of listed tiles in ascending order.
+    vector<double> Weights; ///< A list of weights of listed tiles.
+    double Scale = 1.; ///< The scale of weights.
+    double Baseline = 0.; ///< The baseline probability of every tile.
+
+    /// Copies a sparse distribution, reusing the memory of the held distribution.
+    /// @param distribution A sparse distribution.
+    void Assign(SparseDistributionView distribution) {
+        TileCount = distribution.TileCount;
+        TileIDs.assign_range(distribution.TileIDs), Weights.assign_range(distribution.Weights);
+        Scale = distribution.Scale, Baseline = distribution.Baseline;
+    }
+
+    /// Converts a dense distribution, listing the tiles with nonzero probabilities.
+    /// @param distribution A dense distribution with one entry per tile.
+    void Assign(span<const double> distribution) {
+        TileCount = static_cast<int>(distribution.size());
+        TileIDs.clear(), Weights.clear();
+        for (auto tileID = 0; tileID < TileCount; ++tileID)
+            if (distribution[tileID] != 0.) TileIDs.push_back(tileID), Weights.push_back(distribution[tileID]);
+        Scale = 1., Baseline = 0.;
+    }
+
+    operator SparseDistributionView() const {
+        return {TileCount, TileIDs, Weights, Scale, Baseline};
+    }
+};
@@ -0,0 +1,118 @@
+export module ABRSimulation360.BatchRunner;
+
+import System.Base;
+import System.MDArray;
+
+import ABRSimulation360.ABRSimulator360;
+import ABRSimulation360.AggregateControllers.IAggregateController;
+import ABRSimulation360.Base;
+import ABRSimulation360.BitrateAllocators.IBitrateAllocator;
+import ABRSimulation360.TraceFile;
+
+using namespace std;
+using namespace experimental;
+
+/// Represents the header of a batch result file.
+export struct BatchResultFileHeader {
+    array<char, 8> Magic; ///< The magic bytes "ABRBATCH".
+    uint32_t Version; ///< The version of the file format.
+    uint32_t TileCount; ///< The number of tiles.
+};
+
+/// Represents the header of a session record in a batch result file.
+/// The header is followed by the buffered bitrates in megabits per second (segment count × tile count),
+/// the viewport distributions (segment count × tile count), the predicted viewport distributions
+/// ((segment count - 1) × tile count), and the allocation time in microseconds (segment count - 1), all as doubles.
+export struct SessionRecordHeader {
+    uint32_t SessionIndex; ///< The index of the session in the batch.
+    uint32_t SegmentCount; ///< The number of segments.
+    double RebufferingSeconds; ///< The total rebuffering duration in seconds.
+};
+
+/// Writes the results of sessions to a batch result file in the order in which they complete.
+/// Records are written under a lock, so that a writer can be shared by concurrent sessions.
+export class BatchResultWriter {
+    static constexpr array<char, 8> Magic = {'A', 'B', 'R', 'B', 'A', 'T', 'C', 'H'};
+    static constexpr uint32_t Version = 1;
+
+    mutex _mutex;
+    ofstream _stream;
+    filesystem::path _path;
+    int _recordCount = 0;
+
+public:
+    /// Creates a batch result file.
+    /// @param path The path of the batch result file.
+    /// @param tileCount The number of tiles.
+    BatchResultWriter(filesystem::path path, int tileCount) : _stream(path, ios::binary), _path(move(path)) {
+        const BatchResultFileHeader header = {Magic, Version, static_cast<uint32_t>(tileCount)};
+        _stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        if (!_stream) throw runtime_error(format("Cannot write the batch result file \"{}\".", _path.string()));
+    }
+
+    /// Appends the results of a session.
+    /// @param sessionIndex The index of the session in the batch.
+    /// @param series The simulation series of the session.
+    void Write(int sessionIndex, const SimulationSeriesRef &series) {
+        const SessionRecordHeader header = {
+            static_cast<uint32_t>(sessionIndex), static_cast<uint32_t>(series.BufferedBitratesMbps.extent(0)),
+            series.RebufferingSeconds
+        };
+        const auto WriteArray = [&](auto values) {
+            _stream.write(reinterpret_cast<const char *>(values.data_handle()), values.size() * sizeof(double));
+        };
+
+        const lock_guard lock(_mutex);
+        _stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        WriteArray(series.BufferedBitratesMbps);
+        WriteArray(series.ViewportDistributions);
+        WriteArray(series.PredictedViewportDistributions);
+        _stream.write(reinterpret_cast<const char *>(series.AllocationUs.data()), series.AllocationUs.size_bytes());
+        if (!_stream) throw runtime_error(format("Cannot write the batch result file \"{}\".", _path.string()));
+        ++_recordCount;
+    }
+
+    /// Returns the number of session records that have been written.
+    /// @returns The number of session records that have been written.
+    [[nodiscard]] int RecordCount() {
+        const lock_guard lock(_mutex);
+        return _recordCount;
+    }
+
+    /// Flushes written records to the file.
+    void Flush() {
+        const lock_guard lock(_mutex);
+        _stream.flush();
+    }
+};
+
+/// Simulates batches of 360° adaptive bitrate streaming sessions from trace files without the Wolfram kernel.
+export class BatchRunner {
+public:
+    /// Simulates a 360° adaptive bitrate streaming configuration on the series of two trace files.
+    /// The network and viewport series at the same index form a session, and each session is written as it completes.
+    /// @param streamingConfig The adaptive bitrate streaming configuration.
+    /// @param controllerOptions The options for the aggregate controller.
+    /// @param allocatorOptions The options for the bitrate allocator.
+    /// @param networkTraces A collection of network series.
+    /// @param viewportTraces A collection of viewport series.
+    /// @param writer The writer of session results.
+    /// @param options The options for 360° adaptive bitrate streaming simulation.
+    static void Run(const StreamingConfig &streamingConfig,
+                    const BaseAggregateControllerOptions &controllerOptions,
+                    const BaseBitrateAllocatorOptions &allocatorOptions,
+                    const NetworkTraceFile &networkTraces,
+                    const ViewportTraceFile &viewportTraces,
+                    BatchResultWriter &writer,
+                    const ABRSimulation360Options &options = {}) {
+        if (networkTraces.PathCount() != viewportTraces.PathCount())
+            throw invalid_argument("The numbers of network and viewport series must be equal.");
+
+        ABRSimulator360::SimulateBuffered(streamingConfig, controllerOptions, allocatorOptions,
+                                          networkTraces, viewportTraces, options,
+                                          [&](int i, const SimulationSeriesRef &series) {
+                                              writer.Write(i, series);
+                                          });
+        writer.Flush();
+    }
+};
@@ -25,12 +25,23 @@ export {
 }
 
 /// A BOLA allocator decides bitrates based on buffer level thresholds.
-export class BOLAAllocator : public BaseBitrateAllocator {
+/// The objective of each bitrate is linear in the viewport probability of a tile,
+/// with an intercept that is fixed at construction and a slope that is linear in the buffer level.
+/// For a given buffer level, the upper envelope of these lines is a decision table of probability thresholds,
+/// so that each tile is decided by counting the thresholds below its probability instead of scanning all bitrates.
+export class BOLAAllocator final : public BaseBitrateAllocator {
     double _segmentSeconds;
     double _maxBufferSeconds;
     double _bufferWeight;
     double _controlFactor;
 
+    vector<double> _intercepts;
+    vector<double> _utilitySlopes;
+    vector<double> _bufferSlopes;
+    vector<double> _slopes;
+    vector<double> _thresholds;
+    vector<int> _thresholdBitrateIDs;
+
 public:
     /// Creates a BOLA allocator with the specified configuration and options.
     /// @param streamingConfig The adaptive bitrate streaming configuration.
@@ -39,20 +50,58 @@ public:
         BaseBitrateAllocator(streamingConfig, options), _segmentSeconds(streamingConfig.SegmentSeconds),
         _maxBufferSeconds(streamingConfig.MaxBufferSeconds), _bufferWeight(options.BufferWeight),
         _controlFactor((_maxBufferSeconds / _segmentSeconds - 1) / (_bufferWeight + 1)) {
+        const auto bitrateCount = _bitratesMbps.size();
+        _intercepts.resize(bitrateCount), _utilitySlopes.resize(bitrateCount), _bufferSlopes.resize(bitrateCount);
+        for (auto bitrateID = 0; bitrateID < bitrateCount; ++bitrateID) {
+            _intercepts[bitrateID] = _controlFactor * _bufferWeight / _bitratesMbps[bitrateID];
+            _utilitySlopes[bitrateID] = _controlFactor * _utilities[bitrateID] / _bitratesMbps[bitrateID];
+            _bufferSlopes[bitrateID] = 1 / (_segmentSeconds * _bitratesMbps[bitrateID]);
+        }
+        _slopes.resize(bitrateCount);
+    }
+
+    [[nodiscard]] unique_ptr<IBitrateAllocator> Clone() const override {
+        return make_unique<BOLAAllocator>(*this);
+    }
+
+    using BaseBitrateAllocator::GetBitrateIDs;
+
+    void GetBitrateIDs(const BitrateAllocatorContext &context, span<int> bitrateIDs) override {
+        const auto distribution = context.ViewportDistribution.first(_tileCount);
+        UpdateDecisionTable(context.BufferSeconds);
+
+        // Counts the thresholds below the probability of each tile without branches, one threshold at a time.
+        ranges::fill(bitrateIDs.first(_tileCount), 0);
+        for (const auto threshold : _thresholds)
+            for (auto tileID = 0; tileID < _tileCount; ++tileID)
+                bitrateIDs[tileID] += distribution[tileID] > threshold;
+        for (auto &bitrateID : bitrateIDs.first(_tileCount)) bitrateID = _thresholdBitrateIDs[bitrateID];
     }
 
-    [[nodiscard]] vector<int> GetBitrateIDs(const BitrateAllocatorContext &context) override {
+private:
+    // Walks the upper envelope of the objective lines from zero probability, where the bitrate with the highest
+    // intercept is optimal, to unit probability, recording each probability at which a steeper line takes over.
+    void UpdateDecisionTable(double bufferSeconds) {
         const auto bitrateCount = static_cast<int>(_bitratesMbps.size());
-        const auto bufferSeconds = context.BufferSeconds;
-        const auto distribution = context.ViewportDistribution;
-
-        return views::iota(0, _tileCount) | views::transform([&](int tileID) {
-            const auto probability = distribution[tileID];
-            const auto objectives = views::iota(0, bitrateCount) | views::transform([&](int bitrateID) {
-                return (_controlFactor * (probability * _utilities[bitrateID] + _bufferWeight)
-                    - probability * bufferSeconds / _segmentSeconds) / _bitratesMbps[bitrateID];
-            }) | ranges::to<vector>();
-            return static_cast<int>(ranges::max_element(objectives) - objectives.cbegin());
-        }) | ranges::to<vector>();
+        for (auto bitrateID = 0; bitrateID < bitrateCount; ++bitrateID)
+            _slopes[bitrateID] = _utilitySlopes[bitrateID] - bufferSeconds * _bufferSlopes[bitrateID];
+
+        auto bitrateID = static_cast<int>(ranges::max_element(_intercepts) - _intercepts.cbegin());
+        _thresholds.clear(), _thresholdBitrateIDs.assign(1, bitrateID);
+        while (true) {
+            auto nextBitrateID = -1;
+            auto nextThreshold = numeric_limits<double>::infinity();
+            for (auto candidateID = 0; candidateID < bitrateCount; ++candidateID) {
+                if (_slopes[candidateID] <= _slopes[bitrateID]) continue;
+                const auto threshold = (_intercepts[bitrateID] - _intercepts[candidateID])
+                    / (_slopes[candidateID] - _slopes[bitrateID]);
+                if (threshold < nextThreshold
+                    || (threshold == nextThreshold && _slopes[candidateID] > _slopes[nextBitrateID]))
+                    nextBitrateID = candidateID, nextThreshold = threshold;
+            }
+            if (nextBitrateID < 0 || nextThreshold > 1.) break;
+            _thresholds.push_back(nextThreshold), _thresholdBitrateIDs.push_back(nextBitrateID);
+            bitrateID = nextBitrateID;
+        }
     }
 };
@@ -21,6 +21,20 @@ using namespace std;
     if (const auto *const _options = dynamic_cast<const CONCAT(T, Options) *>(&options)) \
         return make_unique<T>(streamingConfig, *_options);
 
+#define TRY_CREATE_VARIANT(T) \
+    if (const auto *const _options = dynamic_cast<const CONCAT(T, Options) *>(&options)) \
+        return BitrateAllocatorVariant(in_place_type<T>, streamingConfig, *_options);
+
+/// Represents a built-in bitrate allocator held by value, so that calls on it can be resolved at compile time.
+export using BitrateAllocatorVariant = variant<
+    BOLAAllocator,
+    DragonflyAllocator,
+    FlareAllocator,
+    HybridAllocator,
+    OnlineLearningAllocator,
+    ProbDASHAllocator
+>;
+
 /// Represents a factory for bitrate allocators.
 export class BitrateAllocatorFactory {
 public:
@@ -40,4 +54,21 @@ public:
                  ))
         throw runtime_error("Unknown bitrate allocator options.");
     }
+
+    /// Creates a bitrate allocator of a built-in type with the specified configuration and options.
+    /// @param streamingConfig The adaptive bitrate streaming configuration.
+    /// @param options The options for the bitrate allocator.
+    /// @returns A bitrate allocator with the specified configuration and options.
+    [[nodiscard]] static BitrateAllocatorVariant CreateVariant(const StreamingConfig &streamingConfig,
+                                                               const BaseBitrateAllocatorOptions &options) {
+        FOR_EACH(TRY_CREATE_VARIANT, (
+                     BOLAAllocator,
+                     DragonflyAllocator,
+                     FlareAllocator,
+                     HybridAllocator,
+                     OnlineLearningAllocator,
+                     ProbDASHAllocator
+                 ))
+        throw runtime_error("Unknown bitrate allocator options.");
+    }
 };
@@ -23,7 +23,7 @@ export {
 }
 
 /// A Dragonfly allocator decides bitrates by optimizing against two concentric viewports.
-export class DragonflyAllocator : public BaseBitrateAllocator {
+export class DragonflyAllocator final : public BaseBitrateAllocator {
     double _dilation;
 
 public:
@@ -34,13 +34,20 @@ public:
         BaseBitrateAllocator(streamingConfig, options), _dilation(options.Dilation) {
     }
 
-    [[nodiscard]] vector<int> GetBitrateIDs(const BitrateAllocatorContext &context) override {
+    [[nodiscard]] unique_ptr<IBitrateAllocator> Clone() const override {
+        return make_unique<DragonflyAllocator>(*this);
+    }
+
+    using BaseBitrateAllocator::GetBitrateIDs;
+
+    void GetBitrateIDs(const BitrateAllocatorContext &context, span<int> bitrateIDs) override {
+        _scratchArena.Reset();
         const auto aggregateBitrateMbps = context.AggregateBitrateMbps;
         const auto distribution = context.ViewportDistribution;
         const auto dilatedDistribution = context.DilatedViewportDistribution(_dilation);
-        const auto mixedDistribution = views::iota(0, _tileCount) | views::transform([&](int tileID) {
-            return (distribution[tileID] + dilatedDistribution[tileID]) / 2;
-        }) | ranges::to<vector>();
-        return FromViewportDistribution(aggregateBitrateMbps, mixedDistribution);
+        const auto mixedDistribution = _scratchArena.Allocate<double>(_tileCount);
+        for (auto tileID = 0; tileID < _tileCount; ++tileID)
+            mixedDistribution[tileID] = (distribution[tileID] + dilatedDistribution[tileID]) / 2;
+        FromViewportDistribution(aggregateBitrateMbps, mixedDistribution, bitrateIDs);
     }
 };
@@ -27,7 +27,7 @@ export {
 }
 
 /// A Flare allocator fetches a variable number of out-of-sight tiles based on prediction accuracy.
-export class FlareAllocator : public BaseBitrateAllocator {
+export class FlareAllocator final : public BaseBitrateAllocator {
     double _switchingCostWeight;
     double _accuracySmoothingWeight;
 
@@ -44,26 +44,37 @@ public:
         _accuracySmoothingWeight(options.AccuracySmoothingWeight), _accuracy(options.InitialAccuracy) {
     }
 
-    [[nodiscard]] vector<int> GetBitrateIDs(const BitrateAllocatorContext &context) override {
+    [[nodiscard]] unique_ptr<IBitrateAllocator> Clone() const override {
+        return make_unique<FlareAllocator>(*this);
+    }
+
+    using BaseBitrateAllocator::GetBitrateIDs;
+
+    void GetBitrateIDs(const BitrateAllocatorContext &context, span<int> bitrateIDs) override {
         const auto aggregateBitrateMbps = context.AggregateBitrateMbps;
         const auto predictedDistribution = context.ViewportDistribution;
         const auto prevDistribution = context.PrevViewportDistribution;
 
         if (!_prevPredictedDistribution.empty()) {
-            const auto minProbabilities = views::iota(0, _tileCount) | views::transform([&](int tileID) {
-                return min(_prevPredictedDistribution[tileID], prevDistribution[tileID]);
-            }) | ranges::to<vector>();
-            const auto maxProbabilities = views::iota(0, _tileCount) | views::transform([&](int tileID) {
-                return max(_prevPredictedDistribution[tileID], prevDistribution[tileID]);
-            }) | ranges::to<vector>();
-            const auto accuracy = Math::Total(minProbabilities) / Math::Total(maxProbabilities);
+            auto totalMinProbability = 0., totalMaxProbability = 0.;
+            for (auto tileID = 0; tileID < _tileCount; ++tileID) {
+                totalMinProbability += min(_prevPredictedDistribution[tileID], prevDistribution[tileID]);
+                totalMaxProbability += max(_prevPredictedDistribution[tileID], prevDistribution[tileID]);
+            }
+            const auto accuracy = totalMinProbability / totalMaxProbability;
             _accuracy = (1 - _accuracySmoothingWeight) * _accuracy + _accuracySmoothingWeight * accuracy;
         }
 
+        // Finds the probabilities of the two classes and the size of the most probable class in a single pass.
         const auto mixedDistribution = context.DilatedViewportDistribution(1 - _accuracy);
-        const auto [class1Probability, class0Probability] = ranges::minmax(mixedDistribution);
-        const auto class0Count = static_cast<int>(ranges::count(mixedDistribution, class0Probability)),
-                   class1Count = _tileCount - class0Count;
+        auto class0Probability = mixedDistribution.front(), class1Probability = mixedDistribution.front();
+        auto class0Count = 0;
+        for (const auto probability : mixedDistribution) {
+            if (probability > class0Probability) class0Probability = probability, class0Count = 0;
+            if (probability == class0Probability) ++class0Count;
+            class1Probability = min(class1Probability, probability);
+        }
+        const auto class1Count = _tileCount - class0Count;
         const auto totalClass0Probability = class0Probability * class0Count,
                    totalClass1Probability = class1Probability * class1Count;
 
@@ -73,7 +84,10 @@ public:
             const auto totalClass0BitrateMbps = _bitratesMbps[bitrateID0] * class0Count;
             if (totalClass0BitrateMbps > aggregateBitrateMbps) break;
 
+            // The objective is concave in the utility of the less probable class, since the utility is linear
+            // and both switching costs are convex, so the search stops as soon as the objective decreases.
             const auto class0Utility = totalClass0Probability * _utilities[bitrateID0];
+            auto prevObjective = -numeric_limits<double>::infinity();
             for (auto bitrateID1 = 0; bitrateID1 <= bitrateID0; ++bitrateID1) {
                 if (totalClass0BitrateMbps + _bitratesMbps[bitrateID1] * class1Count > aggregateBitrateMbps) break;
 
@@ -87,14 +101,17 @@ public:
                     optBitrateID0 = bitrateID0, optBitrateID1 = bitrateID1;
                     optUtility360 = utility360, optObjective = objective;
                 }
+                if (objective < prevObjective) break;
+                prevObjective = objective;
             }
         }
 
-        _prevPredictedDistribution = vector(from_range, predictedDistribution);
+        _prevPredictedDistribution.assign_range(predictedDistribution);
         _prevUtility360 = optUtility360;
-        if (!optBitrateID0) return vector(_tileCount, 0);
-        return views::iota(0, _tileCount) | views::transform([&](int tileID) {
-            return mixedDistribution[tileID] == class0Probability ? *optBitrateID0 : *optBitrateID1;
-        }) | ranges::to<vector>();
+        if (!optBitrateID0) ranges::fill(bitrateIDs, 0);
+        else
+            ranges::transform(mixedDistribution, bitrateIDs.begin(), [&](double probability) {
+                return probability == class0Probability ? *optBitrateID0 : *optBitrateID1;
+            });
     }
 };
@@ -23,7 +23,7 @@ export {
 }
 
 /// A hybrid allocator decides bitrates by optimizing against a convex combination of the uniform viewport distribution and the predicted viewport distribution.
-export class HybridAllocator : public BaseBitrateAllocator {
+export class HybridAllocator final : public BaseBitrateAllocator {
     double _trustLevel;
 
 public:
@@ -34,12 +34,23 @@ public:
         BaseBitrateAllocator(streamingConfig, options), _trustLevel(options.TrustLevel) {
     }
 
-    [[nodiscard]] vector<int> GetBitrateIDs(const BitrateAllocatorContext &context) override {
+    [[nodiscard]] unique_ptr<IBitrateAllocator> Clone() const override {
+        return make_unique<HybridAllocator>(*this);
+    }
+
+    using BaseBitrateAllocator::GetBitrateIDs;
+
+    void GetBitrateIDs(const BitrateAllocatorContext &context, span<int> bitrateIDs) override {
+        _scratchArena.Reset();
         const auto aggregateBitrateMbps = context.AggregateBitrateMbps;
+        if (const auto sparseDistribution = context.SparseViewportDistribution)
+            return FromViewportDistribution(aggregateBitrateMbps, sparseDistribution.MixUniform(_trustLevel),
+                                            bitrateIDs);
+
         const auto distribution = context.ViewportDistribution;
-        const auto mixedDistribution = views::iota(0, _tileCount) | views::transform([&](int tileID) {
-            return distribution[tileID] * _trustLevel + (1 - _trustLevel) / _tileCount;
-        }) | ranges::to<vector>();
-        return FromViewportDistribution(aggregateBitrateMbps, mixedDistribution);
+        const auto mixedDistribution = _scratchArena.Allocate<double>(_tileCount);
+        for (auto tileID = 0; tileID < _tileCount; ++tileID)
+            mixedDistribution[tileID] = distribution[tileID] * _trustLevel + (1 - _trustLevel) / _tileCount;
+        FromViewportDistribution(aggregateBitrateMbps, mixedDistribution, bitrateIDs);
     }
 };
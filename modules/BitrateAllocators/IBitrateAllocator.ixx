@@ -29,8 +29,12 @@ export struct BitrateAllocatorContext {
 
     /// Returns the dilated viewport distribution.
     /// @param dilation The dilation factor.
-    /// @returns The dilated viewport distribution.
-    function<vector<double>(double)> DilatedViewportDistribution;
+    /// @returns The dilated viewport distribution, which remains valid until the bitrate allocator returns.
+    FunctionRef<span<const double>(double)> DilatedViewportDistribution;
+
+    /// The predicted viewport distribution in sparse form, which is identical to the dense form if present
+    /// (empty for no sparse form). Allocators that support it run in time proportional to the number of listed tiles.
+    SparseDistributionView SparseViewportDistribution = {};
 };
 
 /// Defines the interface of a bitrate allocator.
@@ -38,10 +42,22 @@ export class IBitrateAllocator {
 public:
     virtual ~IBitrateAllocator() = default;
 
+    /// Creates a copy of the bitrate allocator including its state.
+    /// @returns A copy of the bitrate allocator.
+    [[nodiscard]] virtual unique_ptr<IBitrateAllocator> Clone() const = 0;
+
     /// Gets the bitrate decisions for all tiles given the specified context.
     /// @param context The context for the bitrate allocator.
     /// @returns The bitrate decisions for all tiles given the specified context.
     [[nodiscard]] virtual vector<int> GetBitrateIDs(const BitrateAllocatorContext &context) = 0;
+
+    /// Gets the bitrate decisions for all tiles given the specified context into a buffer.
+    /// The default implementation adapts the allocating overload.
+    /// @param context The context for the bitrate allocator.
+    /// @param bitrateIDs A buffer for the bitrate decisions with one element per tile.
+    virtual void GetBitrateIDs(const BitrateAllocatorContext &context, span<int> bitrateIDs) {
+        ranges::copy(GetBitrateIDs(context), bitrateIDs.begin());
+    }
 };
 
 /// Provides a skeletal implementation of a bitrate allocator.
@@ -50,6 +66,7 @@ protected:
     int _tileCount;
     vector<double> _bitratesMbps;
     vector<double> _utilities;
+    ScratchArena _scratchArena;
 
     explicit BaseBitrateAllocator(const StreamingConfig &streamingConfig, const BaseBitrateAllocatorOptions & = {}) {
         const auto tileCountPerFace = streamingConfig.TilingCount * streamingConfig.TilingCount;
@@ -63,16 +80,33 @@ protected:
         }) | ranges::to<vector>();
     }
 
+public:
+    [[nodiscard]] vector<int> GetBitrateIDs(const BitrateAllocatorContext &context) override {
+        vector<int> bitrateIDs(_tileCount);
+        GetBitrateIDs(context, bitrateIDs);
+        return bitrateIDs;
+    }
+
+    void GetBitrateIDs(const BitrateAllocatorContext &context, span<int> bitrateIDs) override = 0;
+
+protected:
     [[nodiscard]] int BitrateIDBelow(double bitrateMbps) const {
         const auto it = ranges::upper_bound(_bitratesMbps, bitrateMbps);
         return it != _bitratesMbps.cbegin() ? static_cast<int>(it - _bitratesMbps.cbegin()) - 1 : 0;
     }
 
-    [[nodiscard]] vector<int> FromViewportDistribution(double aggregateBitrateMbps,
-                                                       span<const double> distribution) const {
-        const auto bitratesMbps = distribution * aggregateBitrateMbps;
-        return bitratesMbps | views::transform([&](double bitrateMbps) {
-            return BitrateIDBelow(bitrateMbps);
-        }) | ranges::to<vector>();
+    void FromViewportDistribution(double aggregateBitrateMbps, span<const double> distribution,
+                                  span<int> bitrateIDs) const {
+        ranges::transform(distribution, bitrateIDs.begin(), [&](double probability) {
+            return BitrateIDBelow(probability * aggregateBitrateMbps);
+        });
+    }
+
+    // Decides the bitrate of unlisted tiles once, and then the bitrates of listed tiles.
+    void FromViewportDistribution(double aggregateBitrateMbps, SparseDistributionView distribution,
+                                  span<int> bitrateIDs) const {
+        ranges::fill(bitrateIDs, BitrateIDBelow(distribution.Baseline * aggregateBitrateMbps));
+        for (size_t i = 0; i < distribution.TileIDs.size(); ++i)
+            bitrateIDs[distribution.TileIDs[i]] = BitrateIDBelow(distribution.Probability(i) * aggregateBitrateMbps);
     }
 };
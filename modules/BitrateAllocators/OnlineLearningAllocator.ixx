@@ -9,6 +9,7 @@ import System.Math;
 
 import ABRSimulation360.Base;
 import ABRSimulation360.BitrateAllocators.IBitrateAllocator;
+import ABRSimulation360.Tracing;
 
 using namespace std;
 
@@ -19,7 +20,6 @@ export struct OnlineLearningAllocatorOptions : BaseBitrateAllocatorOptions {
     double InitialTrustLevel = 0.5; ///< The initial trust level in viewport predictions.
     double LearningRate = 0.2; ///< The learning rate for the trust level.
     pair<double, double> TrustLevelRange = {0., 0.85}; ///< The clipping range of the trust level.
-    filesystem::path LogPath; ///< The path to log trust levels.
 };
 
 export {
@@ -28,22 +28,23 @@ export {
                         SwitchingCostWeight,
                         InitialTrustLevel,
                         LearningRate,
-                        TrustLevelRange,
-                        LogPath
+                        TrustLevelRange
                     ))
 }
 
+// The trust level of each segment.
+const TraceChannel TrustLevelChannel("OnlineLearningAllocator.TrustLevel");
+
 /// An online learning allocator dynamically adapts the trust level in viewport predictions when deciding bitrates.
-export class OnlineLearningAllocator : public BaseBitrateAllocator {
+/// The trust level of each segment is traced on the channel "OnlineLearningAllocator.TrustLevel".
+export class OnlineLearningAllocator final : public BaseBitrateAllocator {
     double _viewportRatio;
     double _switchingCostWeight;
     double _learningRate;
     double _minTrustLevel, _maxTrustLevel;
-    ofstream _logStream;
 
     double _trustLevel;
-    vector<double> _prevPredictedDistribution;
-    vector<double> _prevMixedDistribution;
+    SparseDistribution _prevPredictedDistribution;
 
 public:
     /// Creates an online learning allocator with the specified configuration and options.
@@ -55,29 +56,47 @@ public:
         _switchingCostWeight(options.SwitchingCostWeight), _learningRate(options.LearningRate),
         _minTrustLevel(options.TrustLevelRange.first), _maxTrustLevel(options.TrustLevelRange.second),
         _trustLevel(options.InitialTrustLevel) {
-        if (!options.LogPath.empty()) _logStream.open(options.LogPath);
     }
 
-    [[nodiscard]] vector<int> GetBitrateIDs(const BitrateAllocatorContext &context) override {
+    [[nodiscard]] unique_ptr<IBitrateAllocator> Clone() const override {
+        return make_unique<OnlineLearningAllocator>(*this);
+    }
+
+    using BaseBitrateAllocator::GetBitrateIDs;
+
+    void GetBitrateIDs(const BitrateAllocatorContext &context, span<int> bitrateIDs) override {
         const auto aggregateBitrateMbps = context.AggregateBitrateMbps;
-        const auto predictedDistribution = context.ViewportDistribution;
         const auto prevDistribution = context.PrevViewportDistribution;
 
-        if (!_prevPredictedDistribution.empty()) {
-            const auto dPrevMixedDistribution = _prevPredictedDistribution - 1. / _tileCount;
-            const auto dByPrevMixedDistribution = prevDistribution / _prevMixedDistribution;
-            const auto utilityDerivative = Math::Dot(dByPrevMixedDistribution, dPrevMixedDistribution);
+        if (const SparseDistributionView prevPredictedDistribution = _prevPredictedDistribution) {
+            // Unlisted tiles share the same predicted probability, so their terms are summed at once
+            // from the total probability of listed tiles in the actual viewport distribution.
+            const auto MixedProbability = [&](double probability) {
+                return probability * _trustLevel + (1 - _trustLevel) / _tileCount;
+            };
+            auto utilityDerivative = 0., listedProbability = 0.;
+            for (size_t i = 0; i < prevPredictedDistribution.TileIDs.size(); ++i) {
+                const auto probability = prevDistribution[prevPredictedDistribution.TileIDs[i]];
+                const auto predictedProbability = prevPredictedDistribution.Probability(i);
+                utilityDerivative += probability / MixedProbability(predictedProbability)
+                    * (predictedProbability - 1. / _tileCount);
+                listedProbability += probability;
+            }
+            if (const auto unlistedProbability = 1 - listedProbability; unlistedProbability > 0.) {
+                const auto predictedProbability = prevPredictedDistribution.Baseline;
+                utilityDerivative += unlistedProbability / MixedProbability(predictedProbability)
+                    * (predictedProbability - 1. / _tileCount);
+            }
             const auto switchingCostDerivative =
                 1 / ((1 - _trustLevel) * (_viewportRatio * (1 - _trustLevel) + _trustLevel));
             const auto derivative = utilityDerivative - _switchingCostWeight * switchingCostDerivative;
             _trustLevel = clamp(_trustLevel + _learningRate * derivative, _minTrustLevel, _maxTrustLevel);
         }
-        if (_logStream.is_open()) println(_logStream, "{}", _trustLevel);
+        Tracer::Emit(TrustLevelChannel, _trustLevel);
 
-        const auto mixedDistribution = views::iota(0, _tileCount) | views::transform([&](int tileID) {
-            return predictedDistribution[tileID] * _trustLevel + (1 - _trustLevel) / _tileCount;
-        }) | ranges::to<vector>();
-        _prevPredictedDistribution = vector(from_range, predictedDistribution);
-        return FromViewportDistribution(aggregateBitrateMbps, _prevMixedDistribution = mixedDistribution);
+        if (context.SparseViewportDistribution) _prevPredictedDistribution.Assign(context.SparseViewportDistribution);
+        else _prevPredictedDistribution.Assign(context.ViewportDistribution);
+        const auto mixedDistribution = SparseDistributionView(_prevPredictedDistribution).MixUniform(_trustLevel);
+        FromViewportDistribution(aggregateBitrateMbps, mixedDistribution, bitrateIDs);
     }
 };
@@ -23,7 +23,7 @@ export {
 }
 
 /// A ProbDASH allocator decides bitrates by optimizing against a Gaussian mixture of viewport distributions.
-export class ProbDASHAllocator : public BaseBitrateAllocator {
+export class ProbDASHAllocator final : public BaseBitrateAllocator {
     double _dilationStandardDeviation;
 
 public:
@@ -34,16 +34,23 @@ public:
         BaseBitrateAllocator(streamingConfig, options), _dilationStandardDeviation(options.DilationStandardDeviation) {
     }
 
-    [[nodiscard]] vector<int> GetBitrateIDs(const BitrateAllocatorContext &context) override {
+    [[nodiscard]] unique_ptr<IBitrateAllocator> Clone() const override {
+        return make_unique<ProbDASHAllocator>(*this);
+    }
+
+    using BaseBitrateAllocator::GetBitrateIDs;
+
+    void GetBitrateIDs(const BitrateAllocatorContext &context, span<int> bitrateIDs) override {
+        _scratchArena.Reset();
         const auto aggregateBitrateMbps = context.AggregateBitrateMbps;
         const auto distribution = context.ViewportDistribution;
         const auto dilatedDistribution1 = context.DilatedViewportDistribution(_dilationStandardDeviation);
         const auto dilatedDistribution2 = context.DilatedViewportDistribution(2 * _dilationStandardDeviation);
-        const auto gaussianDistribution = views::iota(0, _tileCount) | views::transform([&](int tileID) {
-            return 0.57 * distribution[tileID]
+        const auto gaussianDistribution = _scratchArena.Allocate<double>(_tileCount);
+        for (auto tileID = 0; tileID < _tileCount; ++tileID)
+            gaussianDistribution[tileID] = 0.57 * distribution[tileID]
                 + 0.35 * dilatedDistribution1[tileID]
                 + 0.08 * dilatedDistribution2[tileID];
-        }) | ranges::to<vector>();
-        return FromViewportDistribution(aggregateBitrateMbps, gaussianDistribution);
+        FromViewportDistribution(aggregateBitrateMbps, gaussianDistribution, bitrateIDs);
     }
 };
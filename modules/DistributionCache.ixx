@@ -0,0 +1,150 @@
+module;
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+export module ABRSimulation360.DistributionCache;
+
+import System.Base;
+import System.MDArray;
+
+import ABRSimulation360.Base;
+import ABRSimulation360.MappedFile;
+import ABRSimulation360.ViewportSimulator;
+
+using namespace std;
+using namespace experimental;
+
+/// Represents the usage statistics of a distribution cache.
+export struct DistributionCacheStatistics {
+    int64_t LookupCount; ///< The number of lookups.
+    int64_t HitCount; ///< The number of lookups served from the cache.
+    int64_t MappedBytes; ///< The total number of bytes mapped from the cache.
+};
+
+/// A persistent cache of viewport distributions keyed by the content of viewport series.
+/// Each entry is stored in its own file with a fixed header followed by a row-major array of distributions,
+/// so that entries can be memory-mapped as is. The cache is safe to share across threads and processes.
+export class DistributionCache {
+    struct Header {
+        array<char, 8> Magic;
+        uint32_t Version;
+        uint32_t SegmentCount;
+        uint32_t TileCount;
+        uint32_t Reserved;
+        uint64_t Key;
+    };
+
+    static constexpr array<char, 8> Magic = {'A', 'B', 'R', 'D', 'I', 'S', 'T', '\0'};
+    static constexpr uint32_t Version = 1;
+
+    filesystem::path _directory;
+    atomic<int64_t> _lookupCount = 0, _hitCount = 0, _mappedBytes = 0;
+
+public:
+    /// Creates a distribution cache in the specified directory.
+    /// @param directory The directory of the cache, which is created if it does not exist.
+    explicit DistributionCache(filesystem::path directory) : _directory(move(directory)) {
+        filesystem::create_directories(_directory);
+    }
+
+    /// Computes the cache key of the viewport distributions of a viewport series.
+    /// @param viewportSeries A viewport series.
+    /// @param streamingConfig The adaptive bitrate streaming configuration.
+    /// @param simulatorOptions The options for the viewport simulator.
+    /// @returns The cache key of the viewport distributions.
+    [[nodiscard]] static uint64_t Key(ViewportSeriesView viewportSeries, const StreamingConfig &streamingConfig,
+                                      const ViewportSimulatorOptions &simulatorOptions) {
+        // 64-bit FNV-1a over the viewport series and every field that affects the distributions.
+        auto hash = 0xcbf29ce484222325ull;
+        const auto Hash = [&](span<const byte> bytes) {
+            for (const auto value : bytes) hash = (hash ^ to_integer<uint64_t>(value)) * 0x100000001b3ull;
+        };
+        const auto HashValue = [&](const auto &value) { Hash(as_bytes(span(&value, 1))); };
+        HashValue(Version);
+        HashValue(viewportSeries.IntervalSeconds);
+        Hash(as_bytes(viewportSeries.Values));
+        HashValue(streamingConfig.SegmentSeconds);
+        HashValue(streamingConfig.TilingCount);
+        HashValue(streamingConfig.ViewportConfig.FoVDegrees);
+        HashValue(streamingConfig.ViewportConfig.AspectRatio);
+        HashValue(simulatorOptions.GridDegrees);
+        HashValue(simulatorOptions.Interpolates);
+        return hash;
+    }
+
+    /// Loads cached viewport distributions.
+    /// @param key The cache key of the viewport distributions.
+    /// @param distributions The output array of viewport distributions.
+    /// @returns Whether the viewport distributions were found in the cache.
+    bool TryLoad(uint64_t key, mdspan<double, dims<2>> distributions) {
+        ++_lookupCount;
+        const auto file = MappedFile::Open(EntryPath(key));
+        if (!file) return false;
+
+        const auto bytes = file->Bytes();
+        const auto count = distributions.extent(0) * distributions.extent(1);
+        if (bytes.size() != sizeof(Header) + count * sizeof(double)) return false;
+        Header header;
+        memcpy(&header, bytes.data(), sizeof(Header));
+        if (header.Magic != Magic || header.Version != Version || header.Key != key
+            || header.SegmentCount != distributions.extent(0) || header.TileCount != distributions.extent(1))
+            return false;
+
+        memcpy(distributions.data_handle(), bytes.data() + sizeof(Header), count * sizeof(double));
+        ++_hitCount, _mappedBytes += static_cast<int64_t>(bytes.size());
+        return true;
+    }
+
+    /// Stores viewport distributions in the cache.
+    /// @param key The cache key of the viewport distributions.
+    /// @param distributions An array of viewport distributions.
+    void Store(uint64_t key, mdspan<const double, dims<2>> distributions) const {
+        const Header header = {
+            Magic, Version, static_cast<uint32_t>(distributions.extent(0)),
+            static_cast<uint32_t>(distributions.extent(1)), 0, key
+        };
+        const auto count = distributions.extent(0) * distributions.extent(1);
+
+        // Writes to a private file first so that concurrent readers never observe a partial entry.
+        const auto path = EntryPath(key);
+        auto tempPath = path;
+        tempPath += format(".{}.{}.tmp", ProcessID(), _tempCount++);
+        {
+            ofstream stream(tempPath, ios::binary);
+            stream.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+            stream.write(reinterpret_cast<const char *>(distributions.data_handle()), count * sizeof(double));
+            if (!stream) return;
+        }
+        error_code error;
+        filesystem::rename(tempPath, path, error);
+        if (error) filesystem::remove(tempPath, error);
+    }
+
+    /// Returns the usage statistics of the cache.
+    /// @returns The usage statistics of the cache.
+    [[nodiscard]] DistributionCacheStatistics Statistics() const {
+        return {_lookupCount, _hitCount, _mappedBytes};
+    }
+
+private:
+    // Temporary files are named by the process and a process-wide counter, so that no two writers share one.
+    inline static atomic<uint64_t> _tempCount = 0;
+
+    [[nodiscard]] static uint64_t ProcessID() {
+#ifdef _WIN32
+        return GetCurrentProcessId();
+#else
+        return static_cast<uint64_t>(getpid());
+#endif
+    }
+
+    [[nodiscard]] filesystem::path EntryPath(uint64_t key) const {
+        return _directory / format("{:016x}.bin", key);
+    }
+};
@@ -0,0 +1,167 @@
+export module ABRSimulation360.Instrumentation;
+
+import System.Base;
+import System.MDArray;
+
+using namespace std;
+using namespace experimental;
+
+/// Represents a stage in the simulation of a segment.
+export enum class SimulationStage {
+    ViewportPrediction, ///< Updating the viewport predictor and predicting viewport positions.
+    ViewportDistribution, ///< Converting predicted viewport positions to a viewport distribution.
+    AggregateControl, ///< Choosing the aggregate bitrate.
+    BitrateAllocation, ///< Allocating bitrates to tiles, including dilated viewport distributions.
+    DilatedDistribution, ///< Computing dilated viewport distributions requested by the bitrate allocator.
+    NetworkSimulation ///< Simulating downloads and idle periods.
+};
+
+/// Represents a counter of work in the simulation of a segment.
+export enum class SimulationCounter {
+    FrustumTests, ///< The number of viewport positions tested against a viewport frustum.
+    NetworkIntervals, ///< The number of network intervals walked by downloads.
+    DilatedDistributions, ///< The number of dilated viewport distributions requested by the bitrate allocator.
+    ScratchAllocations ///< The number of arrays allocated from scratch memory.
+};
+
+/// The names of simulation stages in declaration order.
+export constexpr array SimulationStageNames = {
+    "ViewportPrediction"sv, "ViewportDistribution"sv, "AggregateControl"sv,
+    "BitrateAllocation"sv, "DilatedDistribution"sv, "NetworkSimulation"sv
+};
+
+/// The names of simulation counters in declaration order.
+export constexpr array SimulationCounterNames = {
+    "FrustumTests"sv, "NetworkIntervals"sv, "DilatedDistributions"sv, "ScratchAllocations"sv
+};
+
+/// The number of simulation stages.
+export constexpr auto SimulationStageCount = static_cast<int>(SimulationStageNames.size());
+
+/// The number of simulation counters.
+export constexpr auto SimulationCounterCount = static_cast<int>(SimulationCounterNames.size());
+
+/// Represents the cumulative values of simulation counters.
+export using SimulationCounts = array<int64_t, SimulationCounterCount>;
+
+/// The clock of instrumentation, which is monotonic and cheap to read.
+export using InstrumentationClock = chrono::steady_clock;
+
+/// Records the stage durations and counters of a segment.
+/// A disabled probe records nothing and compiles to direct calls.
+/// @tparam IsEnabled Whether the probe records anything.
+export template<bool IsEnabled>
+class SegmentProbe {
+    // Adds the lifetime of a stage to its duration.
+    class StageTimer {
+        double &_stageUs;
+        InstrumentationClock::time_point _beginTime = InstrumentationClock::now();
+
+    public:
+        explicit StageTimer(double &stageUs) : _stageUs(stageUs) {
+        }
+
+        ~StageTimer() {
+            _stageUs += chrono::duration<double, micro>(InstrumentationClock::now() - _beginTime).count();
+        }
+    };
+
+    span<double> _stageUs;
+    span<int64_t> _counters;
+
+public:
+    /// Creates a disabled probe.
+    SegmentProbe() = default;
+
+    /// Creates a probe that records into the specified rows.
+    /// @param stageUs The stage durations of the segment in microseconds, one entry per stage.
+    /// @param counters The counters of the segment, one entry per counter.
+    SegmentProbe(span<double> stageUs, span<int64_t> counters) : _stageUs(stageUs), _counters(counters) {
+        ranges::fill(_stageUs, 0.);
+    }
+
+    /// Calls a function and adds its duration to a stage.
+    /// @param stage The simulation stage.
+    /// @param function The function to measure.
+    /// @returns The return value of the function.
+    template<typename F>
+    decltype(auto) Measure(SimulationStage stage, F &&function) {
+        if constexpr (IsEnabled) {
+            const StageTimer timer(_stageUs[to_underlying(stage)]);
+            return function();
+        } else return function();
+    }
+
+    /// Adds a duration that has been measured elsewhere to a stage.
+    /// @param stage The simulation stage.
+    /// @param us The duration in microseconds.
+    void Add(SimulationStage stage, double us) {
+        if constexpr (IsEnabled) _stageUs[to_underlying(stage)] += us;
+    }
+
+    /// Records the work done between two snapshots of cumulative counts.
+    /// @param beginCounts The cumulative counts at the beginning of the segment.
+    /// @param endCounts The cumulative counts at the end of the segment.
+    void Count(const SimulationCounts &beginCounts, const SimulationCounts &endCounts) {
+        if constexpr (IsEnabled)
+            for (auto i = 0; i < SimulationCounterCount; ++i) _counters[i] = endCounts[i] - beginCounts[i];
+    }
+};
+
+/// Accumulates histograms of stage durations per thread.
+/// Durations fall into logarithmic buckets, where bucket 0 counts durations under 1 μs
+/// and bucket b counts durations in [2^(b - 1), 2^b) μs.
+export class StageHistograms {
+public:
+    /// The number of buckets in a histogram, the last of which also counts all longer durations.
+    static constexpr auto BucketCount = 32;
+
+private:
+    using Histogram = array<array<int64_t, SimulationStageCount>, BucketCount>;
+
+    mutable mutex _mutex;
+    map<thread::id, Histogram> _histograms;
+
+public:
+    /// Adds stage durations to the histograms of the calling thread.
+    /// @param stageUs A 2D array of stage durations in microseconds, one row per segment.
+    void Add(mdspan<const double, dims<2>> stageUs) {
+        Histogram histogram{};
+        for (auto i = 0; i < stageUs.extent(0); ++i)
+            for (auto stageID = 0; stageID < SimulationStageCount; ++stageID)
+                ++histogram[Bucket(stageUs[i, stageID])][stageID];
+
+        const lock_guard lock(_mutex);
+        auto &threadHistogram = _histograms[this_thread::get_id()];
+        for (auto bucketID = 0; bucketID < BucketCount; ++bucketID)
+            for (auto stageID = 0; stageID < SimulationStageCount; ++stageID)
+                threadHistogram[bucketID][stageID] += histogram[bucketID][stageID];
+    }
+
+    /// Returns the number of threads that have added stage durations.
+    /// @returns The number of threads that have added stage durations.
+    [[nodiscard]] int ThreadCount() const {
+        const lock_guard lock(_mutex);
+        return static_cast<int>(_histograms.size());
+    }
+
+    /// Copies the histograms of all threads.
+    /// @param out A 3D array of counts indexed by thread, bucket, and stage.
+    void CopyTo(mdspan<int64_t, dims<3>> out) const {
+        const lock_guard lock(_mutex);
+        auto threadIndex = 0;
+        for (const auto &histogram : _histograms | views::values) {
+            for (auto bucketID = 0; bucketID < BucketCount; ++bucketID)
+                ranges::copy(histogram[bucketID], &out[threadIndex, bucketID, 0]);
+            ++threadIndex;
+        }
+    }
+
+    /// Returns the bucket of a duration.
+    /// @param us A duration in microseconds.
+    /// @returns The ID of the bucket that counts the duration.
+    [[nodiscard]] static int Bucket(double us) {
+        if (!(us >= 1.)) return 0;
+        return min(static_cast<int>(bit_width(static_cast<uint64_t>(min(us, 0x1p62)))), BucketCount - 1);
+    }
+};
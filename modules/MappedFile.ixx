@@ -0,0 +1,90 @@
+module;
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+export module ABRSimulation360.MappedFile;
+
+import System.Base;
+
+using namespace std;
+
+/// A read-only memory mapping of an entire file.
+export class MappedFile {
+#ifdef _WIN32
+    HANDLE _file = INVALID_HANDLE_VALUE, _mapping = nullptr;
+#else
+    int _file = -1;
+#endif
+    const byte *_data = nullptr;
+    size_t _size = 0;
+
+public:
+    MappedFile() = default;
+
+    MappedFile(MappedFile &&other) noexcept {
+        *this = move(other);
+    }
+
+    MappedFile &operator=(MappedFile &&other) noexcept {
+        swap(_file, other._file);
+#ifdef _WIN32
+        swap(_mapping, other._mapping);
+#endif
+        swap(_data, other._data), swap(_size, other._size);
+        return *this;
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (_data) UnmapViewOfFile(_data);
+        if (_mapping) CloseHandle(_mapping);
+        if (_file != INVALID_HANDLE_VALUE) CloseHandle(_file);
+#else
+        if (_data) munmap(const_cast<byte *>(_data), _size);
+        if (_file >= 0) close(_file);
+#endif
+    }
+
+    /// Maps the file at the specified path.
+    /// @param path The path of a non-empty file.
+    /// @returns The mapping of the file, or an empty optional if the file cannot be mapped.
+    [[nodiscard]] static optional<MappedFile> Open(const filesystem::path &path) {
+        MappedFile file;
+#ifdef _WIN32
+        file._file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file._file == INVALID_HANDLE_VALUE) return {};
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file._file, &size) || size.QuadPart == 0) return {};
+        file._mapping = CreateFileMappingW(file._file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!file._mapping) return {};
+        file._data = static_cast<const byte *>(MapViewOfFile(file._mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!file._data) return {};
+        file._size = size.QuadPart;
+#else
+        file._file = open(path.c_str(), O_RDONLY);
+        if (file._file < 0) return {};
+        struct stat status;
+        if (fstat(file._file, &status) != 0 || status.st_size == 0) return {};
+        const auto data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file._file, 0);
+        if (data == MAP_FAILED) return {};
+        file._data = static_cast<const byte *>(data), file._size = status.st_size;
+#endif
+        return file;
+    }
+
+    /// Returns the content of the file.
+    /// @returns The content of the file, which remains valid until the mapping is destroyed.
+    [[nodiscard]] span<const byte> Bytes() const {
+        return {_data, _size};
+    }
+};
@@ -7,12 +7,68 @@ import ABRSimulation360.Base;
 
 using namespace std;
 
+/// An index of cumulative downloadable sizes over a network series.
+/// The index is immutable once built and can be shared by any number of network simulators on the same series.
+export class NetworkTraceIndex {
+    NetworkSeriesView _networkSeries;
+    vector<double> _cumulativeMB;
+
+public:
+    /// Creates an index over a network series.
+    /// @param networkSeries A network series.
+    explicit NetworkTraceIndex(NetworkSeriesView networkSeries) : _networkSeries(networkSeries) {
+        const auto [intervalSeconds, throughputsMbps] = networkSeries;
+        _cumulativeMB.resize(throughputsMbps.size() + 1);
+        for (auto i = 0; i < throughputsMbps.size(); ++i)
+            _cumulativeMB[i + 1] = _cumulativeMB[i] + throughputsMbps[i] * intervalSeconds / 8;
+    }
+
+    /// Returns the indexed network series.
+    /// @returns The indexed network series.
+    [[nodiscard]] NetworkSeriesView NetworkSeries() const {
+        return _networkSeries;
+    }
+
+    /// Returns the size downloadable over one pass of the network series in megabytes.
+    /// @returns The size downloadable over one pass of the network series in megabytes.
+    [[nodiscard]] double CycleMB() const {
+        return _cumulativeMB.back();
+    }
+
+    /// Returns the size downloadable from the beginning of the network series to a position in megabytes.
+    /// @param intervalID The index of the interval.
+    /// @param secondsInInterval The elapsed time in the interval in seconds.
+    /// @returns The size downloadable from the beginning of the network series to the position in megabytes.
+    [[nodiscard]] double CumulativeMB(int intervalID, double secondsInInterval) const {
+        return _cumulativeMB[intervalID] + _networkSeries.Values[intervalID] * secondsInInterval / 8;
+    }
+
+    /// Finds the earliest position at which the cumulative downloadable size reaches a value within one pass.
+    /// A value reached exactly at the beginning of an interval maps to that beginning rather than past any following
+    /// zero-throughput intervals, as downloads complete there.
+    /// @param cumulativeMB A cumulative size in megabytes from 0 to the size of one pass.
+    /// @returns The index of the interval (the number of intervals at the end of the pass)
+    /// and the elapsed time in the interval in seconds.
+    [[nodiscard]] pair<int, double> Position(double cumulativeMB) const {
+        const auto intervalCount = static_cast<int>(_networkSeries.Values.size());
+        const auto intervalID = static_cast<int>(ranges::lower_bound(_cumulativeMB, cumulativeMB)
+            - _cumulativeMB.cbegin());
+        if (intervalID > intervalCount) return {intervalCount, 0.};
+        if (intervalID == 0 || _cumulativeMB[intervalID] == cumulativeMB) return {intervalID, 0.};
+        const auto secondsInInterval = (cumulativeMB - _cumulativeMB[intervalID - 1]) * 8
+            / _networkSeries.Values[intervalID - 1];
+        return {intervalID - 1, secondsInInterval};
+    }
+};
+
 /// Simulates download actions under a network series.
 export class NetworkSimulator {
     NetworkSeriesView _networkSeries;
+    const NetworkTraceIndex *_index = nullptr;
 
     int _intervalID = 0;
     double _secondsInInterval = 0.;
+    int64_t _walkedIntervalCount = 0;
 
 public:
     /// Creates a network simulator from a network series.
@@ -20,16 +76,27 @@ public:
     explicit NetworkSimulator(NetworkSeriesView networkSeries): _networkSeries(networkSeries) {
     }
 
+    /// Creates a network simulator from an indexed network series, whose downloads take logarithmic time.
+    /// @param index An index over a network series, which must outlive the network simulator.
+    explicit NetworkSimulator(const NetworkTraceIndex &index) : _networkSeries(index.NetworkSeries()),
+                                                                _index(index.CycleMB() > 0. ? &index : nullptr) {
+    }
+
     /// Downloads content with the specified size until a timeout.
+    /// @tparam IsCounted Whether the walked network intervals are added to the walked interval count.
     /// @param sizeMB The content size in megabytes.
     /// @param timeoutSeconds The timeout in seconds.
     /// @returns The downloaded size in megabytes and the download time in seconds.
+    template<bool IsCounted = false>
     TimedValue<double> Download(double sizeMB, double timeoutSeconds = numeric_limits<double>::infinity()) {
+        if (_index) return IndexedDownload(sizeMB, timeoutSeconds);
+
         const auto [intervalSeconds, throughputsMbps] = _networkSeries;
         const auto intervalCount = static_cast<int>(throughputsMbps.size());
 
         auto downloadSeconds = 0., downloadedMB = 0.;
         while (downloadSeconds < timeoutSeconds && downloadedMB < sizeMB) {
+            if constexpr (IsCounted) ++_walkedIntervalCount;
             const auto remSizeMB = sizeMB - downloadedMB;
             const auto remSecondsInInterval =
                 min(intervalSeconds - _secondsInInterval, timeoutSeconds - downloadSeconds);
@@ -59,4 +126,181 @@ public:
         if (_secondsInInterval >= intervalSeconds) ++_intervalID, _secondsInInterval -= intervalSeconds;
         _intervalID %= intervalCount;
     }
+
+    /// Returns the number of network intervals walked by counted downloads, which is zero for indexed downloads.
+    /// @returns The number of network intervals walked by counted downloads.
+    [[nodiscard]] int64_t WalkedIntervalCount() const {
+        return _walkedIntervalCount;
+    }
+
+private:
+    TimedValue<double> IndexedDownload(double sizeMB, double timeoutSeconds) {
+        // Empty downloads complete immediately, even in zero-throughput intervals, as in the walk over intervals.
+        if (sizeMB <= 0.) return {0., 0.};
+        const auto [intervalSeconds, throughputsMbps] = _networkSeries;
+        const auto intervalCount = static_cast<int>(throughputsMbps.size());
+        const auto cycleSeconds = intervalCount * intervalSeconds, cycleMB = _index->CycleMB();
+        const auto beginSeconds = _intervalID * intervalSeconds + _secondsInInterval;
+        const auto beginMB = _index->CumulativeMB(_intervalID, _secondsInInterval);
+
+        // Downloads until the timeout if the content cannot be completed before it.
+        if (timeoutSeconds != numeric_limits<double>::infinity()) {
+            const auto endSeconds = beginSeconds + timeoutSeconds;
+            const auto cycleCount = floor(endSeconds / cycleSeconds);
+            const auto secondsInCycle = endSeconds - cycleCount * cycleSeconds;
+            const auto intervalID = min(static_cast<int>(secondsInCycle / intervalSeconds), intervalCount - 1);
+            const auto secondsInInterval = secondsInCycle - intervalID * intervalSeconds;
+            const auto availableMB = cycleCount * cycleMB + _index->CumulativeMB(intervalID, secondsInInterval)
+                - beginMB;
+            if (sizeMB > availableMB) {
+                _intervalID = intervalID, _secondsInInterval = secondsInInterval;
+                if (_secondsInInterval >= intervalSeconds)
+                    _intervalID = (_intervalID + 1) % intervalCount, _secondsInInterval -= intervalSeconds;
+                return {availableMB, timeoutSeconds};
+            }
+        }
+
+        // Solves for the completion time, wrapping around the network series arithmetically.
+        // A download that completes exactly at the end of a pass completes in that pass, before any trailing
+        // zero-throughput intervals.
+        const auto endMB = beginMB + sizeMB;
+        const auto cycleCount = ceil(endMB / cycleMB) - 1;
+        const auto [intervalID, secondsInInterval] = _index->Position(endMB - cycleCount * cycleMB);
+        _intervalID = intervalID % intervalCount, _secondsInInterval = secondsInInterval;
+        const auto endSeconds = cycleCount * cycleSeconds + intervalID * intervalSeconds + secondsInInterval;
+        return {sizeMB, endSeconds - beginSeconds};
+    }
+};
+
+/// Represents a policy that shares the capacity of a link among concurrent downloads.
+/// Each download is weighted when it starts, and receives a share of the capacity proportional to its weight
+/// among the downloads in progress, as in generalized processor sharing.
+export class ILinkSharePolicy {
+public:
+    virtual ~ILinkSharePolicy() = default;
+
+    /// Returns the weight of a download.
+    /// @param clientID The ID of the client that starts the download.
+    /// @param sizeMB The size of the download in megabytes.
+    /// @returns The weight of the download, which must be positive.
+    [[nodiscard]] virtual double Weight(int clientID, double sizeMB) const = 0;
+};
+
+/// An equal share policy gives every download in progress the same share of the capacity.
+export class EqualSharePolicy final : public ILinkSharePolicy {
+public:
+    [[nodiscard]] double Weight(int, double) const override {
+        return 1.;
+    }
+};
+
+/// A weighted share policy gives the downloads of each client a fixed weight, such as the priority of its class.
+export class WeightedSharePolicy final : public ILinkSharePolicy {
+    vector<double> _weights;
+
+public:
+    /// Creates a weighted share policy with the specified weights.
+    /// @param weights A list of positive weights, one per client.
+    explicit WeightedSharePolicy(vector<double> weights) : _weights(move(weights)) {
+    }
+
+    [[nodiscard]] double Weight(int clientID, double) const override {
+        return _weights[clientID];
+    }
+};
+
+/// A size-proportional share policy weights each download by its size,
+/// so that downloads in progress at the same time advance by the same fraction of their sizes.
+export class SizeProportionalSharePolicy final : public ILinkSharePolicy {
+public:
+    [[nodiscard]] double Weight(int, double sizeMB) const override {
+        return sizeMB;
+    }
+};
+
+/// Simulates concurrent downloads over a link whose capacity follows a network series.
+/// Capacity is shared in proportion to the weights of downloads in progress.
+/// Since every download then advances at its weight times a common rate, the link tracks the work per unit weight
+/// done since the beginning, and a download completes once that work reaches its size divided by its weight
+/// past the work at its start. Completions are thus ordered in a heap once, and advancing the link costs
+/// logarithmic time per completion regardless of the number of downloads in progress.
+/// The network series repeats itself after its end.
+export class SharedLinkSimulator {
+    struct Completion {
+        double EndWorkMB; // The work per unit weight at which the download completes.
+        double Weight;
+        int DownloadID;
+
+        bool operator>(const Completion &other) const {
+            return EndWorkMB > other.EndWorkMB;
+        }
+    };
+
+    NetworkSeriesView _capacitySeries;
+    double _seconds = 0.;
+    int64_t _intervalID = 0;
+    double _workMB = 0.;
+    double _totalWeight = 0.;
+    priority_queue<Completion, vector<Completion>, greater<>> _completions;
+
+public:
+    /// Creates a shared link simulator from a network series of link capacities.
+    /// @param capacitySeries A network series of link capacities, which must not be all zero.
+    explicit SharedLinkSimulator(NetworkSeriesView capacitySeries) : _capacitySeries(capacitySeries) {
+        if (ranges::none_of(capacitySeries.Values, [](double capacityMbps) { return capacityMbps > 0.; }))
+            throw invalid_argument("The capacity of a shared link must not be all zero.");
+    }
+
+    /// Returns the current time in seconds.
+    /// @returns The current time in seconds.
+    [[nodiscard]] double Seconds() const {
+        return _seconds;
+    }
+
+    /// Returns the number of downloads in progress.
+    /// @returns The number of downloads in progress.
+    [[nodiscard]] int DownloadCount() const {
+        return static_cast<int>(_completions.size());
+    }
+
+    /// Starts a download at the current time.
+    /// @param downloadID The ID of the download, which is returned when it completes.
+    /// @param sizeMB The size of the download in megabytes.
+    /// @param weight The weight of the download, which must be positive.
+    void Start(int downloadID, double sizeMB, double weight) {
+        _completions.push({_workMB + sizeMB / weight, weight, downloadID});
+        _totalWeight += weight;
+    }
+
+    /// Advances the current time to the next completion of a download or the specified time, whichever is earlier.
+    /// @param endSeconds The time until which to advance in seconds (infinity to advance to the next completion).
+    /// @returns The ID of the completed download, or nothing if no download completes by the specified time.
+    optional<int> AdvanceUntil(double endSeconds) {
+        const auto [intervalSeconds, capacitiesMbps] = _capacitySeries;
+        const auto intervalCount = static_cast<int64_t>(capacitiesMbps.size());
+        while (!_completions.empty()) {
+            const auto completion = _completions.top();
+            const auto intervalEndSeconds = static_cast<double>(_intervalID + 1) * intervalSeconds;
+            const auto stepEndSeconds = min(endSeconds, intervalEndSeconds);
+            const auto rateMBps = capacitiesMbps[_intervalID % intervalCount] / 8 / _totalWeight;
+            const auto remWorkMB = completion.EndWorkMB - _workMB;
+            if (rateMBps > 0. && _seconds + remWorkMB / rateMBps <= stepEndSeconds) {
+                _seconds += remWorkMB / rateMBps, _workMB = completion.EndWorkMB;
+                _completions.pop();
+                _totalWeight = _completions.empty() ? 0. : _totalWeight - completion.Weight;
+                return completion.DownloadID;
+            }
+            _workMB += rateMBps * (stepEndSeconds - _seconds), _seconds = stepEndSeconds;
+            if (stepEndSeconds == intervalEndSeconds) ++_intervalID;
+            if (_seconds >= endSeconds) return nullopt;
+        }
+
+        // Skips idle time without walking the network series.
+        if (endSeconds > _seconds && endSeconds != numeric_limits<double>::infinity()) {
+            _seconds = endSeconds;
+            _intervalID = static_cast<int64_t>(endSeconds / intervalSeconds);
+            if (static_cast<double>(_intervalID + 1) * intervalSeconds <= endSeconds) ++_intervalID;
+        }
+        return nullopt;
+    }
 };
@@ -0,0 +1,123 @@
+export module ABRSimulation360.QoE;
+
+import System.Base;
+import System.Math;
+import System.MDArray;
+
+import ABRSimulation360.Base;
+
+using namespace std;
+using namespace experimental;
+
+/// Represents a quality-of-experience metric of a segment.
+export enum class SegmentMetric {
+    ViewportQuality, ///< The utility of the segment weighted by the actual viewport distribution.
+    SpatialVariance, ///< The variance of utility across tiles weighted by the actual viewport distribution.
+    QualitySwitch, ///< The absolute change in viewport quality from the previous segment.
+    WastedMB ///< The size of tiles outside the actual viewport in megabytes.
+};
+
+/// Represents a quality-of-experience metric of a session.
+export enum class SessionMetric {
+    ViewportQuality, ///< The mean viewport quality over segments.
+    SpatialVariance, ///< The mean spatial variance over segments.
+    TemporalVariance, ///< The variance of viewport quality over segments.
+    WastedMB, ///< The total size of tiles outside the actual viewport in megabytes.
+    RebufferingSeconds ///< The total rebuffering duration in seconds.
+};
+
+/// The names of segment metrics in declaration order.
+export constexpr array SegmentMetricNames = {
+    "ViewportQuality"sv, "SpatialVariance"sv, "QualitySwitch"sv, "WastedMB"sv
+};
+
+/// The names of session metrics in declaration order.
+export constexpr array SessionMetricNames = {
+    "ViewportQuality"sv, "SpatialVariance"sv, "TemporalVariance"sv, "WastedMB"sv, "RebufferingSeconds"sv
+};
+
+/// The number of segment metrics.
+export constexpr auto SegmentMetricCount = static_cast<int>(SegmentMetricNames.size());
+
+/// The number of session metrics.
+export constexpr auto SessionMetricCount = static_cast<int>(SessionMetricNames.size());
+
+/// Evaluates the quality of experience of simulated sessions.
+/// The utility of a tile is the logarithm of its bitrate normalized to [0, 1] over the bitrate ladder,
+/// as used by bitrate allocators.
+export class QoEEvaluator {
+    double _segmentSeconds;
+    vector<double> _bitratesMbps;
+    vector<double> _utilities;
+
+public:
+    /// Creates a QoE evaluator with the specified configuration.
+    /// @param streamingConfig The adaptive bitrate streaming configuration.
+    explicit QoEEvaluator(const StreamingConfig &streamingConfig) : _segmentSeconds(streamingConfig.SegmentSeconds) {
+        const auto tileCountPerFace = streamingConfig.TilingCount * streamingConfig.TilingCount;
+        _bitratesMbps = streamingConfig.BitratesPerFaceMbps / tileCountPerFace;
+
+        const auto minBitrateMbps = _bitratesMbps.front(), maxBitrateMbps = _bitratesMbps.back();
+        const auto utilityNormalizer = Math::Log(maxBitrateMbps / minBitrateMbps);
+        _utilities = _bitratesMbps | views::transform([&](double bitrateMbps) {
+            return utilityNormalizer > 0. ? Math::Log(bitrateMbps / minBitrateMbps) / utilityNormalizer : 0.;
+        }) | ranges::to<vector>();
+    }
+
+    /// Returns the ID of a bitrate in the bitrate ladder.
+    /// @param bitrateMbps A bitrate per tile in megabits per second.
+    /// @returns The ID of the highest bitrate that does not exceed the specified bitrate.
+    [[nodiscard]] int BitrateID(double bitrateMbps) const {
+        const auto it = ranges::upper_bound(_bitratesMbps, bitrateMbps);
+        return it != _bitratesMbps.cbegin() ? static_cast<int>(it - _bitratesMbps.cbegin()) - 1 : 0;
+    }
+
+    /// Evaluates a simulated session.
+    /// @param bufferedBitratesMbps A 2D array of buffered bitrates in megabits per second.
+    /// @param distributions A list of actual viewport distributions.
+    /// @param rebufferingSeconds The total rebuffering duration in seconds.
+    /// @param sessionQoE The output session metrics, one entry per metric.
+    /// @param segmentQoE The output segment metrics indexed by segment and metric (empty for no segment metrics).
+    void Evaluate(mdspan<const double, dims<2>> bufferedBitratesMbps,
+                  mdspan<const double, dims<2>> distributions,
+                  double rebufferingSeconds,
+                  span<double> sessionQoE,
+                  mdspan<double, dims<2>> segmentQoE = {}) const {
+        const auto segmentCount = static_cast<int>(bufferedBitratesMbps.extent(0));
+        const auto tileCount = static_cast<int>(bufferedBitratesMbps.extent(1));
+
+        auto totalQuality = 0., totalSquaredQuality = 0., totalSpatialVariance = 0., totalWastedMB = 0.;
+        auto prevQuality = 0.;
+        for (auto segmentID = 0; segmentID < segmentCount; ++segmentID) {
+            auto quality = 0., squaredQuality = 0., wastedMB = 0.;
+            for (auto tileID = 0; tileID < tileCount; ++tileID) {
+                const auto bitrateMbps = bufferedBitratesMbps[segmentID, tileID];
+                const auto probability = distributions[segmentID, tileID];
+                const auto utility = _utilities[BitrateID(bitrateMbps)];
+                quality += probability * utility, squaredQuality += probability * utility * utility;
+                if (probability == 0.) wastedMB += bitrateMbps * _segmentSeconds / 8;
+            }
+            const auto spatialVariance = max(squaredQuality - quality * quality, 0.);
+            if (segmentQoE.data_handle()) {
+                segmentQoE[segmentID, to_underlying(SegmentMetric::ViewportQuality)] = quality;
+                segmentQoE[segmentID, to_underlying(SegmentMetric::SpatialVariance)] = spatialVariance;
+                segmentQoE[segmentID, to_underlying(SegmentMetric::QualitySwitch)] =
+                    segmentID > 0 ? Math::Abs(quality - prevQuality) : 0.;
+                segmentQoE[segmentID, to_underlying(SegmentMetric::WastedMB)] = wastedMB;
+            }
+            totalQuality += quality, totalSquaredQuality += quality * quality;
+            totalSpatialVariance += spatialVariance, totalWastedMB += wastedMB;
+            prevQuality = quality;
+        }
+
+        const auto meanQuality = segmentCount > 0 ? totalQuality / segmentCount : 0.;
+        const auto meanSquaredQuality = segmentCount > 0 ? totalSquaredQuality / segmentCount : 0.;
+        sessionQoE[to_underlying(SessionMetric::ViewportQuality)] = meanQuality;
+        sessionQoE[to_underlying(SessionMetric::SpatialVariance)] =
+            segmentCount > 0 ? totalSpatialVariance / segmentCount : 0.;
+        sessionQoE[to_underlying(SessionMetric::TemporalVariance)] =
+            max(meanSquaredQuality - meanQuality * meanQuality, 0.);
+        sessionQoE[to_underlying(SessionMetric::WastedMB)] = totalWastedMB;
+        sessionQoE[to_underlying(SessionMetric::RebufferingSeconds)] = rebufferingSeconds;
+    }
+};
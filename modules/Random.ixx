@@ -0,0 +1,142 @@
+export module ABRSimulation360.Random;
+
+import System.Base;
+
+using namespace std;
+
+/// Represents the key of a random stream.
+export struct RandomKey {
+    uint64_t Seed = 0; ///< The seed shared by all streams of a simulation.
+    uint32_t SessionID = 0; ///< The ID of the session.
+    uint32_t ReplicaID = 0; ///< The ID of the replica of the session.
+    uint32_t SegmentID = 0; ///< The ID of the segment being downloaded.
+
+    bool operator==(const RandomKey &) const = default;
+    bool operator!=(const RandomKey &) const = default;
+};
+
+/// Generates a counter-based random stream with the Philox4x32-10 generator.
+/// Each block of four random words is a pure function of the key of the stream and the index of the block,
+/// so that a stream never depends on the order in which streams are created or the thread that draws from it,
+/// and blocks can be generated independently of each other in vectorized loops.
+export class RandomStream {
+    array<uint32_t, 4> _counter;
+    array<uint32_t, 2> _key;
+    array<uint32_t, 4> _block = {};
+    int _wordID = 4;
+
+public:
+    using result_type = uint32_t;
+
+    /// Creates a random stream with the specified key.
+    /// @param key The key of the random stream.
+    explicit RandomStream(const RandomKey &key = {}) :
+        _counter{0, key.SegmentID, key.ReplicaID, key.SessionID},
+        _key{static_cast<uint32_t>(key.Seed), static_cast<uint32_t>(key.Seed >> 32)} {
+    }
+
+    [[nodiscard]] static constexpr result_type min() {
+        return 0;
+    }
+
+    [[nodiscard]] static constexpr result_type max() {
+        return numeric_limits<result_type>::max();
+    }
+
+    /// Returns the next random word.
+    /// @returns The next random word.
+    result_type operator()() {
+        if (_wordID == 4) _block = Philox(_counter, _key), ++_counter[0], _wordID = 0;
+        return _block[_wordID++];
+    }
+
+    /// Returns the next uniform random number.
+    /// @returns A uniform random number in [0, 1).
+    double Uniform() {
+        const auto high = (*this)();
+        return ToUniform(high, (*this)());
+    }
+
+    /// Fills an array with uniform random numbers from fresh blocks of the stream.
+    /// The remaining words of a partially consumed block are skipped.
+    /// @param values An array to fill with uniform random numbers in [0, 1).
+    void Uniforms(span<double> values) {
+        const auto pairCount = values.size() / 2;
+        for (size_t i = 0; i < pairCount; ++i) {
+            const auto block = Philox({static_cast<uint32_t>(_counter[0] + i), _counter[1], _counter[2], _counter[3]},
+                                      _key);
+            values[i * 2] = ToUniform(block[0], block[1]);
+            values[i * 2 + 1] = ToUniform(block[2], block[3]);
+        }
+        _counter[0] += static_cast<uint32_t>(pairCount), _wordID = 4;
+        if (values.size() % 2 == 1) values.back() = Uniform();
+    }
+
+    /// Generates a block of random words.
+    /// @param counter The counter of the block.
+    /// @param key The key of the block.
+    /// @returns The block of random words.
+    [[nodiscard]] static array<uint32_t, 4> Philox(array<uint32_t, 4> counter, array<uint32_t, 2> key) {
+        for (auto round = 0; round < 10; ++round) {
+            const auto product0 = uint64_t{0xD2511F53} * counter[0];
+            const auto product1 = uint64_t{0xCD9E8D57} * counter[2];
+            counter = {
+                static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0], static_cast<uint32_t>(product1),
+                static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1], static_cast<uint32_t>(product0)
+            };
+            key[0] += 0x9E3779B9, key[1] += 0xBB67AE85;
+        }
+        return counter;
+    }
+
+private:
+    [[nodiscard]] static double ToUniform(uint32_t high, uint32_t low) {
+        return static_cast<double>((static_cast<uint64_t>(high) << 32 | low) >> 11) * 0x1p-53;
+    }
+};
+
+// The random state of a thread, which is set by random scopes and read by components that draw random numbers.
+struct RandomContext {
+    RandomKey Key;
+    RandomStream Stream;
+};
+
+thread_local RandomContext CurrentRandomContext;
+
+/// Keys the random stream of the calling thread by a session and a replica while the scope is alive.
+/// Components draw from the stream of the current segment, which restarts whenever a segment begins,
+/// so that the draws of a segment depend only on the seed, session, replica, and segment.
+export class RandomScope {
+    RandomContext _prevContext;
+
+public:
+    /// Enters a random scope.
+    /// @param seed The seed shared by all streams of a simulation.
+    /// @param sessionID The ID of the session.
+    /// @param replicaID The ID of the replica of the session.
+    RandomScope(uint64_t seed, uint32_t sessionID, uint32_t replicaID = 0) : _prevContext(CurrentRandomContext) {
+        CurrentRandomContext.Key = {seed, sessionID, replicaID};
+        CurrentRandomContext.Stream = RandomStream(CurrentRandomContext.Key);
+    }
+
+    RandomScope(const RandomScope &) = delete;
+    RandomScope &operator=(const RandomScope &) = delete;
+
+    ~RandomScope() {
+        CurrentRandomContext = _prevContext;
+    }
+
+    /// Restarts the random stream of the calling thread for a segment.
+    /// @param segmentID The ID of the segment being downloaded.
+    static void SetSegmentID(uint32_t segmentID) {
+        auto &context = CurrentRandomContext;
+        context.Key.SegmentID = segmentID;
+        context.Stream = RandomStream(context.Key);
+    }
+
+    /// Returns the random stream of the calling thread.
+    /// @returns The random stream of the calling thread.
+    [[nodiscard]] static RandomStream &Stream() {
+        return CurrentRandomContext.Stream;
+    }
+};
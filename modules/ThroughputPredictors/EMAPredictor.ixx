@@ -25,7 +25,9 @@ export {
 }
 
 /// An exponential moving average predictor predicts throughputs from two exponential moving average estimates.
-export class EMAPredictor : public IThroughputPredictor {
+export class EMAPredictor final : public IThroughputPredictor {
+    friend class EMAPredictorLanes;
+
     double _slowHalfLifeSeconds, _fastHalfLifeSeconds;
 
     double _totalSeconds = 0.;
@@ -38,18 +40,78 @@ public:
         _slowHalfLifeSeconds(options.SlowHalfLifeSeconds), _fastHalfLifeSeconds(options.FastHalfLifeSeconds) {
     }
 
+    [[nodiscard]] unique_ptr<IThroughputPredictor> Clone() const override {
+        return make_unique<EMAPredictor>(*this);
+    }
+
     void Update(double downloadedMB, double downloadSeconds) override {
-        const auto throughputMbps = downloadedMB * 8 / downloadSeconds;
-        const auto prevSlowWeight = Math::Pow(0.5, downloadSeconds / _slowHalfLifeSeconds),
-                   prevFastWeight = Math::Pow(0.5, downloadSeconds / _fastHalfLifeSeconds);
-        _totalSeconds += downloadSeconds;
-        _slowPredictionMbps = prevSlowWeight * _slowPredictionMbps + (1 - prevSlowWeight) * throughputMbps;
-        _fastPredictionMbps = prevFastWeight * _fastPredictionMbps + (1 - prevFastWeight) * throughputMbps;
+        Update(_slowHalfLifeSeconds, _fastHalfLifeSeconds, downloadedMB, downloadSeconds,
+               _totalSeconds, _slowPredictionMbps, _fastPredictionMbps);
     }
 
     [[nodiscard]] double PredictThroughputMbps() const override {
-        const auto slowFactor = 1 - Math::Pow(0.5, _totalSeconds / _slowHalfLifeSeconds),
-                   fastFactor = 1 - Math::Pow(0.5, _totalSeconds / _fastHalfLifeSeconds);
-        return min(_slowPredictionMbps / slowFactor, _fastPredictionMbps / fastFactor);
+        return PredictThroughputMbps(_slowHalfLifeSeconds, _fastHalfLifeSeconds,
+                                     _totalSeconds, _slowPredictionMbps, _fastPredictionMbps);
+    }
+
+private:
+    // Updates the state of a predictor with a download, shared with predictors held as arrays across lanes.
+    static void Update(double slowHalfLifeSeconds, double fastHalfLifeSeconds,
+                       double downloadedMB, double downloadSeconds,
+                       double &totalSeconds, double &slowPredictionMbps, double &fastPredictionMbps) {
+        const auto throughputMbps = downloadedMB * 8 / downloadSeconds;
+        const auto prevSlowWeight = Math::Pow(0.5, downloadSeconds / slowHalfLifeSeconds),
+                   prevFastWeight = Math::Pow(0.5, downloadSeconds / fastHalfLifeSeconds);
+        totalSeconds += downloadSeconds;
+        slowPredictionMbps = prevSlowWeight * slowPredictionMbps + (1 - prevSlowWeight) * throughputMbps;
+        fastPredictionMbps = prevFastWeight * fastPredictionMbps + (1 - prevFastWeight) * throughputMbps;
+    }
+
+    // Predicts the throughput from the state of a predictor, correcting the estimates for their zero initial values.
+    static double PredictThroughputMbps(double slowHalfLifeSeconds, double fastHalfLifeSeconds,
+                                        double totalSeconds, double slowPredictionMbps, double fastPredictionMbps) {
+        const auto slowFactor = 1 - Math::Pow(0.5, totalSeconds / slowHalfLifeSeconds),
+                   fastFactor = 1 - Math::Pow(0.5, totalSeconds / fastHalfLifeSeconds);
+        return min(slowPredictionMbps / slowFactor, fastPredictionMbps / fastFactor);
+    }
+};
+
+/// Holds the exponential moving average predictors of the lanes of a session batch as arrays across lanes,
+/// so that the predictors of all lanes are updated and queried in vectorizable loops.
+/// The lanes in progress are the first lanes of the batch, whose number is given by the sizes of the arguments.
+export class EMAPredictorLanes {
+    double _slowHalfLifeSeconds, _fastHalfLifeSeconds;
+
+    vector<double> _totalSeconds;
+    vector<double> _slowPredictionsMbps, _fastPredictionsMbps;
+
+public:
+    /// Creates the predictors of a number of lanes, each of which starts from the state of a predictor.
+    /// @param predictor The predictor.
+    /// @param laneCount The number of lanes.
+    EMAPredictorLanes(const EMAPredictor &predictor, int laneCount) :
+        _slowHalfLifeSeconds(predictor._slowHalfLifeSeconds), _fastHalfLifeSeconds(predictor._fastHalfLifeSeconds),
+        _totalSeconds(laneCount, predictor._totalSeconds),
+        _slowPredictionsMbps(laneCount, predictor._slowPredictionMbps),
+        _fastPredictionsMbps(laneCount, predictor._fastPredictionMbps) {
+    }
+
+    /// Updates the predictors of the lanes in progress with their last downloads.
+    /// @param downloadedMB A list of downloaded sizes in megabytes, one per lane in progress.
+    /// @param downloadSeconds A list of download times in seconds, one per lane in progress.
+    void Update(span<const double> downloadedMB, span<const double> downloadSeconds) {
+        for (size_t laneID = 0; laneID < downloadedMB.size(); ++laneID)
+            EMAPredictor::Update(_slowHalfLifeSeconds, _fastHalfLifeSeconds, downloadedMB[laneID],
+                                 downloadSeconds[laneID], _totalSeconds[laneID],
+                                 _slowPredictionsMbps[laneID], _fastPredictionsMbps[laneID]);
+    }
+
+    /// Predicts the throughputs of the lanes in progress.
+    /// @param throughputsMbps A list to hold the predicted throughputs in megabits per second, one per lane in progress.
+    void PredictThroughputsMbps(span<double> throughputsMbps) const {
+        for (size_t laneID = 0; laneID < throughputsMbps.size(); ++laneID)
+            throughputsMbps[laneID] = EMAPredictor::PredictThroughputMbps(
+                _slowHalfLifeSeconds, _fastHalfLifeSeconds, _totalSeconds[laneID],
+                _slowPredictionsMbps[laneID], _fastPredictionsMbps[laneID]);
     }
 };
@@ -4,6 +4,10 @@ module;
 
 export module ABRSimulation360.ThroughputPredictors.IThroughputPredictor;
 
+import System.Base;
+
+using namespace std;
+
 /// Represents the base options for a throughput predictor.
 export struct BaseThroughputPredictorOptions {
     virtual ~BaseThroughputPredictorOptions() = default;
@@ -18,6 +22,10 @@ export class IThroughputPredictor {
 public:
     virtual ~IThroughputPredictor() = default;
 
+    /// Creates a copy of the throughput predictor including its state.
+    /// @returns A copy of the throughput predictor.
+    [[nodiscard]] virtual unique_ptr<IThroughputPredictor> Clone() const = 0;
+
     /// Updates the throughput predictor with the latest download information.
     /// @param downloadedMB The downloaded size in megabytes.
     /// @param downloadSeconds The download time in seconds.
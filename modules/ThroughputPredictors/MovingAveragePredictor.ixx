@@ -23,7 +23,9 @@ export {
 }
 
 /// A moving average predictor predicts throughputs from the mean value and mean deviation within a moving window.
-export class MovingAveragePredictor : public IThroughputPredictor {
+export class MovingAveragePredictor final : public IThroughputPredictor {
+    friend class MovingAveragePredictorLanes;
+
     double _windowSeconds;
 
     deque<double> _intervalsSeconds, _downloadedMb;
@@ -36,6 +38,10 @@ public:
         _windowSeconds(options.WindowSeconds) {
     }
 
+    [[nodiscard]] unique_ptr<IThroughputPredictor> Clone() const override {
+        return make_unique<MovingAveragePredictor>(*this);
+    }
+
     void Update(double downloadedMB, double downloadSeconds) override {
         const auto downloadedMb = downloadedMB * 8;
         _intervalsSeconds.push_back(downloadSeconds), _downloadedMb.push_back(downloadedMb);
@@ -55,3 +61,86 @@ public:
         return (_totalMb - excessMb) / _windowSeconds;
     }
 };
+
+/// Holds the moving average predictors of the lanes of a session batch as arrays across lanes.
+/// All lanes in progress download a segment at each step, so the downloads of each step form a row across lanes,
+/// and the moving window of each lane is the range of rows from its first row in the window to the last row.
+/// The lanes in progress are the first lanes of the batch, whose number is given by the sizes of the arguments.
+export class MovingAveragePredictorLanes {
+    double _windowSeconds;
+    int _laneCount;
+
+    vector<double> _intervalsSeconds, _downloadedMb;
+    vector<int> _beginRowIDs;
+    vector<double> _totalSeconds, _totalMb;
+
+public:
+    /// Creates the predictors of a number of lanes, each of which starts from the state of a predictor.
+    /// @param predictor The predictor.
+    /// @param laneCount The number of lanes.
+    MovingAveragePredictorLanes(const MovingAveragePredictor &predictor, int laneCount) :
+        _windowSeconds(predictor._windowSeconds), _laneCount(laneCount),
+        _beginRowIDs(laneCount), _totalSeconds(laneCount, predictor._totalSeconds),
+        _totalMb(laneCount, predictor._totalMb) {
+        for (size_t i = 0; i < predictor._intervalsSeconds.size(); ++i) {
+            _intervalsSeconds.insert(_intervalsSeconds.end(), laneCount, predictor._intervalsSeconds[i]);
+            _downloadedMb.insert(_downloadedMb.end(), laneCount, predictor._downloadedMb[i]);
+        }
+    }
+
+    /// Updates the predictors of the lanes in progress with their last downloads.
+    /// @param downloadedMB A list of downloaded sizes in megabytes, one per lane in progress.
+    /// @param downloadSeconds A list of download times in seconds, one per lane in progress.
+    void Update(span<const double> downloadedMB, span<const double> downloadSeconds) {
+        const auto laneCount = static_cast<int>(downloadedMB.size());
+        if (laneCount == 0) return;
+        const auto rowID = RowCount();
+        _intervalsSeconds.resize(_intervalsSeconds.size() + _laneCount);
+        _downloadedMb.resize(_downloadedMb.size() + _laneCount);
+        const span intervalsSeconds(&_intervalsSeconds[rowID * _laneCount], laneCount),
+                   downloadedMb(&_downloadedMb[rowID * _laneCount], laneCount);
+        for (auto laneID = 0; laneID < laneCount; ++laneID) {
+            intervalsSeconds[laneID] = downloadSeconds[laneID], downloadedMb[laneID] = downloadedMB[laneID] * 8;
+            _totalSeconds[laneID] += intervalsSeconds[laneID], _totalMb[laneID] += downloadedMb[laneID];
+        }
+
+        for (auto laneID = 0; laneID < laneCount; ++laneID) {
+            auto &beginRowID = _beginRowIDs[laneID];
+            while (_totalSeconds[laneID] - _intervalsSeconds[beginRowID * _laneCount + laneID] > _windowSeconds) {
+                _totalSeconds[laneID] -= _intervalsSeconds[beginRowID * _laneCount + laneID];
+                _totalMb[laneID] -= _downloadedMb[beginRowID * _laneCount + laneID];
+                ++beginRowID;
+            }
+        }
+
+        // Drops the rows that have left the windows of all lanes in progress once they make up half of the rows.
+        const auto droppedRowCount = ranges::min(span(_beginRowIDs).first(laneCount));
+        if (droppedRowCount * 2 >= RowCount()) {
+            const auto droppedCount = droppedRowCount * _laneCount;
+            _intervalsSeconds.erase(_intervalsSeconds.begin(), _intervalsSeconds.begin() + droppedCount);
+            _downloadedMb.erase(_downloadedMb.begin(), _downloadedMb.begin() + droppedCount);
+            for (auto laneID = 0; laneID < laneCount; ++laneID) _beginRowIDs[laneID] -= droppedRowCount;
+        }
+    }
+
+    /// Predicts the throughputs of the lanes in progress.
+    /// @param throughputsMbps A list to hold the predicted throughputs in megabits per second, one per lane in progress.
+    void PredictThroughputsMbps(span<double> throughputsMbps) const {
+        for (size_t laneID = 0; laneID < throughputsMbps.size(); ++laneID) {
+            if (_totalSeconds[laneID] <= _windowSeconds) {
+                throughputsMbps[laneID] = _totalMb[laneID] / _totalSeconds[laneID];
+                continue;
+            }
+
+            const auto beginID = _beginRowIDs[laneID] * _laneCount + laneID;
+            const auto excessSeconds = _totalSeconds[laneID] - _windowSeconds;
+            const auto excessMb = _downloadedMb[beginID] * excessSeconds / _intervalsSeconds[beginID];
+            throughputsMbps[laneID] = (_totalMb[laneID] - excessMb) / _windowSeconds;
+        }
+    }
+
+private:
+    [[nodiscard]] int RowCount() const {
+        return static_cast<int>(_intervalsSeconds.size()) / _laneCount;
+    }
+};
@@ -16,6 +16,16 @@ using namespace std;
     if (const auto *const _options = dynamic_cast<const CONCAT(T, Options) *>(&options)) \
         return make_unique<T>(*_options);
 
+#define TRY_CREATE_VARIANT(T) \
+    if (const auto *const _options = dynamic_cast<const CONCAT(T, Options) *>(&options)) \
+        return ThroughputPredictorVariant(in_place_type<T>, *_options);
+
+/// Represents a built-in throughput predictor held by value, so that calls on it can be resolved at compile time.
+export using ThroughputPredictorVariant = variant<
+    EMAPredictor,
+    MovingAveragePredictor
+>;
+
 /// Represents a factory for throughput predictors.
 export class ThroughputPredictorFactory {
 public:
@@ -29,4 +39,15 @@ public:
                  ))
         throw runtime_error("Unknown throughput predictor options.");
     }
+
+    /// Creates a throughput predictor of a built-in type with the specified options.
+    /// @param options The options for the throughput predictor.
+    /// @returns A throughput predictor with the specified options.
+    [[nodiscard]] static ThroughputPredictorVariant CreateVariant(const BaseThroughputPredictorOptions &options) {
+        FOR_EACH(TRY_CREATE_VARIANT, (
+                     EMAPredictor,
+                     MovingAveragePredictor
+                 ))
+        throw runtime_error("Unknown throughput predictor options.");
+    }
 };
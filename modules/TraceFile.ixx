@@ -0,0 +1,105 @@
+export module ABRSimulation360.TraceFile;
+
+import LibraryLinkUtilities.TimeSeries;
+import System.Base;
+
+import ABRSimulation360.Base;
+import ABRSimulation360.MappedFile;
+
+using namespace std;
+
+/// A collection of time series in a binary columnar file that is memory-mapped instead of read.
+/// The file holds a fixed header, the offset of each series in samples, and the samples of all series back to back,
+/// each sample in its in-memory representation, so that series are viewed directly in the mapping without copying.
+/// @tparam T The type of the samples, which consists of double-precision components.
+export template<typename T>
+class TraceFile {
+    static_assert(sizeof(T) % sizeof(double) == 0 && is_trivially_copyable_v<T>);
+
+    struct Header {
+        array<char, 8> Magic;
+        uint32_t Version;
+        uint32_t ComponentCount;
+        uint64_t PathCount;
+        double IntervalSeconds;
+    };
+
+    static constexpr array<char, 8> Magic = {'A', 'B', 'R', 'T', 'R', 'A', 'C', 'E'};
+    static constexpr uint32_t Version = 1;
+    static constexpr uint32_t ComponentCount = sizeof(T) / sizeof(double);
+
+    MappedFile _file;
+    double _intervalSeconds;
+    span<const uint64_t> _offsets;
+    const T *_values;
+
+public:
+    /// Opens the trace file at the specified path.
+    /// @param path The path of the trace file.
+    explicit TraceFile(const filesystem::path &path) {
+        auto file = MappedFile::Open(path);
+        if (!file) throw runtime_error(format("Cannot map the trace file \"{}\".", path.string()));
+        _file = move(*file);
+
+        const auto bytes = _file.Bytes();
+        Header header;
+        if (bytes.size() < sizeof(Header)) throw runtime_error(format("Invalid trace file \"{}\".", path.string()));
+        memcpy(&header, bytes.data(), sizeof(Header));
+        // The path count and offsets are untrusted, so they are bounded by the file size before any size is computed.
+        if (header.Magic != Magic || header.Version != Version || header.ComponentCount != ComponentCount
+            || header.PathCount >= (bytes.size() - sizeof(Header)) / sizeof(uint64_t)
+            || header.PathCount > static_cast<uint64_t>(numeric_limits<int>::max()))
+            throw runtime_error(format("Invalid trace file \"{}\".", path.string()));
+
+        const auto offsetsSize = (header.PathCount + 1) * sizeof(uint64_t);
+        const auto valuesSize = bytes.size() - sizeof(Header) - offsetsSize;
+        _intervalSeconds = header.IntervalSeconds;
+        _offsets = {reinterpret_cast<const uint64_t *>(bytes.data() + sizeof(Header)), header.PathCount + 1};
+        _values = reinterpret_cast<const T *>(bytes.data() + sizeof(Header) + offsetsSize);
+        if (_offsets.front() != 0 || !ranges::is_sorted(_offsets)
+            || valuesSize % sizeof(T) != 0 || _offsets.back() != valuesSize / sizeof(T))
+            throw runtime_error(format("Invalid trace file \"{}\".", path.string()));
+    }
+
+    /// Returns the number of series.
+    /// @returns The number of series.
+    [[nodiscard]] int PathCount() const {
+        return static_cast<int>(_offsets.size() - 1);
+    }
+
+    /// Returns the interval between two samples in seconds.
+    /// @returns The interval between two samples in seconds.
+    [[nodiscard]] double IntervalSeconds() const {
+        return _intervalSeconds;
+    }
+
+    /// Returns the series at the specified index.
+    /// @param index The index of the series.
+    /// @returns A view of the series, which remains valid until the trace file is destroyed.
+    [[nodiscard]] LLU::TimeSeriesView<T> operator[](int index) const {
+        return {_intervalSeconds, span(_values + _offsets[index], _offsets[index + 1] - _offsets[index])};
+    }
+
+    /// Writes a collection of series to a trace file.
+    /// @param path The path of the trace file.
+    /// @param intervalSeconds The interval between two samples in seconds.
+    /// @param paths A list of series, each of which is a contiguous range of samples.
+    static void Write(const filesystem::path &path, double intervalSeconds, span<const span<const T>> paths) {
+        const Header header = {Magic, Version, ComponentCount, paths.size(), intervalSeconds};
+        vector<uint64_t> offsets(paths.size() + 1);
+        for (auto i = 0; i < paths.size(); ++i) offsets[i + 1] = offsets[i] + paths[i].size();
+
+        ofstream stream(path, ios::binary);
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+        stream.write(reinterpret_cast<const char *>(offsets.data()), offsets.size() * sizeof(uint64_t));
+        for (const auto values : paths)
+            stream.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+        if (!stream) throw runtime_error(format("Cannot write the trace file \"{}\".", path.string()));
+    }
+};
+
+/// A collection of network series in a trace file.
+export using NetworkTraceFile = TraceFile<double>;
+
+/// A collection of viewport series in a trace file.
+export using ViewportTraceFile = TraceFile<SphericalPosition>;
@@ -0,0 +1,340 @@
+export module ABRSimulation360.Tracing;
+
+import System.Base;
+
+using namespace std;
+
+/// Represents a value traced on a channel during a segment of a session.
+export struct TraceRecord {
+    uint32_t SessionID; ///< The ID of the session.
+    uint32_t SegmentID; ///< The ID of the segment being downloaded.
+    uint32_t ChannelID; ///< The ID of the channel.
+    float Value; ///< The traced value.
+
+    bool operator==(const TraceRecord &) const = default;
+    bool operator!=(const TraceRecord &) const = default;
+};
+
+/// Represents a named channel of trace records.
+/// Channels are registered once per process and shared by all tracers, so that a channel can be declared
+/// next to the component that traces it.
+export class TraceChannel {
+    struct Registry {
+        mutex Mutex;
+        vector<string> Names;
+        unordered_map<string, uint32_t> IDs;
+    };
+
+    uint32_t _id;
+
+public:
+    /// Registers a channel, or refers to the channel that has been registered with the same name.
+    /// @param name The name of the channel.
+    explicit TraceChannel(string_view name) {
+        auto &registry = GetRegistry();
+        const lock_guard lock(registry.Mutex);
+        const auto [it, isInserted] = registry.IDs.try_emplace(string(name), registry.Names.size());
+        if (isInserted) registry.Names.emplace_back(name);
+        _id = it->second;
+    }
+
+    /// Returns the ID of the channel.
+    /// @returns The ID of the channel, which is its index in registration order.
+    [[nodiscard]] uint32_t ID() const {
+        return _id;
+    }
+
+    /// Returns the names of channels in registration order.
+    /// @param beginID The ID of the first channel to return.
+    /// @returns The names of all channels from the specified ID.
+    [[nodiscard]] static vector<string> Names(size_t beginID = 0) {
+        auto &registry = GetRegistry();
+        const lock_guard lock(registry.Mutex);
+        return registry.Names | views::drop(beginID) | ranges::to<vector>();
+    }
+
+private:
+    [[nodiscard]] static Registry &GetRegistry() {
+        static Registry registry;
+        return registry;
+    }
+};
+
+/// Represents the options for a tracer.
+export struct TracerOptions {
+    int RingCapacity = 1 << 14; ///< The number of records buffered per thread, which must be a power of 2.
+    double FlushSeconds = 0.05; ///< The interval between two writes of buffered records in seconds.
+};
+
+/// Represents the content of a trace log.
+export struct TraceLog {
+    vector<string> ChannelNames; ///< The names of channels indexed by channel ID.
+    vector<TraceRecord> Records; ///< A list of records, which are in order for each thread that traced them.
+    int64_t DroppedCount; ///< The number of records dropped because the buffer of their thread was full.
+};
+
+// A bounded single-producer single-consumer queue of records.
+// The producer never blocks, and records that do not fit are counted and dropped.
+struct TraceRing {
+    alignas(64) atomic<uint64_t> Head = 0;
+    alignas(64) atomic<uint64_t> Tail = 0;
+    alignas(64) atomic<int64_t> DroppedCount = 0;
+    vector<TraceRecord> Records;
+
+    explicit TraceRing(int capacity) : Records(capacity) {
+    }
+
+    // Returns the number of buffered records after the push.
+    size_t Push(const TraceRecord &record) {
+        const auto head = Head.load(memory_order_relaxed);
+        if (head - Tail.load(memory_order_acquire) == Records.size()) {
+            DroppedCount.fetch_add(1, memory_order_relaxed);
+            return Records.size();
+        }
+        Records[head & (Records.size() - 1)] = record;
+        Head.store(head + 1, memory_order_release);
+        return head + 1 - Tail.load(memory_order_relaxed);
+    }
+
+    void DrainTo(vector<TraceRecord> &out) {
+        const auto tail = Tail.load(memory_order_relaxed), head = Head.load(memory_order_acquire);
+        for (auto i = tail; i < head; ++i) out.push_back(Records[i & (Records.size() - 1)]);
+        Tail.store(head, memory_order_release);
+    }
+};
+
+export class Tracer;
+
+// The tracing state of a thread, which is set by trace scopes and read on every traced value.
+struct TraceContext {
+    Tracer *Tracer = nullptr;
+    uint32_t SessionID = 0;
+    uint32_t SegmentID = 0;
+    uint64_t RingTracerID = 0;
+    TraceRing *Ring = nullptr;
+};
+
+thread_local TraceContext CurrentTraceContext;
+
+/// Writes trace records from any number of threads to a binary trace log.
+/// Each thread buffers its records in a lock-free ring of its own, and a background thread periodically writes
+/// all buffered records, so that tracing never waits for the file. A thread whose ring is full drops its records
+/// until the next write, which bounds memory and is reported as a drop count.
+/// Values are traced through the static Emit method, and are recorded only on threads in a trace scope.
+///
+/// A trace log starts with a fixed header, followed by chunks that each consist of a chunk header,
+/// the names of newly registered channels as length-prefixed strings, and the records of the chunk.
+export class Tracer {
+    struct Header {
+        array<char, 8> Magic;
+        uint32_t Version;
+        uint32_t RecordSize;
+    };
+
+    struct ChunkHeader {
+        uint32_t ChannelCount;
+        uint32_t RecordCount;
+        int64_t DroppedCount;
+    };
+
+    static constexpr array<char, 8> Magic = {'A', 'B', 'R', 'T', 'R', 'L', 'O', 'G'};
+    static constexpr uint32_t Version = 1;
+
+    inline static atomic<uint64_t> _nextID = 1;
+
+    uint64_t _id = _nextID++;
+    filesystem::path _path;
+    int _ringCapacity;
+    chrono::duration<double> _flushInterval;
+
+    mutable mutex _ringMutex;
+    map<thread::id, unique_ptr<TraceRing>> _rings;
+
+    mutex _writeMutex;
+    ofstream _stream;
+    vector<TraceRecord> _chunkRecords;
+    size_t _channelCount = 0;
+    int64_t _droppedCount = 0;
+    atomic<int64_t> _recordCount = 0;
+
+    mutex _wakeMutex;
+    condition_variable_any _wakeCondition;
+    atomic<bool> _isWakeRequested = false;
+    jthread _writer;
+
+public:
+    /// Creates a trace log and starts writing to it in the background.
+    /// @param path The path of the trace log.
+    /// @param options The options for the tracer.
+    explicit Tracer(filesystem::path path, const TracerOptions &options = {}) :
+        _path(move(path)), _ringCapacity(options.RingCapacity), _flushInterval(options.FlushSeconds),
+        _stream(_path, ios::binary) {
+        if (!has_single_bit(static_cast<unsigned>(_ringCapacity)))
+            throw invalid_argument("The ring capacity must be a power of 2.");
+        const Header header = {Magic, Version, sizeof(TraceRecord)};
+        _stream.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+        if (!_stream) throw runtime_error(format("Cannot write the trace log \"{}\".", _path.string()));
+
+        _writer = jthread([this](stop_token stopToken) {
+            while (!stopToken.stop_requested()) {
+                unique_lock lock(_wakeMutex);
+                _wakeCondition.wait_for(lock, stopToken, _flushInterval, [&] {
+                    return _isWakeRequested.exchange(false);
+                });
+                lock.unlock();
+                const lock_guard writeLock(_writeMutex);
+                WriteChunk();
+            }
+        });
+    }
+
+    Tracer(const Tracer &) = delete;
+    Tracer &operator=(const Tracer &) = delete;
+
+    /// Writes all buffered records and closes the trace log.
+    /// No thread may trace to the tracer once its destruction has begun.
+    ~Tracer() {
+        _writer.request_stop();
+        _writer.join();
+        const lock_guard lock(_writeMutex);
+        WriteChunk();
+    }
+
+    /// Traces a value on a channel in the session and segment of the calling thread.
+    /// The call does nothing on threads outside trace scopes, and never blocks otherwise.
+    /// @param channel The channel.
+    /// @param value The value.
+    static void Emit(const TraceChannel &channel, double value) {
+        auto &context = CurrentTraceContext;
+        if (context.Tracer) context.Tracer->Push(context, channel.ID(), value);
+    }
+
+    /// Writes all buffered records to the trace log.
+    void Flush() {
+        const lock_guard lock(_writeMutex);
+        WriteChunk();
+        _stream.flush();
+        if (!_stream) throw runtime_error(format("Cannot write the trace log \"{}\".", _path.string()));
+    }
+
+    /// Returns the number of records that have been written.
+    /// @returns The number of records that have been written.
+    [[nodiscard]] int64_t RecordCount() const {
+        return _recordCount;
+    }
+
+    /// Returns the number of records that have been dropped.
+    /// @returns The number of records that have been dropped.
+    [[nodiscard]] int64_t DroppedCount() const {
+        const lock_guard lock(_ringMutex);
+        return ranges::fold_left(_rings | views::values | views::transform([](const auto &ring) {
+            return ring->DroppedCount.load(memory_order_relaxed);
+        }), int64_t{0}, plus());
+    }
+
+    /// Reads a trace log.
+    /// @param path The path of the trace log.
+    /// @returns The content of the trace log.
+    [[nodiscard]] static TraceLog Read(const filesystem::path &path) {
+        ifstream stream(path, ios::binary);
+        Header header;
+        if (!stream.read(reinterpret_cast<char *>(&header), sizeof(Header))
+            || header.Magic != Magic || header.Version != Version || header.RecordSize != sizeof(TraceRecord))
+            throw runtime_error(format("Invalid trace log \"{}\".", path.string()));
+
+        TraceLog log = {};
+        ChunkHeader chunkHeader;
+        while (stream.read(reinterpret_cast<char *>(&chunkHeader), sizeof(ChunkHeader))) {
+            for (auto i = 0; i < chunkHeader.ChannelCount; ++i) {
+                uint32_t length;
+                stream.read(reinterpret_cast<char *>(&length), sizeof(length));
+                auto &name = log.ChannelNames.emplace_back(length, '\0');
+                stream.read(name.data(), length);
+            }
+            const auto recordCount = log.Records.size();
+            log.Records.resize(recordCount + chunkHeader.RecordCount);
+            stream.read(reinterpret_cast<char *>(log.Records.data() + recordCount),
+                        chunkHeader.RecordCount * sizeof(TraceRecord));
+            if (!stream) throw runtime_error(format("Invalid trace log \"{}\".", path.string()));
+            log.DroppedCount = chunkHeader.DroppedCount;
+        }
+        return log;
+    }
+
+private:
+    void Push(TraceContext &context, uint32_t channelID, double value) {
+        if (context.RingTracerID != _id) context.Ring = &ThreadRing(), context.RingTracerID = _id;
+        const TraceRecord record = {context.SessionID, context.SegmentID, channelID, static_cast<float>(value)};
+        // Wakes the writer early once a ring is half full, which is rare enough not to cost the producer.
+        if (context.Ring->Push(record) == static_cast<size_t>(_ringCapacity / 2)) {
+            _isWakeRequested = true;
+            _wakeCondition.notify_one();
+        }
+    }
+
+    [[nodiscard]] TraceRing &ThreadRing() {
+        const lock_guard lock(_ringMutex);
+        auto &ring = _rings[this_thread::get_id()];
+        if (!ring) ring = make_unique<TraceRing>(_ringCapacity);
+        return *ring;
+    }
+
+    // Drains all rings before reading channel names, so that every drained record refers to a written channel.
+    void WriteChunk() {
+        _chunkRecords.clear();
+        auto droppedCount = int64_t{0};
+        {
+            const lock_guard lock(_ringMutex);
+            for (const auto &ring : _rings | views::values) {
+                ring->DrainTo(_chunkRecords);
+                droppedCount += ring->DroppedCount.load(memory_order_relaxed);
+            }
+        }
+        const auto channelNames = TraceChannel::Names(_channelCount);
+        if (_chunkRecords.empty() && channelNames.empty() && droppedCount == _droppedCount) return;
+
+        const ChunkHeader header = {
+            static_cast<uint32_t>(channelNames.size()), static_cast<uint32_t>(_chunkRecords.size()), droppedCount
+        };
+        _stream.write(reinterpret_cast<const char *>(&header), sizeof(ChunkHeader));
+        for (const auto &name : channelNames) {
+            const auto length = static_cast<uint32_t>(name.size());
+            _stream.write(reinterpret_cast<const char *>(&length), sizeof(length));
+            _stream.write(name.data(), length);
+        }
+        _stream.write(reinterpret_cast<const char *>(_chunkRecords.data()), _chunkRecords.size() * sizeof(TraceRecord));
+        _channelCount += channelNames.size(), _droppedCount = droppedCount;
+        _recordCount += static_cast<int64_t>(_chunkRecords.size());
+    }
+};
+
+/// Directs the values traced on the calling thread to a tracer on behalf of a session.
+/// Scopes nest, and the enclosing scope is restored when a scope ends.
+export class TraceScope {
+    TraceContext _prevContext;
+
+public:
+    /// Enters a trace scope.
+    /// @param tracer The tracer (null for no tracing in the scope).
+    /// @param sessionID The ID of the session.
+    TraceScope(Tracer *tracer, uint32_t sessionID) : _prevContext(CurrentTraceContext) {
+        CurrentTraceContext.Tracer = tracer;
+        CurrentTraceContext.SessionID = sessionID;
+        CurrentTraceContext.SegmentID = 0;
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+    ~TraceScope() {
+        CurrentTraceContext.Tracer = _prevContext.Tracer;
+        CurrentTraceContext.SessionID = _prevContext.SessionID;
+        CurrentTraceContext.SegmentID = _prevContext.SegmentID;
+    }
+
+    /// Sets the segment of the values traced on the calling thread.
+    /// @param segmentID The ID of the segment being downloaded.
+    static void SetSegmentID(uint32_t segmentID) {
+        CurrentTraceContext.SegmentID = segmentID;
+    }
+};
@@ -30,9 +30,11 @@ public:
         const auto segmentCount = Math::Round(viewportSeries.DurationSeconds() / segmentSeconds);
         const auto viewportPredictor = ViewportPredictorFactory::Create(intervalSeconds, predictorOptions);
 
+        vector<SphericalPosition> positionBuffer;
         for (auto i = 0; i < segmentCount - 1; ++i) {
             viewportPredictor->Update(viewportSeries.Window(i * segmentSeconds, segmentSeconds).Values);
-            const auto predictedPositions = viewportPredictor->PredictPositions(0., windowLength * segmentSeconds);
+            const auto predictedPositions =
+                viewportPredictor->PredictPositions(0., windowLength * segmentSeconds, positionBuffer);
             for (auto k = 0; k < windowLength; ++k)
                 if (const auto j = i + k - windowLength + 1; j >= 0 && j < segmentCount - windowLength)
                     copy_n(&predictedPositions[k * segmentLength], segmentLength, &out[k, j * segmentLength]);
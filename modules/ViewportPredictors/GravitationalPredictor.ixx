@@ -11,6 +11,7 @@ import System.MDArray;
 
 import ABRSimulation360.Base;
 import ABRSimulation360.ViewportPredictors.IViewportPredictor;
+import ABRSimulation360.ViewportPredictors.ModelStore;
 
 using namespace std;
 using namespace experimental;
@@ -34,32 +35,50 @@ export {
 
 /// A gravitational predictor predicts viewport positions by simulating the kinematics between a viewport and viewport clusters.
 export class GravitationalPredictor : public BaseViewportPredictor {
+    // Immutable cluster data shared by all predictors loaded from the same file.
+    // Cluster centers are stored as separate arrays of pitch and yaw angles,
+    // so that clusters can be processed in vector lanes.
+    struct ClusterData {
+        mdarray<double, dims<2>> ClusterPitchesDegrees;
+        mdarray<double, dims<2>> ClusterYawsDegrees;
+        mdarray<double, dims<2>> ClusterWeights;
+    };
+
     double _smoothingWeight;
     double _gravitationalSpeed;
     double _gravitationalFieldRangeDegrees;
-    mdarray<SphericalPosition, dims<2>> _clusterCenters;
-    mdarray<double, dims<2>> _clusterWeights;
+    shared_ptr<const ClusterData> _clusterData;
 
     int _time = 0;
     SphericalPosition _prevPosition = {};
     double _pitchVelocity = 0., _yawVelocity = 0.;
+    mutable vector<double> _pitchVelocities, _yawVelocities;
 
 public:
+    /// A view of cluster centers indexed by time step, cluster, and angle (pitch and yaw in degrees).
+    using ClusterCentersView = mdspan<const double, extents<size_t, dynamic_extent, dynamic_extent, 2>>;
+
     /// Creates a gravitational predictor with the specified configuration and options.
     /// @param intervalSeconds The interval between two samples in seconds.
     /// @param options The options for the gravitational predictor.
     explicit GravitationalPredictor(double intervalSeconds, const GravitationalPredictorOptions &options = {}) :
-        BaseViewportPredictor(intervalSeconds, options),
-        _smoothingWeight(pow(0.5, intervalSeconds / options.SmoothingHalfLifeSeconds)),
-        _gravitationalSpeed(options.GravitationalSpeedDps * intervalSeconds),
-        _gravitationalFieldRangeDegrees(options.GravitationalFieldRangeDegrees) {
-        LLU::InWXFStream stream(options.ClusterDataPath);
-        mdarray<double, extents<size_t, dynamic_extent, dynamic_extent, 2>> clusterCenters;
-        stream >> clusterCenters >> _clusterWeights;
-        _clusterCenters = mdarray<SphericalPosition, dims<2>>(
-            dims<2>(clusterCenters.extent(0), clusterCenters.extent(1)),
-            vector(reinterpret_cast<const SphericalPosition *>(clusterCenters.data()),
-                   reinterpret_cast<const SphericalPosition *>(clusterCenters.data()) + clusterCenters.size()));
+        GravitationalPredictor(intervalSeconds, options,
+                               ModelStore::Load<ClusterData>(options.ClusterDataPath, LoadClusterData)) {}
+
+    /// Creates a gravitational predictor with the specified configuration, options, and cluster data in memory,
+    /// which is laid out as in cluster data files and takes the place of the cluster data path.
+    /// @param intervalSeconds The interval between two samples in seconds.
+    /// @param clusterCenters The cluster centers at each time step.
+    /// @param clusterWeights A 2D array of cluster weights indexed by time step and cluster.
+    /// @param options The options for the gravitational predictor.
+    GravitationalPredictor(double intervalSeconds, ClusterCentersView clusterCenters,
+                           mdspan<const double, dims<2>> clusterWeights,
+                           const GravitationalPredictorOptions &options = {}) :
+        GravitationalPredictor(intervalSeconds, options,
+                               make_shared<const ClusterData>(CreateClusterData(clusterCenters, clusterWeights))) {}
+
+    [[nodiscard]] unique_ptr<IViewportPredictor> Clone() const override {
+        return make_unique<GravitationalPredictor>(*this);
     }
 
     void Update(span<const SphericalPosition> positions) override {
@@ -69,35 +88,50 @@ public:
         _prevPosition = positions.back();
     }
 
-    [[nodiscard]] vector<SphericalPosition>
-    PredictPositions(double offsetSeconds, double windowSeconds) const override {
+    using BaseViewportPredictor::PredictPositions;
+
+    [[nodiscard]] span<const SphericalPosition>
+    PredictPositions(double offsetSeconds, double windowSeconds, vector<SphericalPosition> &buffer) const override {
         const auto offset = Math::Round(offsetSeconds / _intervalSeconds);
         const auto windowLength = Math::Round(windowSeconds / _intervalSeconds);
-        const auto clusterCount = static_cast<int>(_clusterCenters.extent(1));
+        const auto &[clusterPitchArray, clusterYawArray, clusterWeightArray] = *_clusterData;
+        const auto clusterCount = static_cast<int>(clusterWeightArray.extent(1));
 
         auto position = _prevPosition;
-        vector<SphericalPosition> predictedPositions(windowLength);
+        buffer.resize(windowLength);
+        _pitchVelocities.resize(clusterCount), _yawVelocities.resize(clusterCount);
         for (auto k = 0; k < offset + windowLength; ++k) {
             auto pitchVelocity = _pitchVelocity, yawVelocity = _yawVelocity;
-            if (const auto t = k + _time; t < _clusterCenters.extent(0)) {
-                const span clusterCenters(&_clusterCenters[t, 0], clusterCount);
-                const span clusterWeights(&_clusterWeights[t, 0], clusterCount);
+            if (const auto t = k + _time; t < clusterWeightArray.extent(0)) {
+                const auto clusterPitchesDegrees = &clusterPitchArray[t, 0],
+                           clusterYawsDegrees = &clusterYawArray[t, 0], clusterWeights = &clusterWeightArray[t, 0];
+                // Computes the velocity induced by each cluster in a branch-free loop,
+                // then sums the velocities in the order of clusters.
                 for (auto i = 0; i < clusterCount; ++i) {
-                    const auto pitchDiffDegrees = clusterCenters[i].PitchDegrees - position.PitchDegrees,
+                    const auto pitchDiffDegrees = clusterPitchesDegrees[i] - position.PitchDegrees,
                                yawDiffDegrees = SphericalPosition::YawDifferenceDegrees(
-                                   position.YawDegrees, clusterCenters[i].YawDegrees);
-                    pitchVelocity += GravitationalVelocity(pitchDiffDegrees) * clusterWeights[i];
-                    yawVelocity += GravitationalVelocity(yawDiffDegrees) * clusterWeights[i];
+                                   position.YawDegrees, clusterYawsDegrees[i]);
+                    _pitchVelocities[i] = GravitationalVelocity(pitchDiffDegrees) * clusterWeights[i];
+                    _yawVelocities[i] = GravitationalVelocity(yawDiffDegrees) * clusterWeights[i];
                 }
+                for (auto i = 0; i < clusterCount; ++i)
+                    pitchVelocity += _pitchVelocities[i], yawVelocity += _yawVelocities[i];
             }
             position.PitchDegrees = SphericalPosition::ClampPitchDegrees(position.PitchDegrees + pitchVelocity);
             position.YawDegrees = SphericalPosition::WrapYawDegrees(position.YawDegrees + yawVelocity);
-            if (k >= offset) predictedPositions[k - offset] = position;
+            if (k >= offset) buffer[k - offset] = position;
         }
-        return predictedPositions;
+        return buffer;
     }
 
 private:
+    GravitationalPredictor(double intervalSeconds, const GravitationalPredictorOptions &options,
+                           shared_ptr<const ClusterData> clusterData) :
+        BaseViewportPredictor(intervalSeconds, options),
+        _smoothingWeight(pow(0.5, intervalSeconds / options.SmoothingHalfLifeSeconds)),
+        _gravitationalSpeed(options.GravitationalSpeedDps * intervalSeconds),
+        _gravitationalFieldRangeDegrees(options.GravitationalFieldRangeDegrees), _clusterData(move(clusterData)) {}
+
     void UpdateVelocityEstimates(SphericalPosition prevPosition, SphericalPosition position) {
         const auto pitchVelocity = position.PitchDegrees - prevPosition.PitchDegrees,
                    yawVelocity = SphericalPosition::YawDifferenceDegrees(prevPosition.YawDegrees, position.YawDegrees);
@@ -105,10 +139,35 @@ private:
         _yawVelocity = _smoothingWeight * _yawVelocity + (1 - _smoothingWeight) * yawVelocity;
     }
 
+    // Masks the gravitational speed by the field range without branches.
     [[nodiscard]] double GravitationalVelocity(double diffDegrees) const {
-        auto direction = 0;
-        if (diffDegrees > 0 && diffDegrees <= _gravitationalFieldRangeDegrees) direction = 1;
-        else if (diffDegrees >= -_gravitationalFieldRangeDegrees && diffDegrees < 0) direction = -1;
+        const auto direction =
+            static_cast<double>((diffDegrees > 0) & (diffDegrees <= _gravitationalFieldRangeDegrees))
+            - static_cast<double>((diffDegrees >= -_gravitationalFieldRangeDegrees) & (diffDegrees < 0));
         return _gravitationalSpeed * direction;
     }
+
+    [[nodiscard]] static ClusterData LoadClusterData(const filesystem::path &path) {
+        LLU::InWXFStream stream(path);
+        mdarray<double, extents<size_t, dynamic_extent, dynamic_extent, 2>> clusterCenters;
+        mdarray<double, dims<2>> clusterWeights;
+        stream >> clusterCenters >> clusterWeights;
+        return CreateClusterData(clusterCenters.to_mdspan(), clusterWeights.to_mdspan());
+    }
+
+    [[nodiscard]] static ClusterData CreateClusterData(ClusterCentersView clusterCenters,
+                                                       mdspan<const double, dims<2>> clusterWeights) {
+        ClusterData clusterData;
+        clusterData.ClusterWeights = mdarray<double, dims<2>>(clusterWeights.extents());
+        for (auto t = 0; t < clusterWeights.extent(0); ++t)
+            for (auto i = 0; i < clusterWeights.extent(1); ++i) clusterData.ClusterWeights[t, i] = clusterWeights[t, i];
+        const dims<2> clusterExtents(clusterCenters.extent(0), clusterCenters.extent(1));
+        clusterData.ClusterPitchesDegrees = mdarray<double, dims<2>>(clusterExtents);
+        clusterData.ClusterYawsDegrees = mdarray<double, dims<2>>(clusterExtents);
+        for (auto t = 0; t < clusterExtents.extent(0); ++t)
+            for (auto i = 0; i < clusterExtents.extent(1); ++i)
+                clusterData.ClusterPitchesDegrees[t, i] = clusterCenters[t, i, 0],
+                clusterData.ClusterYawsDegrees[t, i] = clusterCenters[t, i, 1];
+        return clusterData;
+    }
 };
@@ -24,6 +24,11 @@ export class IViewportPredictor {
 public:
     virtual ~IViewportPredictor() = default;
 
+    /// Creates a copy of the viewport predictor including its state.
+    /// Immutable data such as loaded models may be shared between the copies.
+    /// @returns A copy of the viewport predictor.
+    [[nodiscard]] virtual unique_ptr<IViewportPredictor> Clone() const = 0;
+
     /// Updates the viewport predictor with the latest viewport positions.
     /// @param positions A list of viewport positions.
     virtual void Update(span<const SphericalPosition> positions) = 0;
@@ -34,10 +39,32 @@ public:
     /// @returns A list of predicted viewport positions within the specified prediction window.
     [[nodiscard]] virtual vector<SphericalPosition>
     PredictPositions(double offsetSeconds, double windowSeconds) const = 0;
+
+    /// Predicts a list of viewport positions within the specified prediction window without allocating in steady state.
+    /// @param offsetSeconds The offset of the prediction window in seconds.
+    /// @param windowSeconds The length of the prediction window in seconds.
+    /// @param buffer A reusable buffer that may back the returned positions.
+    /// @returns A view of the predicted viewport positions, valid until the next call with the same buffer.
+    [[nodiscard]] virtual span<const SphericalPosition>
+    PredictPositions(double offsetSeconds, double windowSeconds, vector<SphericalPosition> &buffer) const {
+        buffer = PredictPositions(offsetSeconds, windowSeconds);
+        return buffer;
+    }
 };
 
 /// Provides a skeletal implementation of a viewport predictor.
 export class BaseViewportPredictor : public IViewportPredictor {
+public:
+    [[nodiscard]] vector<SphericalPosition>
+    PredictPositions(double offsetSeconds, double windowSeconds) const override {
+        vector<SphericalPosition> buffer;
+        const auto positions = PredictPositions(offsetSeconds, windowSeconds, buffer);
+        return positions.data() == buffer.data() ? move(buffer) : vector(from_range, positions);
+    }
+
+    [[nodiscard]] span<const SphericalPosition>
+    PredictPositions(double offsetSeconds, double windowSeconds, vector<SphericalPosition> &buffer) const override = 0;
+
 protected:
     double _intervalSeconds;
 
@@ -25,9 +25,19 @@ export {
 
 /// A linear predictor predicts viewport positions using linear regression.
 export class LinearPredictor : public BaseViewportPredictor {
+    // Running sums of a regression output over the history, where the newest sample is at time -1.
+    struct RunningSums {
+        double Sum = 0.;
+        double TimeWeightedSum = 0.;
+    };
+
     int _historyLength;
 
-    deque<SphericalPosition> _positions;
+    // The history is a ring buffer of pitch angles and unwrapped yaw angles in degrees.
+    vector<double> _pitchesDegrees, _yawsDegrees;
+    int _count = 0, _nextIndex = 0;
+    double _prevYawDegrees = 0., _yawBiasDegrees = 0.;
+    RunningSums _pitchSums, _yawSums;
 
 public:
     /// Creates a linear predictor with the specified configuration and options.
@@ -35,44 +45,81 @@ public:
     /// @param options The options for the linear predictor.
     explicit LinearPredictor(double intervalSeconds, const LinearPredictorOptions &options = {}) :
         BaseViewportPredictor(intervalSeconds, options),
-        _historyLength(Math::Round(options.HistorySeconds / intervalSeconds)) {
+        _historyLength(Math::Round(options.HistorySeconds / intervalSeconds)),
+        _pitchesDegrees(_historyLength), _yawsDegrees(_historyLength) {
+    }
+
+    [[nodiscard]] unique_ptr<IViewportPredictor> Clone() const override {
+        return make_unique<LinearPredictor>(*this);
     }
 
     void Update(span<const SphericalPosition> positions) override {
-        _positions.append_range(positions);
-        if (_positions.size() > _historyLength) {
-            const auto excessCount = _positions.size() - _historyLength;
-            _positions.erase(_positions.cbegin(), _positions.cbegin() + excessCount);
+        if (_historyLength == 0) return;
+        for (const auto [pitchDegrees, yawDegrees] : positions) {
+            if (_count > 0) {
+                if (yawDegrees > _prevYawDegrees + 180) _yawBiasDegrees -= 360;
+                else if (yawDegrees < _prevYawDegrees - 180) _yawBiasDegrees += 360;
+            }
+            _prevYawDegrees = yawDegrees;
+            Push(_pitchesDegrees, _pitchSums, pitchDegrees);
+            Push(_yawsDegrees, _yawSums, yawDegrees + _yawBiasDegrees);
+            _count = min(_count + 1, _historyLength);
+            // Recomputes the running sums once per pass over the ring buffer to bound the accumulated rounding error.
+            if (++_nextIndex == _historyLength) _nextIndex = 0, Rebase();
         }
     }
 
-    [[nodiscard]] vector<SphericalPosition>
-    PredictPositions(double offsetSeconds, double windowSeconds) const override {
+    using BaseViewportPredictor::PredictPositions;
+
+    [[nodiscard]] span<const SphericalPosition>
+    PredictPositions(double offsetSeconds, double windowSeconds, vector<SphericalPosition> &buffer) const override {
         const auto offset = Math::Round(offsetSeconds / _intervalSeconds);
         const auto windowLength = Math::Round(windowSeconds / _intervalSeconds);
-        const auto times = views::iota(-static_cast<int>(_positions.size()), 0) | ranges::to<vector<double>>();
-        const auto pitchesDegrees = _positions | views::transform(
-            &SphericalPosition::PitchDegrees) | ranges::to<vector>();
-        const auto yawsDegrees = _positions | views::transform(&SphericalPosition::YawDegrees) | ranges::to<vector>();
-
-        const auto [pitch0Degrees, pitchVelocity] = LinearRegression(times, pitchesDegrees);
-        const auto [yaw0Degrees, yawVelocity] = LinearRegression(
-            times, SphericalPosition::UnwrapYawsDegrees(yawsDegrees));
-        return views::iota(0, windowLength) | views::transform([&](int i) {
-            return SphericalPosition{
+
+        const auto [pitch0Degrees, pitchVelocity] = LinearRegression(_pitchSums);
+        const auto [yaw0Degrees, yawVelocity] = LinearRegression(_yawSums);
+        buffer.resize(windowLength);
+        for (auto i = 0; i < windowLength; ++i)
+            buffer[i] = {
                 SphericalPosition::ClampPitchDegrees(pitch0Degrees + pitchVelocity * (i + offset)),
                 SphericalPosition::WrapYawDegrees(yaw0Degrees + yawVelocity * (i + offset))
             };
-        }) | ranges::to<vector>();
+        return buffer;
     }
 
 private:
-    [[nodiscard]] static pair<double, double> LinearRegression(span<const double> inputs, span<const double> outputs) {
-        const auto meanInput = Math::Mean(inputs), meanOutput = Math::Mean(outputs);
-        const auto inputVariance = Math::Variance(inputs, meanInput);
-        const auto covariance = Math::Covariance(inputs, outputs, meanInput, meanOutput);
-        const auto slope = covariance / inputVariance;
-        const auto intercept = meanOutput - slope * meanInput;
+    // Appends a sample to the history, evicting the oldest sample if the history is full.
+    void Push(vector<double> &values, RunningSums &sums, double value) {
+        if (_count == _historyLength) {
+            sums.TimeWeightedSum += _historyLength * values[_nextIndex];
+            sums.Sum -= values[_nextIndex];
+        }
+        // Every existing sample moves one step back in time before the new sample is added at time -1.
+        sums.TimeWeightedSum -= sums.Sum + value;
+        sums.Sum += value;
+        values[_nextIndex] = value;
+    }
+
+    // Recomputes the running sums from the history, shifting unwrapped yaw angles back to the standard range.
+    void Rebase() {
+        for (auto i = 0; i < _count; ++i) _yawsDegrees[i] -= _yawBiasDegrees;
+        _yawBiasDegrees = 0.;
+        _pitchSums = _yawSums = {};
+        for (auto k = 0; k < _count; ++k) {
+            const auto index = (_nextIndex + _historyLength - _count + k) % _historyLength;
+            const auto time = k - _count;
+            _pitchSums.Sum += _pitchesDegrees[index], _pitchSums.TimeWeightedSum += time * _pitchesDegrees[index];
+            _yawSums.Sum += _yawsDegrees[index], _yawSums.TimeWeightedSum += time * _yawsDegrees[index];
+        }
+    }
+
+    // Fits a line to the history, where times are consecutive integers ending at -1, in closed form.
+    [[nodiscard]] pair<double, double> LinearRegression(const RunningSums &sums) const {
+        const auto count = static_cast<double>(_count);
+        const auto meanTime = -(count + 1) / 2, timeSquaredDeviation = count * (count * count - 1) / 12;
+        const auto meanOutput = sums.Sum / count;
+        const auto slope = (sums.TimeWeightedSum - meanTime * sums.Sum) / timeSquaredDeviation;
+        const auto intercept = meanOutput - slope * meanTime;
         return {intercept, slope};
     }
 };
@@ -0,0 +1,64 @@
+export module ABRSimulation360.ViewportPredictors.ModelStore;
+
+import System.Base;
+
+using namespace std;
+
+/// Represents a process-wide store of immutable models loaded from files.
+/// Each model file is loaded once per model type and shared by every predictor that uses it,
+/// and is reloaded only when the file has been modified since it was loaded. The store is thread-safe.
+export class ModelStore {
+    using Key = pair<type_index, filesystem::path>;
+
+    struct Entry {
+        filesystem::file_time_type WriteTime;
+        shared_future<shared_ptr<const void>> Model;
+    };
+
+    inline static mutex _mutex;
+    inline static map<Key, Entry> _entries;
+
+public:
+    /// Gets a model from the store, loading it from its file if necessary.
+    /// Concurrent requests for a model that is being loaded wait for the load instead of loading it again.
+    /// @tparam T The type of the model.
+    /// @param path The path to the model file.
+    /// @param load A function that loads the model from the file.
+    /// @returns A shared handle to the model.
+    template <typename T, typename F>
+    [[nodiscard]] static shared_ptr<const T> Load(const filesystem::path &path, F load) {
+        const Key key = {type_index(typeid(T)), filesystem::weakly_canonical(path)};
+        const auto writeTime = filesystem::last_write_time(key.second);
+
+        promise<shared_ptr<const void>> loading;
+        shared_future<shared_ptr<const void>> model;
+        auto isLoader = false;
+        {
+            lock_guard lock(_mutex);
+            auto &entry = _entries[key];
+            if (!entry.Model.valid() || entry.WriteTime != writeTime) {
+                entry = {writeTime, loading.get_future().share()};
+                isLoader = true;
+            }
+            model = entry.Model;
+        }
+        if (isLoader) {
+            try {
+                loading.set_value(make_shared<const T>(load(key.second)));
+            } catch (...) {
+                // Forgets the failed load so that a later request can retry it.
+                loading.set_exception(current_exception());
+                lock_guard lock(_mutex);
+                if (const auto it = _entries.find(key); it != _entries.cend() && it->second.WriteTime == writeTime)
+                    _entries.erase(it);
+            }
+        }
+        return static_pointer_cast<const T>(model.get());
+    }
+
+    /// Removes all models from the store. Models still in use remain valid until their last handle is released.
+    static void Clear() {
+        lock_guard lock(_mutex);
+        _entries.clear();
+    }
+};
@@ -11,6 +11,7 @@ import System.MDArray;
 
 import ABRSimulation360.Base;
 import ABRSimulation360.ViewportPredictors.IViewportPredictor;
+import ABRSimulation360.ViewportPredictors.ModelStore;
 
 using namespace std;
 using namespace experimental;
@@ -32,73 +33,202 @@ export {
 export class NavGraphPredictor : public BaseViewportPredictor {
     using Node = pair<int, int>;
 
+    // Transition probabilities at a time step as a sparse matrix in compressed sparse row format over node IDs.
+    // Nodes without outgoing transitions stay where they are.
+    struct TransitionMatrix {
+        vector<int> RowOffsets;
+        vector<int> DestinationNodeIDs;
+        vector<double> Probabilities;
+    };
+
+    // An immutable navigation graph shared by all predictors loaded from the same file.
+    struct NavGraph {
+        vector<Node> Nodes;
+        vector<TransitionMatrix> TransitionMatrices;
+
+        [[nodiscard]] int NodeID(Node node) const {
+            return static_cast<int>(ranges::lower_bound(Nodes, node) - Nodes.cbegin());
+        }
+    };
+
     double _binWidthDegrees;
-    vector<map<Node, vector<pair<Node, double>>>> _navGraph;
+    shared_ptr<const NavGraph> _navGraph;
 
     int _time = 0;
     Node _prevNode;
 
+    // Propagation state since the last update, extended lazily and shared by overlapping prediction windows.
+    mutable vector<SphericalPosition> _stepPositions;
+    mutable vector<double> _probabilities, _nextProbabilities;
+    mutable vector<uint8_t> _isReached, _nextIsReached;
+    mutable bool _isPrevNodeIndexed = false;
+
 public:
+    /// A view of the source nodes of a navigation graph indexed by time step, source, and coordinate.
+    using SourceNodesView = mdspan<const int, extents<size_t, dynamic_extent, dynamic_extent, 2>>;
+    /// A view of the destination nodes of a navigation graph indexed by time step, source, destination, and coordinate.
+    using DestinationNodesView = mdspan<const int, extents<size_t, dynamic_extent, dynamic_extent, dynamic_extent, 2>>;
+
     /// Creates a navigation graph predictor with the specified configuration and options.
     /// @param intervalSeconds The interval between two samples in seconds.
     /// @param options The options for the navigation graph predictor.
     explicit NavGraphPredictor(double intervalSeconds, const NavGraphPredictorOptions &options = {}) :
-        BaseViewportPredictor(intervalSeconds, options), _binWidthDegrees(options.BinWidthDegrees) {
-        LLU::InWXFStream stream(options.NavGraphPath);
-        mdarray<int, extents<size_t, dynamic_extent, dynamic_extent, 2>> sourceNodes;
-        mdarray<int, extents<size_t, dynamic_extent, dynamic_extent, dynamic_extent, 2>> destinationNodes;
-        mdarray<double, dims<3>> probabilities;
-        stream >> sourceNodes >> destinationNodes >> probabilities;
+        NavGraphPredictor(intervalSeconds, options, ModelStore::Load<NavGraph>(options.NavGraphPath, LoadNavGraph)) {
+    }
 
-        const auto sourceNodeCount = static_cast<int>(sourceNodes.extent(1)),
-                   destinationNodeCount = static_cast<int>(destinationNodes.extent(2));
-        _navGraph.resize(sourceNodes.extent(0));
-        for (auto t = 0; t < _navGraph.size(); ++t) {
-            for (auto s = 0; s < sourceNodeCount; ++s) {
-                const auto sourceNode = *reinterpret_cast<const Node *>(&sourceNodes[t, s, 0]);
-                vector<pair<Node, double>> destinationNodesWithProbabilities;
-                for (auto d = 0; d < destinationNodeCount; ++d) {
-                    const auto probability = probabilities[t, s, d];
-                    if (probability == 0) break;
-                    const auto destinationNode = *reinterpret_cast<const Node *>(&destinationNodes[t, s, d, 0]);
-                    destinationNodesWithProbabilities.emplace_back(destinationNode, probability);
-                }
-                if (destinationNodesWithProbabilities.empty()) break;
-                _navGraph[t].emplace(sourceNode, move(destinationNodesWithProbabilities));
-            }
-        }
+    /// Creates a navigation graph predictor with the specified configuration, options, and navigation graph in memory,
+    /// which is laid out as in navigation graph files and takes the place of the navigation graph path.
+    /// @param intervalSeconds The interval between two samples in seconds.
+    /// @param sourceNodes The source nodes at each time step.
+    /// @param destinationNodes The destination nodes of each source node.
+    /// @param probabilities A 3D array of transition probabilities indexed by time step, source, and destination,
+    /// where a zero probability ends the destinations of a source and a source without destinations ends the sources.
+    /// @param options The options for the navigation graph predictor.
+    NavGraphPredictor(double intervalSeconds, SourceNodesView sourceNodes, DestinationNodesView destinationNodes,
+                      mdspan<const double, dims<3>> probabilities, const NavGraphPredictorOptions &options = {}) :
+        NavGraphPredictor(intervalSeconds, options,
+                          make_shared<const NavGraph>(CreateNavGraph(sourceNodes, destinationNodes, probabilities))) {
+    }
+
+    [[nodiscard]] unique_ptr<IViewportPredictor> Clone() const override {
+        return make_unique<NavGraphPredictor>(*this);
     }
 
     void Update(span<const SphericalPosition> positions) override {
         _time += static_cast<int>(positions.size());
         const auto [pitchDegrees, yawDegrees] = positions.back();
         _prevNode = {Math::Round(pitchDegrees / _binWidthDegrees), Math::Round(yawDegrees / _binWidthDegrees)};
+        ResetPropagation();
     }
 
-    [[nodiscard]] vector<SphericalPosition>
-    PredictPositions(double offsetSeconds, double windowSeconds) const override {
+    using BaseViewportPredictor::PredictPositions;
+
+    [[nodiscard]] span<const SphericalPosition>
+    PredictPositions(double offsetSeconds, double windowSeconds, vector<SphericalPosition> &buffer) const override {
         const auto offset = Math::Round(offsetSeconds / _intervalSeconds);
         const auto windowLength = Math::Round(windowSeconds / _intervalSeconds);
 
-        map<Node, double> prevDistribution = {{_prevNode, 1.}};
-        vector<SphericalPosition> predictedPositions(windowLength);
-        for (auto k = 0; k < offset + windowLength; ++k) {
-            map<Node, double> distribution;
-            if (const auto t = k + _time; t < _navGraph.size()) {
-                const auto &transitions = _navGraph[t];
-                for (const auto [prevNode, prevProbability] : prevDistribution)
-                    if (const auto it = transitions.find(prevNode); it != transitions.cend())
-                        for (auto [destinationNode, probability] : it->second)
-                            distribution[destinationNode] += probability * prevProbability;
-                    else distribution[prevNode] += prevProbability;
+        while (_stepPositions.size() < offset + windowLength) PropagateStep();
+        buffer.assign_range(span(_stepPositions).subspan(offset, windowLength));
+        return buffer;
+    }
+
+private:
+    NavGraphPredictor(double intervalSeconds, const NavGraphPredictorOptions &options,
+                      shared_ptr<const NavGraph> navGraph) :
+        BaseViewportPredictor(intervalSeconds, options), _binWidthDegrees(options.BinWidthDegrees),
+        _navGraph(move(navGraph)) {
+        ResetPropagation();
+    }
+
+    void ResetPropagation() const {
+        const auto &nodes = _navGraph->Nodes;
+        const auto nodeCount = nodes.size();
+        _stepPositions.clear();
+        _probabilities.assign(nodeCount, 0.), _isReached.assign(nodeCount, 0);
+        _nextProbabilities.resize(nodeCount), _nextIsReached.resize(nodeCount);
+
+        const auto prevNodeID = _navGraph->NodeID(_prevNode);
+        _isPrevNodeIndexed = prevNodeID < nodeCount && nodes[prevNodeID] == _prevNode;
+        if (_isPrevNodeIndexed) _probabilities[prevNodeID] = 1., _isReached[prevNodeID] = 1;
+    }
+
+    void PropagateStep() const {
+        auto &position = _stepPositions.emplace_back();
+        const auto t = static_cast<int>(_stepPositions.size()) - 1 + _time;
+        const auto &[nodes, transitionMatrices] = *_navGraph;
+        if (t >= transitionMatrices.size()) return;
+
+        // A node outside the navigation graph has no transitions, so the distribution stays on it.
+        if (!_isPrevNodeIndexed) {
+            position.PitchDegrees += _prevNode.first * _binWidthDegrees * 1.;
+            position.YawDegrees += _prevNode.second * _binWidthDegrees * 1.;
+            return;
+        }
+
+        const auto &[rowOffsets, destinationNodeIDs, probabilities] = transitionMatrices[t];
+        const auto nodeCount = static_cast<int>(nodes.size());
+        ranges::fill(_nextProbabilities, 0.), ranges::fill(_nextIsReached, 0);
+        for (auto nodeID = 0; nodeID < nodeCount; ++nodeID) {
+            if (!_isReached[nodeID]) continue;
+            const auto prevProbability = _probabilities[nodeID];
+            const auto begin = rowOffsets[nodeID], end = rowOffsets[nodeID + 1];
+            if (begin == end) _nextProbabilities[nodeID] += prevProbability, _nextIsReached[nodeID] = 1;
+            for (auto i = begin; i < end; ++i) {
+                _nextProbabilities[destinationNodeIDs[i]] += probabilities[i] * prevProbability;
+                _nextIsReached[destinationNodeIDs[i]] = 1;
+            }
+        }
+        for (auto nodeID = 0; nodeID < nodeCount; ++nodeID) {
+            if (!_nextIsReached[nodeID]) continue;
+            position.PitchDegrees += nodes[nodeID].first * _binWidthDegrees * _nextProbabilities[nodeID];
+            position.YawDegrees += nodes[nodeID].second * _binWidthDegrees * _nextProbabilities[nodeID];
+        }
+        swap(_probabilities, _nextProbabilities), swap(_isReached, _nextIsReached);
+    }
+
+    [[nodiscard]] static NavGraph LoadNavGraph(const filesystem::path &path) {
+        LLU::InWXFStream stream(path);
+        mdarray<int, extents<size_t, dynamic_extent, dynamic_extent, 2>> sourceNodes;
+        mdarray<int, extents<size_t, dynamic_extent, dynamic_extent, dynamic_extent, 2>> destinationNodes;
+        mdarray<double, dims<3>> probabilities;
+        stream >> sourceNodes >> destinationNodes >> probabilities;
+        return CreateNavGraph(sourceNodes.to_mdspan(), destinationNodes.to_mdspan(), probabilities.to_mdspan());
+    }
+
+    [[nodiscard]] static NavGraph CreateNavGraph(SourceNodesView sourceNodes, DestinationNodesView destinationNodes,
+                                                 mdspan<const double, dims<3>> probabilities) {
+        const auto sourceNodeCount = static_cast<int>(sourceNodes.extent(1)),
+                   destinationNodeCount = static_cast<int>(destinationNodes.extent(2));
+        const auto SourceNode = [&](int t, int s) {
+            return *reinterpret_cast<const Node *>(&sourceNodes[t, s, 0]);
+        };
+        const auto DestinationNode = [&](int t, int s, int d) {
+            return *reinterpret_cast<const Node *>(&destinationNodes[t, s, d, 0]);
+        };
+        // Returns the number of valid sources at a time step, which end at the first source without destinations.
+        const auto SourceCount = [&](int t) {
+            auto s = 0;
+            while (s < sourceNodeCount && probabilities[t, s, 0] != 0) ++s;
+            return s;
+        };
+        const auto DestinationCount = [&](int t, int s) {
+            auto d = 0;
+            while (d < destinationNodeCount && probabilities[t, s, d] != 0) ++d;
+            return d;
+        };
+
+        // Assigns node IDs in the order of nodes so that propagation visits nodes in a deterministic order.
+        NavGraph navGraph;
+        auto &nodes = navGraph.Nodes;
+        const auto timeCount = static_cast<int>(sourceNodes.extent(0));
+        for (auto t = 0; t < timeCount; ++t)
+            for (auto s = 0; s < SourceCount(t); ++s) {
+                nodes.push_back(SourceNode(t, s));
+                for (auto d = 0; d < DestinationCount(t, s); ++d) nodes.push_back(DestinationNode(t, s, d));
+            }
+        ranges::sort(nodes);
+        nodes.erase(ranges::unique(nodes).begin(), nodes.cend());
+        const auto nodeCount = static_cast<int>(nodes.size());
+
+        navGraph.TransitionMatrices.resize(timeCount);
+        vector<int> sourceIndices(nodeCount);
+        for (auto t = 0; t < timeCount; ++t) {
+            // Keeps the first occurrence of each source node.
+            ranges::fill(sourceIndices, -1);
+            for (auto s = SourceCount(t) - 1; s >= 0; --s) sourceIndices[navGraph.NodeID(SourceNode(t, s))] = s;
+
+            auto &matrix = navGraph.TransitionMatrices[t];
+            matrix.RowOffsets.resize(nodeCount + 1);
+            for (auto nodeID = 0; nodeID < nodeCount; ++nodeID) {
+                if (const auto s = sourceIndices[nodeID]; s >= 0)
+                    for (auto d = 0; d < DestinationCount(t, s); ++d) {
+                        matrix.DestinationNodeIDs.push_back(navGraph.NodeID(DestinationNode(t, s, d)));
+                        matrix.Probabilities.push_back(probabilities[t, s, d]);
+                    }
+                matrix.RowOffsets[nodeID + 1] = static_cast<int>(matrix.DestinationNodeIDs.size());
             }
-            if (k >= offset)
-                for (auto [node, probability] : distribution) {
-                    predictedPositions[k - offset].PitchDegrees += node.first * _binWidthDegrees * probability;
-                    predictedPositions[k - offset].YawDegrees += node.second * _binWidthDegrees * probability;
-                }
-            if (!distribution.empty()) prevDistribution = move(distribution);
         }
-        return predictedPositions;
+        return navGraph;
     }
 };
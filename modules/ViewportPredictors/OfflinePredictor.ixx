@@ -7,6 +7,7 @@ export module ABRSimulation360.ViewportPredictors.OfflinePredictor;
 import System.Base;
 
 import ABRSimulation360.Base;
+import ABRSimulation360.Random;
 import ABRSimulation360.ViewportPredictors.IViewportPredictor;
 
 using namespace std;
@@ -23,12 +24,12 @@ export {
 }
 
 /// An offline predictor predicts viewport positions with controlled errors.
+/// Errors are drawn from the random stream of the current random scope, so that predictions are reproducible.
 export class OfflinePredictor : public BaseViewportPredictor {
     ViewportSeriesView _viewportSeries;
     double _randomness;
 
     double _seconds = 0.;
-    mutable default_random_engine _randomEngine{random_device{}()};
 
 public:
     /// Creates an offline predictor with the specified configuration and options.
@@ -39,6 +40,10 @@ public:
         _randomness(options.Randomness) {
     }
 
+    [[nodiscard]] unique_ptr<IViewportPredictor> Clone() const override {
+        return make_unique<OfflinePredictor>(*this);
+    }
+
     /// Initializes the offline predictor with a viewport series.
     /// @param viewportSeries A viewport series.
     void Initialize(ViewportSeriesView viewportSeries) {
@@ -49,20 +54,23 @@ public:
         _seconds += positions.size() * _intervalSeconds;
     }
 
-    [[nodiscard]] vector<SphericalPosition>
-    PredictPositions(double offsetSeconds, double windowSeconds) const override {
+    using BaseViewportPredictor::PredictPositions;
+
+    [[nodiscard]] span<const SphericalPosition>
+    PredictPositions(double offsetSeconds, double windowSeconds, vector<SphericalPosition> &buffer) const override {
         const auto positions = _viewportSeries.Window(_seconds + offsetSeconds, windowSeconds).Values;
-        if (_randomness == 0.) return {from_range, positions};
+        if (_randomness == 0.) return positions;
 
-        const SphericalPosition randomPosition = {
-            uniform_real_distribution(-90., 90.)(_randomEngine),
-            uniform_real_distribution(-180., 180.)(_randomEngine)
-        };
-        return positions | views::transform([&](const SphericalPosition position) {
+        array<double, 2> uniforms;
+        RandomScope::Stream().Uniforms(uniforms);
+        const SphericalPosition randomPosition = {uniforms[0] * 180 - 90, uniforms[1] * 360 - 180};
+        buffer.resize(positions.size());
+        ranges::transform(positions, buffer.begin(), [&](const SphericalPosition position) {
             return SphericalPosition{
                 (1 - _randomness) * position.PitchDegrees + _randomness * randomPosition.PitchDegrees,
                 (1 - _randomness) * position.YawDegrees + _randomness * randomPosition.YawDegrees
             };
-        }) | ranges::to<vector>();
+        });
+        return buffer;
     }
 };
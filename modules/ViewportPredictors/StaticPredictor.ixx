@@ -32,12 +32,20 @@ public:
         BaseViewportPredictor(intervalSeconds, options) {
     }
 
+    [[nodiscard]] unique_ptr<IViewportPredictor> Clone() const override {
+        return make_unique<StaticPredictor>(*this);
+    }
+
     void Update(span<const SphericalPosition> positions) override {
         _prevPosition = positions.back();
     }
 
-    [[nodiscard]] vector<SphericalPosition> PredictPositions(double, double windowSeconds) const override {
+    using BaseViewportPredictor::PredictPositions;
+
+    [[nodiscard]] span<const SphericalPosition>
+    PredictPositions(double, double windowSeconds, vector<SphericalPosition> &buffer) const override {
         const auto windowLength = Math::Round(windowSeconds / _intervalSeconds);
-        return {static_cast<size_t>(windowLength), _prevPosition};
+        buffer.assign(windowLength, _prevPosition);
+        return buffer;
     }
 };
@@ -1,95 +1,154 @@
 module;
 
-#pragma warning(disable: 4275)
+// Kernels for wider instruction sets are compiled on x86-64 regardless of the build flags
+// and selected at run time by the instruction sets that the processor supports.
+#if defined(__x86_64__) || defined(_M_X64)
+#define ABRSIM_X86_64
+#include <immintrin.h>
+#endif
 
-#define XMGLOBALCONST inline const
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define ABRSIM_TARGET(isa)
+#else
+#define ABRSIM_TARGET(isa) __attribute__((target(isa)))
+#endif
 
-#include <directxtk12/SimpleMath.h>
+#include <System/Macros.h>
 
 export module ABRSimulation360.ViewportSimulator;
 
 import System.Base;
 import System.Math;
-import System.MDArray;
 
 import ABRSimulation360.Base;
 
 using namespace std;
-using namespace experimental;
-using namespace DirectX;
-using namespace SimpleMath;
+
+/// Represents the options for a viewport simulator.
+export struct ViewportSimulatorOptions {
+    /// The resolution of precomputed tile visibilities in degrees (0 for exact computation).
+    double GridDegrees = 0.;
+    /// Whether to blend neighboring grid points instead of falling back to exact computation near visibility changes.
+    bool Interpolates = false;
+};
+
+export {
+    DESCRIBE_STRUCT(ViewportSimulatorOptions, (), (
+                        GridDegrees,
+                        Interpolates
+                    ))
+}
+
+/// Represents a kernel that tests tile corners against a viewport frustum.
+export enum class VisibilityKernel {
+    Scalar, ///< A scalar loop over corners.
+    AVX2, ///< A loop over 8 corners at a time with AVX2 instructions.
+    AVX512 ///< A loop over 16 corners at a time with AVX-512 instructions.
+};
 
 /// Simulates the field of view of a viewport.
 export class ViewportSimulator {
-    using Extents = extents<size_t, 6, dynamic_extent, dynamic_extent>;
+    // Tile visibilities on a pitch-yaw grid, packed into one bitset per grid point.
+    struct VisibilityGrid {
+        int PitchCount, YawCount;
+        double PitchStepDegrees, YawStepDegrees;
+        int WordCount;
+        vector<uint64_t> Words;
 
-    BoundingFrustum _frustum;
-    int _tilingCount;
-    mdarray<Vector3, Extents> _tileCorners;
+        [[nodiscard]] span<uint64_t> operator[](int pitchID, int yawID) {
+            const auto offset = (static_cast<size_t>(pitchID) * YawCount + yawID) * WordCount;
+            return {&Words[offset], static_cast<size_t>(WordCount)};
+        }
+
+        [[nodiscard]] span<const uint64_t> operator[](int pitchID, int yawID) const {
+            return const_cast<VisibilityGrid &>(*this)[pitchID, yawID];
+        }
+    };
+
+    // The axes of a viewport in world space.
+    struct ViewAxes {
+        float RightX, RightZ;
+        float UpX, UpY, UpZ;
+        float ForwardX, ForwardY, ForwardZ;
+    };
+
+    static constexpr auto LaneCount = 16;
+    static constexpr auto NearDistance = 0.01f;
+
+    float _sinHalfHeight, _cosHalfHeight;
+    float _sinHalfWidth, _cosHalfWidth;
+    int _tilingCount, _implTilingCount;
+    vector<float> _cornerXs, _cornerYs, _cornerZs;
+    vector<uint8_t> _cornerVisibilities;
+    vector<uint8_t> _implTileVisibilities;
+    vector<uint8_t> _tileVisibilities;
+    vector<float> _sinPitches, _cosPitches, _sinYaws, _cosYaws;
+    vector<double> _tileWeights;
+    vector<int> _sparseTileIDs;
+    vector<double> _sparseWeights;
+
+    VisibilityKernel _kernel = SupportedKernel();
+    bool _interpolates = false;
+    shared_ptr<const VisibilityGrid> _grid;
+    int64_t _frustumTestCount = 0;
 
 public:
     /// Creates a viewport simulator with the specified configuration.
     /// @param config The viewport configuration.
     /// @param tilingCount The number of tiles in each direction on a cubemap face.
-    ViewportSimulator(ViewportConfig config, int tilingCount) : _tilingCount(tilingCount) {
-        const auto fovRadians = XMConvertToRadians(static_cast<float>(config.FoVDegrees));
-        const auto aspectRatio = static_cast<float>(config.AspectRatio);
-        const auto projection = XMMatrixPerspectiveFovLH(fovRadians, aspectRatio, 0.01f, 1000.f);
-        BoundingFrustum::CreateFromMatrix(_frustum, projection);
-
-        const auto implTilingCount = max(_tilingCount, 2);
-        const auto tileWidth = 1 / static_cast<float>(implTilingCount);
-        _tileCorners = mdarray<Vector3, Extents>(implTilingCount + 1, implTilingCount + 1);
-        for (const auto sign : {-1, 1}) {
-            const auto tileCorners = submdspan(_tileCorners.to_mdspan(), sign == -1 ? 0 : 1, full_extent, full_extent);
-            for (auto x = 0; x <= implTilingCount; ++x)
-                for (auto y = 0; y <= implTilingCount; ++y)
-                    tileCorners[x, y] = {sign * 0.5f, -0.5f + y * tileWidth, sign * (0.5f - x * tileWidth)};
-        }
-        for (const auto sign : {-1, 1}) {
-            const auto tileCorners = submdspan(_tileCorners.to_mdspan(), sign == -1 ? 2 : 3, full_extent, full_extent);
-            for (auto x = 0; x <= implTilingCount; ++x)
-                for (auto y = 0; y <= implTilingCount; ++y)
-                    tileCorners[x, y] = {-0.5f + x * tileWidth, sign * 0.5f, sign * (0.5f - y * tileWidth)};
-        }
-        for (const auto sign : {-1, 1}) {
-            const auto tileCorners = submdspan(_tileCorners.to_mdspan(), sign == -1 ? 4 : 5, full_extent, full_extent);
-            for (auto x = 0; x <= implTilingCount; ++x)
-                for (auto y = 0; y <= implTilingCount; ++y)
-                    tileCorners[x, y] = {-sign * (0.5f - x * tileWidth), -0.5f + y * tileWidth, sign * 0.5f};
-        }
+    /// @param options The options for the viewport simulator.
+    ViewportSimulator(ViewportConfig config, int tilingCount, const ViewportSimulatorOptions &options = {}) :
+        _tilingCount(tilingCount), _implTilingCount(max(tilingCount, 2)), _interpolates(options.Interpolates) {
+        // Each side plane of the frustum is represented by the sine and cosine of its half angle,
+        // which stays well-defined as the field of view approaches 180°.
+        const auto halfHeightRadians = config.FoVDegrees / 2 * numbers::pi / 180;
+        const auto halfWidthRadians = atan2(sin(halfHeightRadians) * config.AspectRatio, cos(halfHeightRadians));
+        _sinHalfHeight = static_cast<float>(sin(halfHeightRadians));
+        _cosHalfHeight = static_cast<float>(cos(halfHeightRadians));
+        _sinHalfWidth = static_cast<float>(sin(halfWidthRadians));
+        _cosHalfWidth = static_cast<float>(cos(halfWidthRadians));
+
+        // Tile corners are stored as a struct of arrays in (face, x, y) order, padded to a whole number of lanes.
+        // Padding corners lie at the origin and are never visible.
+        const auto cornerCountPerSide = _implTilingCount + 1;
+        const auto cornerCount = 6 * cornerCountPerSide * cornerCountPerSide;
+        const auto paddedCornerCount = (cornerCount + LaneCount - 1) / LaneCount * LaneCount;
+        _cornerXs.reserve(paddedCornerCount), _cornerYs.reserve(paddedCornerCount);
+        _cornerZs.reserve(paddedCornerCount);
+        const auto AddCorner = [&](float x, float y, float z) {
+            _cornerXs.push_back(x), _cornerYs.push_back(y), _cornerZs.push_back(z);
+        };
+        const auto tileWidth = 1 / static_cast<float>(_implTilingCount);
+        for (const auto sign : {-1, 1})
+            for (auto x = 0; x <= _implTilingCount; ++x)
+                for (auto y = 0; y <= _implTilingCount; ++y)
+                    AddCorner(sign * 0.5f, -0.5f + y * tileWidth, sign * (0.5f - x * tileWidth));
+        for (const auto sign : {-1, 1})
+            for (auto x = 0; x <= _implTilingCount; ++x)
+                for (auto y = 0; y <= _implTilingCount; ++y)
+                    AddCorner(-0.5f + x * tileWidth, sign * 0.5f, sign * (0.5f - y * tileWidth));
+        for (const auto sign : {-1, 1})
+            for (auto x = 0; x <= _implTilingCount; ++x)
+                for (auto y = 0; y <= _implTilingCount; ++y)
+                    AddCorner(-sign * (0.5f - x * tileWidth), -0.5f + y * tileWidth, sign * 0.5f);
+        _cornerXs.resize(paddedCornerCount), _cornerYs.resize(paddedCornerCount), _cornerZs.resize(paddedCornerCount);
+
+        _cornerVisibilities.resize(paddedCornerCount);
+        _implTileVisibilities.resize(6 * _implTilingCount * _implTilingCount);
+        _tileVisibilities.resize(6 * _tilingCount * _tilingCount);
+
+        if (options.GridDegrees > 0.) _grid = SharedGrid(config, tilingCount, options.GridDegrees);
     }
 
     /// Converts a viewport position to viewport distribution.
     /// @param position A viewport position.
     /// @returns The viewport distribution corresponding to the viewport position.
     [[nodiscard]] vector<double> ToDistribution(SphericalPosition position) {
-        const auto yawRadians = XMConvertToRadians(static_cast<float>(position.YawDegrees)),
-                   pitchRadians = XMConvertToRadians(static_cast<float>(position.PitchDegrees));
-        _frustum.Orientation = Quaternion::CreateFromYawPitchRoll(yawRadians, pitchRadians, 0.f);
-
-        mdarray<bool, Extents> cornerVisibilities(_tileCorners.extents());
-        ranges::transform(_tileCorners.container(), cornerVisibilities.container().begin(),
-                          [&](const Vector3 &corner) { return _frustum.Contains(corner) == CONTAINS; });
-
-        const auto implTilingCount = max(_tilingCount, 2);
-        mdarray<bool, Extents> tileVisibilities(implTilingCount, implTilingCount);
-        for (auto faceID = 0; faceID < 6; ++faceID)
-            for (auto x = 0; x < implTilingCount; ++x)
-                for (auto y = 0; y < implTilingCount; ++y)
-                    tileVisibilities[faceID, x, y] =
-                        cornerVisibilities[faceID, x, y] || cornerVisibilities[faceID, x, y + 1]
-                        || cornerVisibilities[faceID, x + 1, y] || cornerVisibilities[faceID, x + 1, y + 1];
-
-        vector distribution(6 * _tilingCount * _tilingCount, 0.);
-        if (_tilingCount > 1)
-            ranges::transform(tileVisibilities.container(), distribution.begin(),
-                              [](bool isVisible) { return static_cast<double>(isVisible); });
-        else
-            for (auto faceID = 0; faceID < 6; ++faceID)
-                distribution[faceID] = tileVisibilities[faceID, 0, 0] || tileVisibilities[faceID, 0, 1]
-                    || tileVisibilities[faceID, 1, 0] || tileVisibilities[faceID, 1, 1];
-        distribution /= Math::Total(distribution);
+        vector distribution(_tileVisibilities.size(), 0.);
+        const auto Accumulate = [&](int tileID, double probability) { distribution[tileID] += probability; };
+        if (_grid) LookupDistribution<false>(position, Accumulate);
+        else ExactDistribution<false>(span(&position, 1), Accumulate);
         return distribution;
     }
 
@@ -97,9 +156,428 @@ public:
     /// @param positions A list of viewport positions.
     /// @returns The viewport distribution corresponding to the list of viewport positions.
     [[nodiscard]] vector<double> ToDistribution(span<const SphericalPosition> positions) {
-        vector distribution(6 * _tilingCount * _tilingCount, 0.);
-        for (const auto position : positions) distribution += ToDistribution(position);
-        distribution /= static_cast<double>(positions.size());
+        vector<double> distribution(_tileVisibilities.size());
+        ToDistribution(positions, distribution);
         return distribution;
     }
+
+    /// Converts a list of viewport positions to viewport distribution in place.
+    /// @tparam IsCounted Whether the frustum tests are added to the frustum test count.
+    /// @param positions A list of viewport positions.
+    /// @param distribution The output viewport distribution with one entry per tile.
+    template<bool IsCounted = false>
+    void ToDistribution(span<const SphericalPosition> positions, span<double> distribution) {
+        ranges::fill(distribution, 0.);
+        const auto Accumulate = [&](int tileID, double probability) { distribution[tileID] += probability; };
+        if (_grid)
+            for (const auto position : positions) LookupDistribution<IsCounted>(position, Accumulate);
+        else ExactDistribution<IsCounted>(positions, Accumulate);
+        for (auto &probability : distribution) probability /= static_cast<double>(positions.size());
+    }
+
+    /// Converts a list of viewport positions to sparse viewport distribution that lists the visible tiles.
+    /// Probabilities are accumulated in the same order as dense viewport distributions, so that they are identical.
+    /// @tparam IsCounted Whether the frustum tests are added to the frustum test count.
+    /// @param positions A list of viewport positions.
+    /// @returns The sparse viewport distribution, which remains valid until the next sparse conversion.
+    template<bool IsCounted = false>
+    [[nodiscard]] SparseDistributionView ToSparseDistribution(span<const SphericalPosition> positions) {
+        // Tile weights are zero outside conversions, so that only the listed tiles are visited.
+        _tileWeights.resize(_tileVisibilities.size());
+        _sparseTileIDs.clear();
+        const auto Accumulate = [&](int tileID, double probability) {
+            if (_tileWeights[tileID] == 0.) _sparseTileIDs.push_back(tileID);
+            _tileWeights[tileID] += probability;
+        };
+        if (_grid)
+            for (const auto position : positions) LookupDistribution<IsCounted>(position, Accumulate);
+        else ExactDistribution<IsCounted>(positions, Accumulate);
+
+        ranges::sort(_sparseTileIDs);
+        _sparseWeights.resize(_sparseTileIDs.size());
+        for (auto i = 0; i < _sparseTileIDs.size(); ++i) {
+            auto &weight = _tileWeights[_sparseTileIDs[i]];
+            _sparseWeights[i] = weight / static_cast<double>(positions.size());
+            weight = 0.;
+        }
+        return {TileCount(), _sparseTileIDs, _sparseWeights};
+    }
+
+    /// Returns the number of tiles in the viewport distribution.
+    /// @returns The number of tiles in the viewport distribution.
+    [[nodiscard]] int TileCount() const {
+        return static_cast<int>(_tileVisibilities.size());
+    }
+
+    /// Returns the number of viewport positions tested against the viewport frustum by counted conversions.
+    /// @returns The number of viewport positions tested against the viewport frustum by counted conversions.
+    [[nodiscard]] int64_t FrustumTestCount() const {
+        return _frustumTestCount;
+    }
+
+    /// Returns the kernel that tests tile corners against the viewport frustum.
+    /// @returns The kernel that tests tile corners against the viewport frustum.
+    [[nodiscard]] VisibilityKernel Kernel() const {
+        return _kernel;
+    }
+
+    /// Selects the kernel that tests tile corners against the viewport frustum, which defaults to the widest supported one.
+    /// @param kernel A kernel supported by the processor.
+    void SetKernel(VisibilityKernel kernel) {
+        if (!IsSupported(kernel)) throw invalid_argument("The visibility kernel is not supported by the processor.");
+        _kernel = kernel;
+    }
+
+    /// Returns whether the processor and the operating system support a kernel.
+    /// @param kernel A kernel that tests tile corners against a viewport frustum.
+    /// @returns Whether the kernel is supported.
+    [[nodiscard]] static bool IsSupported(VisibilityKernel kernel) {
+        if (kernel == VisibilityKernel::Scalar) return true;
+#if defined(ABRSIM_X86_64) && defined(_MSC_VER) && !defined(__clang__)
+        // AVX-512 additionally requires the operating system to save the opmask and upper ZMM registers.
+        array<int, 4> features, extendedFeatures;
+        __cpuid(features.data(), 1), __cpuidex(extendedFeatures.data(), 7, 0);
+        if (!(features[2] & 1 << 27)) return false;
+        const auto enabledStates = _xgetbv(0);
+        if (kernel == VisibilityKernel::AVX2) return (enabledStates & 0x6) == 0x6 && extendedFeatures[1] & 1 << 5;
+        return (enabledStates & 0xE6) == 0xE6 && extendedFeatures[1] & 1 << 16;
+#elif defined(ABRSIM_X86_64)
+        if (kernel == VisibilityKernel::AVX2) return __builtin_cpu_supports("avx2");
+        return __builtin_cpu_supports("avx512f");
+#else
+        return false;
+#endif
+    }
+
+    /// Returns the widest kernel supported by the processor and the operating system.
+    /// @returns The widest supported kernel.
+    [[nodiscard]] static VisibilityKernel SupportedKernel() {
+        static const auto kernel = IsSupported(VisibilityKernel::AVX512) ? VisibilityKernel::AVX512
+                                   : IsSupported(VisibilityKernel::AVX2) ? VisibilityKernel::AVX2
+                                   : VisibilityKernel::Scalar;
+        return kernel;
+    }
+
+    /// Returns the mean total variation distance between precomputed and exact viewport distributions.
+    /// @param positions A list of viewport positions.
+    /// @returns The mean total variation distance over the list of viewport positions (0 for exact computation).
+    [[nodiscard]] double ApproximationError(span<const SphericalPosition> positions) {
+        if (!_grid || positions.empty()) return 0.;
+        vector approxDistribution(_tileVisibilities.size(), 0.), exactDistribution(_tileVisibilities.size(), 0.);
+        auto totalError = 0.;
+        for (const auto position : positions) {
+            ranges::fill(approxDistribution, 0.), ranges::fill(exactDistribution, 0.);
+            LookupDistribution<false>(position, [&](int tileID, double probability) {
+                approxDistribution[tileID] += probability;
+            });
+            ExactDistribution<false>(span(&position, 1), [&](int tileID, double probability) {
+                exactDistribution[tileID] += probability;
+            });
+            for (auto tileID = 0; tileID < approxDistribution.size(); ++tileID)
+                totalError += Math::Abs(approxDistribution[tileID] - exactDistribution[tileID]) / 2;
+        }
+        return totalError / static_cast<double>(positions.size());
+    }
+
+private:
+    // Accumulates the probabilities of visible tiles through a callable that takes a tile ID and a probability.
+    template<bool IsCounted, typename F>
+    void ExactDistribution(span<const SphericalPosition> positions, F &&accumulate) {
+        // Converts the positions to a struct of arrays so that the trigonometry vectorizes across positions.
+        const auto positionCount = positions.size();
+        if constexpr (IsCounted) _frustumTestCount += static_cast<int64_t>(positionCount);
+        _sinPitches.resize(positionCount), _cosPitches.resize(positionCount);
+        _sinYaws.resize(positionCount), _cosYaws.resize(positionCount);
+        for (auto i = 0; i < positionCount; ++i) {
+            const auto pitchRadians = ToRadians(positions[i].PitchDegrees),
+                       yawRadians = ToRadians(positions[i].YawDegrees);
+            _sinPitches[i] = sin(pitchRadians), _cosPitches[i] = cos(pitchRadians);
+            _sinYaws[i] = sin(yawRadians), _cosYaws[i] = cos(yawRadians);
+        }
+
+        for (auto i = 0; i < positionCount; ++i) {
+            const auto visibleCount = UpdateTileVisibilities(_sinPitches[i], _cosPitches[i], _sinYaws[i], _cosYaws[i]);
+            for (auto tileID = 0; tileID < _tileVisibilities.size(); ++tileID)
+                if (_tileVisibilities[tileID]) accumulate(tileID, 1. / visibleCount);
+        }
+    }
+
+    int UpdateTileVisibilities(float sinPitch, float cosPitch, float sinYaw, float cosYaw) {
+        // The view axes of a viewport rotated by yaw about the y-axis after pitch about the x-axis (left-handed).
+        const ViewAxes axes = {
+            cosYaw, -sinYaw,
+            sinPitch * sinYaw, cosPitch, sinPitch * cosYaw,
+            cosPitch * sinYaw, -sinPitch, cosPitch * cosYaw
+        };
+
+        auto cornerID = size_t{0};
+#if defined(ABRSIM_X86_64)
+        if (_kernel == VisibilityKernel::AVX512) cornerID = UpdateCornerVisibilitiesAVX512(axes);
+        else if (_kernel == VisibilityKernel::AVX2) cornerID = UpdateCornerVisibilitiesAVX2(axes);
+#endif
+        UpdateCornerVisibilities(axes, cornerID);
+
+        const auto cornerCountPerSide = _implTilingCount + 1;
+        const auto CornerVisibility = [&](int faceID, int x, int y) {
+            return _cornerVisibilities[(faceID * cornerCountPerSide + x) * cornerCountPerSide + y];
+        };
+        for (auto faceID = 0; faceID < 6; ++faceID)
+            for (auto x = 0; x < _implTilingCount; ++x)
+                for (auto y = 0; y < _implTilingCount; ++y)
+                    _implTileVisibilities[(faceID * _implTilingCount + x) * _implTilingCount + y] =
+                        CornerVisibility(faceID, x, y) | CornerVisibility(faceID, x, y + 1)
+                        | CornerVisibility(faceID, x + 1, y) | CornerVisibility(faceID, x + 1, y + 1);
+
+        if (_tilingCount > 1) ranges::copy(_implTileVisibilities, _tileVisibilities.begin());
+        else
+            for (auto faceID = 0; faceID < 6; ++faceID)
+                _tileVisibilities[faceID] = _implTileVisibilities[4 * faceID] | _implTileVisibilities[4 * faceID + 1]
+                    | _implTileVisibilities[4 * faceID + 2] | _implTileVisibilities[4 * faceID + 3];
+        return static_cast<int>(ranges::count(_tileVisibilities, 1));
+    }
+
+    // Tests the corners from the specified one onwards against the viewport frustum.
+    void UpdateCornerVisibilities(const ViewAxes &axes, size_t beginCornerID) {
+        for (auto cornerID = beginCornerID; cornerID < _cornerXs.size(); ++cornerID) {
+            const auto x = _cornerXs[cornerID], y = _cornerYs[cornerID], z = _cornerZs[cornerID];
+            const auto viewX = x * axes.RightX + z * axes.RightZ;
+            const auto viewY = x * axes.UpX + y * axes.UpY + z * axes.UpZ;
+            const auto viewZ = x * axes.ForwardX + y * axes.ForwardY + z * axes.ForwardZ;
+            _cornerVisibilities[cornerID] = viewZ >= NearDistance
+                && abs(viewY) * _cosHalfHeight <= viewZ * _sinHalfHeight
+                && abs(viewX) * _cosHalfWidth <= viewZ * _sinHalfWidth;
+        }
+    }
+
+#if defined(ABRSIM_X86_64)
+    // Tests whole vectors of 16 corners against the viewport frustum and returns the number of corners tested.
+    ABRSIM_TARGET("avx512f") size_t UpdateCornerVisibilitiesAVX512(const ViewAxes &axes) {
+        const auto rightX = _mm512_set1_ps(axes.RightX), rightZ = _mm512_set1_ps(axes.RightZ);
+        const auto upX = _mm512_set1_ps(axes.UpX), upY = _mm512_set1_ps(axes.UpY), upZ = _mm512_set1_ps(axes.UpZ);
+        const auto forwardX = _mm512_set1_ps(axes.ForwardX), forwardY = _mm512_set1_ps(axes.ForwardY),
+                   forwardZ = _mm512_set1_ps(axes.ForwardZ);
+        const auto sinHalfHeight = _mm512_set1_ps(_sinHalfHeight), cosHalfHeight = _mm512_set1_ps(_cosHalfHeight);
+        const auto sinHalfWidth = _mm512_set1_ps(_sinHalfWidth), cosHalfWidth = _mm512_set1_ps(_cosHalfWidth);
+        const auto nearDistance = _mm512_set1_ps(NearDistance);
+        const auto cornerCount = _cornerXs.size() / 16 * 16;
+        for (size_t cornerID = 0; cornerID < cornerCount; cornerID += 16) {
+            const auto x = _mm512_loadu_ps(&_cornerXs[cornerID]), y = _mm512_loadu_ps(&_cornerYs[cornerID]),
+                       z = _mm512_loadu_ps(&_cornerZs[cornerID]);
+            const auto viewX = _mm512_add_ps(_mm512_mul_ps(x, rightX), _mm512_mul_ps(z, rightZ));
+            const auto viewY = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(x, upX), _mm512_mul_ps(y, upY)),
+                                             _mm512_mul_ps(z, upZ));
+            const auto viewZ = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(x, forwardX), _mm512_mul_ps(y, forwardY)),
+                                             _mm512_mul_ps(z, forwardZ));
+            const auto visibilities = _mm512_cmp_ps_mask(viewZ, nearDistance, _CMP_GE_OQ)
+                & _mm512_cmp_ps_mask(_mm512_mul_ps(_mm512_abs_ps(viewY), cosHalfHeight),
+                                     _mm512_mul_ps(viewZ, sinHalfHeight), _CMP_LE_OQ)
+                & _mm512_cmp_ps_mask(_mm512_mul_ps(_mm512_abs_ps(viewX), cosHalfWidth),
+                                     _mm512_mul_ps(viewZ, sinHalfWidth), _CMP_LE_OQ);
+            for (auto lane = 0; lane < 16; ++lane) _cornerVisibilities[cornerID + lane] = visibilities >> lane & 1;
+        }
+        return cornerCount;
+    }
+
+    // Tests whole vectors of 8 corners against the viewport frustum and returns the number of corners tested.
+    ABRSIM_TARGET("avx2") size_t UpdateCornerVisibilitiesAVX2(const ViewAxes &axes) {
+        const auto rightX = _mm256_set1_ps(axes.RightX), rightZ = _mm256_set1_ps(axes.RightZ);
+        const auto upX = _mm256_set1_ps(axes.UpX), upY = _mm256_set1_ps(axes.UpY), upZ = _mm256_set1_ps(axes.UpZ);
+        const auto forwardX = _mm256_set1_ps(axes.ForwardX), forwardY = _mm256_set1_ps(axes.ForwardY),
+                   forwardZ = _mm256_set1_ps(axes.ForwardZ);
+        const auto sinHalfHeight = _mm256_set1_ps(_sinHalfHeight), cosHalfHeight = _mm256_set1_ps(_cosHalfHeight);
+        const auto sinHalfWidth = _mm256_set1_ps(_sinHalfWidth), cosHalfWidth = _mm256_set1_ps(_cosHalfWidth);
+        const auto nearDistance = _mm256_set1_ps(NearDistance), signMask = _mm256_set1_ps(-0.f);
+        const auto cornerCount = _cornerXs.size() / 8 * 8;
+        for (size_t cornerID = 0; cornerID < cornerCount; cornerID += 8) {
+            const auto x = _mm256_loadu_ps(&_cornerXs[cornerID]), y = _mm256_loadu_ps(&_cornerYs[cornerID]),
+                       z = _mm256_loadu_ps(&_cornerZs[cornerID]);
+            const auto viewX = _mm256_add_ps(_mm256_mul_ps(x, rightX), _mm256_mul_ps(z, rightZ));
+            const auto viewY = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, upX), _mm256_mul_ps(y, upY)),
+                                             _mm256_mul_ps(z, upZ));
+            const auto viewZ = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, forwardX), _mm256_mul_ps(y, forwardY)),
+                                             _mm256_mul_ps(z, forwardZ));
+            const auto inNear = _mm256_cmp_ps(viewZ, nearDistance, _CMP_GE_OQ);
+            const auto inHeight = _mm256_cmp_ps(_mm256_mul_ps(_mm256_andnot_ps(signMask, viewY), cosHalfHeight),
+                                                _mm256_mul_ps(viewZ, sinHalfHeight), _CMP_LE_OQ);
+            const auto inWidth = _mm256_cmp_ps(_mm256_mul_ps(_mm256_andnot_ps(signMask, viewX), cosHalfWidth),
+                                               _mm256_mul_ps(viewZ, sinHalfWidth), _CMP_LE_OQ);
+            const auto visibilities = _mm256_movemask_ps(_mm256_and_ps(inNear, _mm256_and_ps(inHeight, inWidth)));
+            for (auto lane = 0; lane < 8; ++lane) _cornerVisibilities[cornerID + lane] = visibilities >> lane & 1;
+        }
+        return cornerCount;
+    }
+#endif
+
+    template<bool IsCounted, typename F>
+    void LookupDistribution(SphericalPosition position, F &&accumulate) {
+        const auto &grid = *_grid;
+        const auto pitchIndex = clamp((position.PitchDegrees + 90) / grid.PitchStepDegrees,
+                                      0., static_cast<double>(grid.PitchCount - 1));
+        const auto yawIndex = (SphericalPosition::WrapYawDegrees(position.YawDegrees) + 180) / grid.YawStepDegrees;
+        const auto pitchID0 = min(Math::Floor(pitchIndex), grid.PitchCount - 2), pitchID1 = pitchID0 + 1;
+        const auto yawID0 = Math::Floor(yawIndex) % grid.YawCount, yawID1 = (yawID0 + 1) % grid.YawCount;
+        const array corners = {
+            grid[pitchID0, yawID0], grid[pitchID0, yawID1], grid[pitchID1, yawID0], grid[pitchID1, yawID1]
+        };
+
+        if (!_interpolates) {
+            // Falls back to exact computation when the visibilities differ between surrounding grid points.
+            if (!ranges::all_of(corners, [&](span<const uint64_t> words) { return ranges::equal(words, corners[0]); }))
+                return ExactDistribution<IsCounted>(span(&position, 1), accumulate);
+            return AccumulateDistribution(corners[0], 1., accumulate);
+        }
+
+        const auto pitchWeight = pitchIndex - pitchID0, yawWeight = yawIndex - Math::Floor(yawIndex);
+        AccumulateDistribution(corners[0], (1 - pitchWeight) * (1 - yawWeight), accumulate);
+        AccumulateDistribution(corners[1], (1 - pitchWeight) * yawWeight, accumulate);
+        AccumulateDistribution(corners[2], pitchWeight * (1 - yawWeight), accumulate);
+        AccumulateDistribution(corners[3], pitchWeight * yawWeight, accumulate);
+    }
+
+    [[nodiscard]] static float ToRadians(double degrees) {
+        return static_cast<float>(degrees) * (numbers::pi_v<float> / 180);
+    }
+
+    // Visits only the set bits of the visibilities, so that the cost scales with the number of visible tiles.
+    template<typename F>
+    static void AccumulateDistribution(span<const uint64_t> words, double weight, F &&accumulate) {
+        if (weight == 0.) return;
+        const auto visibleCount = ranges::fold_left(words, 0, [](int count, uint64_t word) {
+            return count + popcount(word);
+        });
+        const auto probability = weight / visibleCount;
+        for (auto wordID = 0; wordID < words.size(); ++wordID)
+            for (auto word = words[wordID]; word != 0; word &= word - 1)
+                accumulate(wordID * 64 + countr_zero(word), probability);
+    }
+
+    [[nodiscard]] static shared_ptr<const VisibilityGrid> SharedGrid(ViewportConfig config, int tilingCount,
+                                                                     double gridDegrees) {
+        static mutex gridsMutex;
+        static map<tuple<double, double, int, double>, shared_ptr<const VisibilityGrid>> grids;
+
+        const lock_guard lock(gridsMutex);
+        auto &grid = grids[{config.FoVDegrees, config.AspectRatio, tilingCount, gridDegrees}];
+        if (!grid) grid = make_shared<const VisibilityGrid>(CreateGrid(config, tilingCount, gridDegrees));
+        return grid;
+    }
+
+    [[nodiscard]] static VisibilityGrid CreateGrid(ViewportConfig config, int tilingCount, double gridDegrees) {
+        VisibilityGrid grid;
+        grid.PitchCount = max(Math::Round(180 / gridDegrees), 1) + 1;
+        grid.YawCount = max(Math::Round(360 / gridDegrees), 1);
+        grid.PitchStepDegrees = 180. / (grid.PitchCount - 1), grid.YawStepDegrees = 360. / grid.YawCount;
+        const auto tileCount = 6 * tilingCount * tilingCount;
+        grid.WordCount = (tileCount + 63) / 64;
+        grid.Words.resize(static_cast<size_t>(grid.PitchCount) * grid.YawCount * grid.WordCount);
+
+        ViewportSimulator simulator(config, tilingCount);
+        for (auto pitchID = 0; pitchID < grid.PitchCount; ++pitchID)
+            for (auto yawID = 0; yawID < grid.YawCount; ++yawID) {
+                const auto pitchRadians = ToRadians(-90 + pitchID * grid.PitchStepDegrees),
+                           yawRadians = ToRadians(-180 + yawID * grid.YawStepDegrees);
+                const auto sinPitch = sin(pitchRadians), cosPitch = cos(pitchRadians);
+                simulator.UpdateTileVisibilities(sinPitch, cosPitch, sin(yawRadians), cos(yawRadians));
+                const auto words = grid[pitchID, yawID];
+                for (auto tileID = 0; tileID < tileCount; ++tileID)
+                    if (simulator._tileVisibilities[tileID]) words[tileID / 64] |= uint64_t{1} << tileID % 64;
+            }
+        return grid;
+    }
+};
+
+/// Simulates viewports dilated towards the full sphere, reusing simulators across dilation factors.
+export class DilatedViewportSimulator {
+    ViewportConfig _config;
+    int _tilingCount;
+    double _dilationStep;
+
+    struct Entry {
+        ViewportSimulator Simulator;
+        vector<double> Distribution;
+        int Version = -1;
+        int64_t LastUse = 0;
+    };
+
+    map<double, Entry> _entries;
+
+    span<const SphericalPosition> _positions;
+    int _version = 0;
+    int _hitCount = 0, _missCount = 0;
+    int64_t _useCount = 0, _frustumTestCount = 0;
+
+public:
+    /// The maximum number of cached simulators, beyond which the least recently used one is evicted.
+    static constexpr auto MaxSimulatorCount = 16;
+
+    /// Creates a dilated viewport simulator with the specified configuration.
+    /// @param config The viewport configuration.
+    /// @param tilingCount The number of tiles in each direction on a cubemap face.
+    /// @param dilationStep The quantization step for dilation factors (0 for no quantization).
+    DilatedViewportSimulator(ViewportConfig config, int tilingCount, double dilationStep = 0.) :
+        _config(config), _tilingCount(tilingCount), _dilationStep(dilationStep) {
+    }
+
+    /// Sets the viewport positions for subsequent dilated viewport distributions.
+    /// @param positions A list of viewport positions, which must outlive subsequent conversions.
+    void SetPositions(span<const SphericalPosition> positions) {
+        _positions = positions;
+        ++_version;
+    }
+
+    /// Converts the current viewport positions to dilated viewport distribution.
+    /// @tparam IsCounted Whether the frustum tests are added to the frustum test count.
+    /// @param dilation The dilation factor.
+    /// @returns The dilated viewport distribution, which remains valid until the viewport positions are set again.
+    template<bool IsCounted = false>
+    [[nodiscard]] span<const double> ToDistribution(double dilation) {
+        dilation = clamp(dilation, 0., 1.);
+        if (_dilationStep > 0.) dilation = min(Math::Round(dilation / _dilationStep) * _dilationStep, 1.);
+
+        auto it = _entries.find(dilation);
+        if (it == _entries.cend()) {
+            // Unquantized dilations rarely repeat, so the cache is bounded to keep memory and forks small.
+            if (_entries.size() >= MaxSimulatorCount)
+                _entries.erase(ranges::min_element(_entries, {}, [](const auto &pair) { return pair.second.LastUse; }));
+            const auto dilatedFoVDegrees = (1 - dilation) * _config.FoVDegrees + dilation * 180;
+            ViewportSimulator simulator({dilatedFoVDegrees, _config.AspectRatio}, _tilingCount);
+            const auto tileCount = simulator.TileCount();
+            it = _entries.emplace(dilation, Entry{move(simulator), vector<double>(tileCount)}).first;
+        }
+
+        // Distributions are invalidated by bumping the version rather than clearing, so steady state never allocates.
+        auto &entry = it->second;
+        entry.LastUse = ++_useCount;
+        if (entry.Version == _version) return ++_hitCount, entry.Distribution;
+        ++_missCount;
+        // Dilated simulators compute exact distributions, which test each position once.
+        entry.Simulator.ToDistribution(_positions, entry.Distribution);
+        if constexpr (IsCounted) _frustumTestCount += ssize(_positions);
+        entry.Version = _version;
+        return entry.Distribution;
+    }
+
+    /// Returns the number of conversions served from memoized distributions.
+    /// @returns The number of conversions served from memoized distributions.
+    [[nodiscard]] int HitCount() const {
+        return _hitCount;
+    }
+
+    /// Returns the number of conversions that required computation.
+    /// @returns The number of conversions that required computation.
+    [[nodiscard]] int MissCount() const {
+        return _missCount;
+    }
+
+    /// Returns the number of viewport positions tested against dilated viewport frustums by counted conversions.
+    /// @returns The number of viewport positions tested against dilated viewport frustums by counted conversions.
+    [[nodiscard]] int64_t FrustumTestCount() const {
+        return _frustumTestCount;
+    }
+
+    /// Returns the number of cached simulators.
+    /// @returns The number of cached simulators.
+    [[nodiscard]] int SimulatorCount() const {
+        return static_cast<int>(_entries.size());
+    }
 };
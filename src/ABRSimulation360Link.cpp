@@ -23,9 +23,13 @@ import ABRSimulation360.BitrateAllocators.HybridAllocator;
 import ABRSimulation360.BitrateAllocators.IBitrateAllocator;
 import ABRSimulation360.BitrateAllocators.OnlineLearningAllocator;
 import ABRSimulation360.BitrateAllocators.ProbDASHAllocator;
+import ABRSimulation360.DistributionCache;
+import ABRSimulation360.Instrumentation;
+import ABRSimulation360.QoE;
 import ABRSimulation360.ThroughputPredictors.EMAPredictor;
 import ABRSimulation360.ThroughputPredictors.IThroughputPredictor;
 import ABRSimulation360.ThroughputPredictors.MovingAveragePredictor;
+import ABRSimulation360.Tracing;
 import ABRSimulation360.ViewportPredictionSimulator;
 import ABRSimulation360.ViewportPredictors.GravitationalPredictor;
 import ABRSimulation360.ViewportPredictors.IViewportPredictor;
@@ -33,6 +37,7 @@ import ABRSimulation360.ViewportPredictors.LinearPredictor;
 import ABRSimulation360.ViewportPredictors.NavGraphPredictor;
 import ABRSimulation360.ViewportPredictors.OfflinePredictor;
 import ABRSimulation360.ViewportPredictors.StaticPredictor;
+import ABRSimulation360.ViewportSimulator;
 
 using namespace std;
 using namespace experimental;
@@ -41,6 +46,58 @@ LLU_GENERATE_TIME_SERIES_VIEW_GETTER(double)
 
 LLU_GENERATE_TIME_SERIES_VIEW_GETTER(SphericalPosition)
 
+// Splits a 2D or 3D array along its last dimension into named 1D or 2D arrays.
+template<int Rank = 3, typename T>
+LLU::DataList<LLU::NodeType::Any> SplitLastDimension(LLU::Tensor<T> &tensor, span<const string_view> names) {
+    const auto values = LLU::ToMDSpan<T, dims<Rank>>(tensor);
+    const auto rowCount = static_cast<int>(values.extent(0));
+    const auto columnCount = Rank == 3 ? static_cast<int>(values.extent(1)) : 1;
+    LLU::DataList<LLU::NodeType::Any> list;
+    for (auto k = 0; k < names.size(); ++k) {
+        if constexpr (Rank == 2) {
+            LLU::Tensor<T> slice(T{}, {rowCount});
+            for (auto i = 0; i < rowCount; ++i) slice[i] = values[i, k];
+            list.push_back(string(names[k]), move(slice));
+        } else {
+            LLU::Tensor<T> slice(T{}, {rowCount, columnCount});
+            const auto _slice = LLU::ToMDSpan<T, dims<2>>(slice);
+            for (auto i = 0; i < rowCount; ++i)
+                for (auto j = 0; j < columnCount; ++j) _slice[i, j] = values[i, j, k];
+            list.push_back(string(names[k]), move(slice));
+        }
+    }
+    return list;
+}
+
+// Appends the usage statistics of the distribution cache and the tracer, if any,
+// flushing the tracer so that its counts cover all traced values.
+void PushStatistics(LLU::DataList<LLU::NodeType::Any> &out, const DistributionCache *distributionCache,
+                    Tracer *tracer) {
+    if (distributionCache) {
+        const auto statistics = distributionCache->Statistics();
+        LLU::DataList<LLU::NodeType::Any> _statistics;
+        _statistics.push_back("LookupCount", statistics.LookupCount);
+        _statistics.push_back("HitCount", statistics.HitCount);
+        _statistics.push_back("MappedBytes", statistics.MappedBytes);
+        out.push_back("DistributionCacheStatistics", move(_statistics));
+    }
+    if (tracer) {
+        tracer->Flush();
+        LLU::DataList<LLU::NodeType::Any> _statistics;
+        _statistics.push_back("RecordCount", tracer->RecordCount());
+        _statistics.push_back("DroppedCount", tracer->DroppedCount());
+        out.push_back("TraceStatistics", move(_statistics));
+    }
+}
+
+// Estimates the errors of precomputed viewport distributions, one per session.
+LLU::Tensor<double> ViewportApproximationErrors(const StreamingConfig &streamingConfig, ViewportDataView viewportData,
+                                                const ViewportSimulatorOptions &simulatorOptions) {
+    LLU::Tensor errors(0., {viewportData.PathCount()});
+    ABRSimulator360::ViewportApproximationErrors(streamingConfig, viewportData, simulatorOptions, errors);
+    return errors;
+}
+
 LLU_GENERATE_ABSTRACT_STRUCT_GETTER(BaseThroughputPredictorOptions, (
                                         EMAPredictorOptions,
                                         MovingAveragePredictorOptions
@@ -114,7 +171,18 @@ int ViewportPredictionSimulate(WolframLibraryData, int64_t argc, MArgument *args
 /// @param viewportData [LibraryDataType[TemporalData, Real]] A collection of viewport series.
 /// @param throughputPredictorOptions ["TypedOptions"] The options for the throughput predictor.
 /// @param viewportPredictorOptions ["TypedOptions"] The options for the viewport predictor.
-/// @returns ["DataStore"] A collection of simulation series.
+/// @param viewportSimulatorOptions ["Object"] The options for the viewport simulator.
+/// @param dilationStep [Real] The quantization step for dilation factors of dilated viewport distributions.
+/// @param distributionCachePath ["UTF8String"] The directory of the persistent distribution cache (empty for no caching).
+/// @param usesNetworkIndex ["Boolean"] Whether to index network series so that downloads take logarithmic time.
+/// @param instrumentation ["Boolean"] Whether to record per-segment stage durations and counters.
+/// @param outputMode ["UTF8String"] The output mode, which is "Full", "Compact", "SegmentSummary", or "SessionSummary".
+/// @param tracePath ["UTF8String"] The path of the trace log for values traced by components (empty for no tracing).
+/// @param seed [Integer] The seed of the random streams drawn by components.
+/// @param replicaCount [Integer] The number of replicas of each session, which draw random numbers of their own (0 for no replicas).
+/// @param laneCount [Integer] The number of sessions simulated in lockstep as lanes of a batch (0 for no batching).
+/// @returns ["DataStore"] A collection of simulation series (stacked over replicas if any) or quality-of-experience summaries,
+/// with the errors of precomputed viewport distributions if any.
 extern "C" __declspec(dllexport)
 int ABRSimulate360(WolframLibraryData, int64_t argc, MArgument *args, MArgument out) {
     return LLU::TryInvoke([&] {
@@ -126,23 +194,301 @@ int ABRSimulate360(WolframLibraryData, int64_t argc, MArgument *args, MArgument
         const auto viewportData = argQueue.Pop<ViewportDataView>();
         const auto throughputPredictorOptions = argQueue.Pop<unique_ptr<BaseThroughputPredictorOptions>>();
         const auto viewportPredictorOptions = argQueue.Pop<unique_ptr<BaseViewportPredictorOptions>>();
+        const auto viewportSimulatorOptions = argQueue.Pop<ViewportSimulatorOptions>();
+        const auto dilationStep = argQueue.Pop<double>();
+        const auto distributionCachePath = argQueue.Pop<string>();
+        const auto usesNetworkIndex = argQueue.Pop<bool>();
+        const auto instrumentation = argQueue.Pop<bool>();
+        const auto outputMode = argQueue.Pop<string>();
+        const auto tracePath = argQueue.Pop<string>();
+        const auto seed = argQueue.Pop<int64_t>();
+        const auto replicaCount = argQueue.Pop<int>();
+        const auto laneCount = argQueue.Pop<int>();
+        if (instrumentation && outputMode != "Full")
+            throw invalid_argument("Instrumentation requires the \"Full\" output mode.");
+        if (replicaCount > 0 && (instrumentation || outputMode != "Full"))
+            throw invalid_argument("Replicas require the \"Full\" output mode without instrumentation.");
+
+        const auto distributionCache = !distributionCachePath.empty()
+                                           ? make_unique<DistributionCache>(distributionCachePath)
+                                           : nullptr;
+        const auto tracer = !tracePath.empty() ? make_unique<Tracer>(tracePath) : nullptr;
+        const auto sessionCount = viewportData.PathCount();
+        const auto segmentCount = Math::Round(viewportData.DurationSeconds() / streamingConfig.SegmentSeconds);
+        const auto tileCount = streamingConfig.TilingCount * streamingConfig.TilingCount * 6;
+        StageHistograms stageHistograms;
+        const ABRSimulation360Options options = {
+            .ThroughputPredictorOptions = *throughputPredictorOptions,
+            .ViewportPredictorOptions = *viewportPredictorOptions,
+            .ViewportSimulatorOptions = viewportSimulatorOptions,
+            .DilationStep = dilationStep,
+            .DistributionCache = distributionCache.get(),
+            .UsesNetworkIndex = usesNetworkIndex,
+            .StageHistograms = instrumentation ? &stageHistograms : nullptr,
+            .Tracer = tracer.get(),
+            .Seed = static_cast<uint64_t>(seed),
+            .LaneCount = laneCount
+        };
+
+        LLU::DataList<LLU::NodeType::Any> _out;
+        if (replicaCount > 0) {
+            LLU::Tensor rebufferingSeconds(0., {replicaCount, sessionCount});
+            LLU::Tensor bufferedBitratesMbps(0., {replicaCount, sessionCount, segmentCount, tileCount});
+            LLU::Tensor distributions(0., {sessionCount, segmentCount, tileCount});
+            LLU::Tensor predictedDistributions(0., {replicaCount, sessionCount, segmentCount - 1, tileCount});
+            LLU::Tensor allocationUs(0., {replicaCount, sessionCount, segmentCount - 1});
+            ABRSimulator360::SimulateReplicas(streamingConfig, *controllerOptions, *allocatorOptions,
+                                              networkData, viewportData,
+                                              SweepDataRef{
+                                                  LLU::ToMDSpan<double, dims<2>>(rebufferingSeconds),
+                                                  LLU::ToMDSpan<double, dims<4>>(bufferedBitratesMbps),
+                                                  LLU::ToMDSpan<double, dims<3>>(distributions),
+                                                  LLU::ToMDSpan<double, dims<4>>(predictedDistributions),
+                                                  LLU::ToMDSpan<double, dims<3>>(allocationUs)
+                                              }, options);
+
+            _out.push_back("RebufferingSeconds", move(rebufferingSeconds));
+            _out.push_back("BufferedBitratesMbps", move(bufferedBitratesMbps));
+            _out.push_back("ViewportDistributions", move(distributions));
+            _out.push_back("PredictedViewportDistributions", move(predictedDistributions));
+            _out.push_back("AllocationUs", move(allocationUs));
+        } else if (outputMode == "Full") {
+            LLU::Tensor rebufferingSeconds(0., {sessionCount});
+            LLU::Tensor bufferedBitratesMbps(0., {sessionCount, segmentCount, tileCount});
+            LLU::Tensor distributions(0., {sessionCount, segmentCount, tileCount});
+            LLU::Tensor predictedDistributions(0., {sessionCount, segmentCount - 1, tileCount});
+            LLU::Tensor allocationUs(0., {sessionCount, segmentCount - 1});
+            const auto instrumentedCount = instrumentation ? sessionCount : 0;
+            LLU::Tensor stageUs(0., {instrumentedCount, segmentCount - 1, SimulationStageCount});
+            LLU::Tensor counters(int64_t{0}, {instrumentedCount, segmentCount - 1, SimulationCounterCount});
+            SimulationDataRef simulationData = {
+                rebufferingSeconds, LLU::ToMDSpan<double, dims<3>>(bufferedBitratesMbps),
+                LLU::ToMDSpan<double, dims<3>>(distributions), LLU::ToMDSpan<double, dims<3>>(predictedDistributions),
+                LLU::ToMDSpan<double, dims<2>>(allocationUs)
+            };
+            if (instrumentation) {
+                simulationData.StageUs = LLU::ToMDSpan<double, dims<3>>(stageUs);
+                simulationData.Counters = LLU::ToMDSpan<int64_t, dims<3>>(counters);
+            }
+            ABRSimulator360::Simulate(streamingConfig, *controllerOptions, *allocatorOptions,
+                                      networkData, viewportData, simulationData, options);
+
+            _out.push_back("RebufferingSeconds", move(rebufferingSeconds));
+            _out.push_back("BufferedBitratesMbps", move(bufferedBitratesMbps));
+            _out.push_back("ViewportDistributions", move(distributions));
+            _out.push_back("PredictedViewportDistributions", move(predictedDistributions));
+            _out.push_back("AllocationUs", move(allocationUs));
+            if (instrumentation) {
+                LLU::Tensor histograms(int64_t{0}, {
+                                           stageHistograms.ThreadCount(), StageHistograms::BucketCount,
+                                           SimulationStageCount
+                                       });
+                stageHistograms.CopyTo(LLU::ToMDSpan<int64_t, dims<3>>(histograms));
+                _out.push_back("StageUs", SplitLastDimension(stageUs, SimulationStageNames));
+                _out.push_back("Counters", SplitLastDimension(counters, SimulationCounterNames));
+                _out.push_back("StageHistograms", SplitLastDimension(histograms, SimulationStageNames));
+            }
+        } else if (outputMode == "Compact") {
+            LLU::Tensor rebufferingSeconds(0., {sessionCount});
+            LLU::NumericArray<uint8_t> bitrateIDs(0, {sessionCount, segmentCount, tileCount});
+            LLU::NumericArray<float> distributions(0.f, {sessionCount, segmentCount, tileCount});
+            LLU::NumericArray<float> predictedDistributions(0.f, {sessionCount, segmentCount - 1, tileCount});
+            LLU::Tensor allocationUs(0., {sessionCount, segmentCount - 1});
+            ABRSimulator360::Simulate(streamingConfig, *controllerOptions, *allocatorOptions,
+                                      networkData, viewportData,
+                                      CompactSimulationDataRef{
+                                          rebufferingSeconds, LLU::ToMDSpan<uint8_t, dims<3>>(bitrateIDs),
+                                          LLU::ToMDSpan<float, dims<3>>(distributions),
+                                          LLU::ToMDSpan<float, dims<3>>(predictedDistributions),
+                                          LLU::ToMDSpan<double, dims<2>>(allocationUs)
+                                      }, options);
+
+            _out.push_back("RebufferingSeconds", move(rebufferingSeconds));
+            _out.push_back("BitrateIDs", move(bitrateIDs));
+            _out.push_back("ViewportDistributions", move(distributions));
+            _out.push_back("PredictedViewportDistributions", move(predictedDistributions));
+            _out.push_back("AllocationUs", move(allocationUs));
+        } else if (outputMode == "SegmentSummary" || outputMode == "SessionSummary") {
+            const auto summarizedCount = outputMode == "SegmentSummary" ? sessionCount : 0;
+            LLU::Tensor sessionQoE(0., {sessionCount, SessionMetricCount});
+            LLU::Tensor segmentQoE(0., {summarizedCount, segmentCount, SegmentMetricCount});
+            SummaryDataRef summaryData = {LLU::ToMDSpan<double, dims<2>>(sessionQoE)};
+            if (summarizedCount > 0) summaryData.SegmentQoE = LLU::ToMDSpan<double, dims<3>>(segmentQoE);
+            ABRSimulator360::Simulate(streamingConfig, *controllerOptions, *allocatorOptions,
+                                      networkData, viewportData, summaryData, options);
+
+            _out.push_back("SessionQoE", SplitLastDimension<2>(sessionQoE, SessionMetricNames));
+            if (summarizedCount > 0) _out.push_back("SegmentQoE", SplitLastDimension(segmentQoE, SegmentMetricNames));
+        } else throw invalid_argument(format("Unknown output mode \"{}\".", outputMode));
+        if (viewportSimulatorOptions.GridDegrees > 0.)
+            _out.push_back("ViewportApproximationErrors",
+                           ViewportApproximationErrors(streamingConfig, viewportData, viewportSimulatorOptions));
+        PushStatistics(_out, distributionCache.get(), tracer.get());
+        argQueue.SetOutput(_out);
+    });
+}
+
+/// Simulates a list of 360° adaptive bitrate streaming configurations on a collection of network series and viewport series.
+/// @param streamingConfig ["Object"] The adaptive bitrate streaming configuration.
+/// @param controllerOptions [{"TypedOptions", 1}] A list of options for the aggregate controller, one per configuration.
+/// @param allocatorOptions [{"TypedOptions", 1}] A list of options for the bitrate allocator, one per configuration.
+/// @param networkData [LibraryDataType[TemporalData, Real]] A collection of network series.
+/// @param viewportData [LibraryDataType[TemporalData, Real]] A collection of viewport series.
+/// @param throughputPredictorOptions ["TypedOptions"] The options for the throughput predictor.
+/// @param viewportPredictorOptions ["TypedOptions"] The options for the viewport predictor.
+/// @param viewportSimulatorOptions ["Object"] The options for the viewport simulator.
+/// @param dilationStep [Real] The quantization step for dilation factors of dilated viewport distributions.
+/// @param distributionCachePath ["UTF8String"] The directory of the persistent distribution cache (empty for no caching).
+/// @param usesNetworkIndex ["Boolean"] Whether to index network series so that downloads take logarithmic time.
+/// @param tracePath ["UTF8String"] The path of the trace log for values traced by components (empty for no tracing).
+/// @param seed [Integer] The seed of the random streams drawn by components.
+/// @returns ["DataStore"] A collection of simulation series stacked over configurations,
+/// with the errors of precomputed viewport distributions if any.
+extern "C" __declspec(dllexport)
+int ABRSimulate360Sweep(WolframLibraryData, int64_t argc, MArgument *args, MArgument out) {
+    return LLU::TryInvoke([&] {
+        LLU::MArgumentQueue argQueue(argc, args, out);
+        const auto streamingConfig = argQueue.Pop<StreamingConfig>();
+        const auto controllerOptions = argQueue.Pop<vector<unique_ptr<BaseAggregateControllerOptions>>>();
+        const auto allocatorOptions = argQueue.Pop<vector<unique_ptr<BaseBitrateAllocatorOptions>>>();
+        const auto networkData = argQueue.Pop<NetworkDataView>();
+        const auto viewportData = argQueue.Pop<ViewportDataView>();
+        const auto throughputPredictorOptions = argQueue.Pop<unique_ptr<BaseThroughputPredictorOptions>>();
+        const auto viewportPredictorOptions = argQueue.Pop<unique_ptr<BaseViewportPredictorOptions>>();
+        const auto viewportSimulatorOptions = argQueue.Pop<ViewportSimulatorOptions>();
+        const auto dilationStep = argQueue.Pop<double>();
+        const auto distributionCachePath = argQueue.Pop<string>();
+        const auto usesNetworkIndex = argQueue.Pop<bool>();
+        const auto tracePath = argQueue.Pop<string>();
+        const auto seed = argQueue.Pop<int64_t>();
+
+        const auto configCount = static_cast<int>(controllerOptions.size());
+        const auto distributionCache = !distributionCachePath.empty()
+                                           ? make_unique<DistributionCache>(distributionCachePath)
+                                           : nullptr;
+        const auto tracer = !tracePath.empty() ? make_unique<Tracer>(tracePath) : nullptr;
+        const auto sessionCount = viewportData.PathCount();
+        const auto segmentCount = Math::Round(viewportData.DurationSeconds() / streamingConfig.SegmentSeconds);
+        const auto tileCount = streamingConfig.TilingCount * streamingConfig.TilingCount * 6;
+        LLU::Tensor rebufferingSeconds(0., {configCount, sessionCount});
+        LLU::Tensor bufferedBitratesMbps(0., {configCount, sessionCount, segmentCount, tileCount});
+        LLU::Tensor distributions(0., {sessionCount, segmentCount, tileCount});
+        LLU::Tensor predictedDistributions(0., {configCount, sessionCount, segmentCount - 1, tileCount});
+        LLU::Tensor allocationUs(0., {configCount, sessionCount, segmentCount - 1});
+        const SweepDataRef sweepData = {
+            LLU::ToMDSpan<double, dims<2>>(rebufferingSeconds), LLU::ToMDSpan<double, dims<4>>(bufferedBitratesMbps),
+            LLU::ToMDSpan<double, dims<3>>(distributions), LLU::ToMDSpan<double, dims<4>>(predictedDistributions),
+            LLU::ToMDSpan<double, dims<3>>(allocationUs)
+        };
+        const auto _controllerOptions = controllerOptions | views::transform([](const auto &options) {
+            return static_cast<const BaseAggregateControllerOptions *>(options.get());
+        }) | ranges::to<vector>();
+        const auto _allocatorOptions = allocatorOptions | views::transform([](const auto &options) {
+            return static_cast<const BaseBitrateAllocatorOptions *>(options.get());
+        }) | ranges::to<vector>();
+        ABRSimulator360::Sweep(streamingConfig, _controllerOptions, _allocatorOptions,
+                               networkData, viewportData, sweepData,
+                               {
+                                   .ThroughputPredictorOptions = *throughputPredictorOptions,
+                                   .ViewportPredictorOptions = *viewportPredictorOptions,
+                                   .ViewportSimulatorOptions = viewportSimulatorOptions,
+                                   .DilationStep = dilationStep,
+                                   .DistributionCache = distributionCache.get(),
+                                   .UsesNetworkIndex = usesNetworkIndex,
+                                   .Tracer = tracer.get(),
+                                   .Seed = static_cast<uint64_t>(seed)
+                               });
+
+        LLU::DataList<LLU::NodeType::Any> _out;
+        _out.push_back("RebufferingSeconds", move(rebufferingSeconds));
+        _out.push_back("BufferedBitratesMbps", move(bufferedBitratesMbps));
+        _out.push_back("ViewportDistributions", move(distributions));
+        _out.push_back("PredictedViewportDistributions", move(predictedDistributions));
+        _out.push_back("AllocationUs", move(allocationUs));
+        if (viewportSimulatorOptions.GridDegrees > 0.)
+            _out.push_back("ViewportApproximationErrors",
+                           ViewportApproximationErrors(streamingConfig, viewportData, viewportSimulatorOptions));
+        PushStatistics(_out, distributionCache.get(), tracer.get());
+        argQueue.SetOutput(_out);
+    });
+}
+
+/// Simulates branches of 360° adaptive bitrate streaming configurations that share a common prefix on a collection of network series and viewport series.
+/// @param streamingConfig ["Object"] The adaptive bitrate streaming configuration.
+/// @param controllerOptions ["TypedOptions"] The options for the aggregate controller of the prefix.
+/// @param allocatorOptions ["TypedOptions"] The options for the bitrate allocator of the prefix.
+/// @param forkSegmentID [Integer] The ID of the first segment downloaded by the branches.
+/// @param branchControllerOptions [{"TypedOptions", 1}] A list of options for the aggregate controller, one per branch.
+/// @param branchAllocatorOptions [{"TypedOptions", 1}] A list of options for the bitrate allocator, one per branch.
+/// @param networkData [LibraryDataType[TemporalData, Real]] A collection of network series.
+/// @param viewportData [LibraryDataType[TemporalData, Real]] A collection of viewport series.
+/// @param throughputPredictorOptions ["TypedOptions"] The options for the throughput predictor.
+/// @param viewportPredictorOptions ["TypedOptions"] The options for the viewport predictor.
+/// @param viewportSimulatorOptions ["Object"] The options for the viewport simulator.
+/// @param dilationStep [Real] The quantization step for dilation factors of dilated viewport distributions.
+/// @param distributionCachePath ["UTF8String"] The directory of the persistent distribution cache (empty for no caching).
+/// @param usesNetworkIndex ["Boolean"] Whether to index network series so that downloads take logarithmic time.
+/// @param tracePath ["UTF8String"] The path of the trace log for values traced by components (empty for no tracing).
+/// @param seed [Integer] The seed of the random streams drawn by components.
+/// @returns ["DataStore"] A collection of simulation series stacked over branches,
+/// with the errors of precomputed viewport distributions if any.
+extern "C" __declspec(dllexport)
+int ABRSimulate360Fork(WolframLibraryData, int64_t argc, MArgument *args, MArgument out) {
+    return LLU::TryInvoke([&] {
+        LLU::MArgumentQueue argQueue(argc, args, out);
+        const auto streamingConfig = argQueue.Pop<StreamingConfig>();
+        const auto controllerOptions = argQueue.Pop<unique_ptr<BaseAggregateControllerOptions>>();
+        const auto allocatorOptions = argQueue.Pop<unique_ptr<BaseBitrateAllocatorOptions>>();
+        const auto forkSegmentID = argQueue.Pop<int>();
+        const auto branchControllerOptions = argQueue.Pop<vector<unique_ptr<BaseAggregateControllerOptions>>>();
+        const auto branchAllocatorOptions = argQueue.Pop<vector<unique_ptr<BaseBitrateAllocatorOptions>>>();
+        const auto networkData = argQueue.Pop<NetworkDataView>();
+        const auto viewportData = argQueue.Pop<ViewportDataView>();
+        const auto throughputPredictorOptions = argQueue.Pop<unique_ptr<BaseThroughputPredictorOptions>>();
+        const auto viewportPredictorOptions = argQueue.Pop<unique_ptr<BaseViewportPredictorOptions>>();
+        const auto viewportSimulatorOptions = argQueue.Pop<ViewportSimulatorOptions>();
+        const auto dilationStep = argQueue.Pop<double>();
+        const auto distributionCachePath = argQueue.Pop<string>();
+        const auto usesNetworkIndex = argQueue.Pop<bool>();
+        const auto tracePath = argQueue.Pop<string>();
+        const auto seed = argQueue.Pop<int64_t>();
 
+        const auto branchCount = static_cast<int>(branchControllerOptions.size());
+        const auto distributionCache = !distributionCachePath.empty()
+                                           ? make_unique<DistributionCache>(distributionCachePath)
+                                           : nullptr;
+        const auto tracer = !tracePath.empty() ? make_unique<Tracer>(tracePath) : nullptr;
         const auto sessionCount = viewportData.PathCount();
         const auto segmentCount = Math::Round(viewportData.DurationSeconds() / streamingConfig.SegmentSeconds);
         const auto tileCount = streamingConfig.TilingCount * streamingConfig.TilingCount * 6;
-        LLU::Tensor rebufferingSeconds(0., {sessionCount});
-        LLU::Tensor bufferedBitratesMbps(0., {sessionCount, segmentCount, tileCount});
+        LLU::Tensor rebufferingSeconds(0., {branchCount, sessionCount});
+        LLU::Tensor bufferedBitratesMbps(0., {branchCount, sessionCount, segmentCount, tileCount});
         LLU::Tensor distributions(0., {sessionCount, segmentCount, tileCount});
-        LLU::Tensor predictedDistributions(0., {sessionCount, segmentCount - 1, tileCount});
-        LLU::Tensor allocationUs(0., {sessionCount, segmentCount - 1});
-        const SimulationDataRef simulationData = {
-            rebufferingSeconds, LLU::ToMDSpan<double, dims<3>>(bufferedBitratesMbps),
-            LLU::ToMDSpan<double, dims<3>>(distributions), LLU::ToMDSpan<double, dims<3>>(predictedDistributions),
-            LLU::ToMDSpan<double, dims<2>>(allocationUs)
+        LLU::Tensor predictedDistributions(0., {branchCount, sessionCount, segmentCount - 1, tileCount});
+        LLU::Tensor allocationUs(0., {branchCount, sessionCount, segmentCount - 1});
+        const SweepDataRef forkData = {
+            LLU::ToMDSpan<double, dims<2>>(rebufferingSeconds), LLU::ToMDSpan<double, dims<4>>(bufferedBitratesMbps),
+            LLU::ToMDSpan<double, dims<3>>(distributions), LLU::ToMDSpan<double, dims<4>>(predictedDistributions),
+            LLU::ToMDSpan<double, dims<3>>(allocationUs)
         };
-        ABRSimulator360::Simulate(streamingConfig, *controllerOptions, *allocatorOptions,
-                                  networkData, viewportData, simulationData,
-                                  {*throughputPredictorOptions, *viewportPredictorOptions});
+        const auto _branchControllerOptions = branchControllerOptions | views::transform([](const auto &options) {
+            return static_cast<const BaseAggregateControllerOptions *>(options.get());
+        }) | ranges::to<vector>();
+        const auto _branchAllocatorOptions = branchAllocatorOptions | views::transform([](const auto &options) {
+            return static_cast<const BaseBitrateAllocatorOptions *>(options.get());
+        }) | ranges::to<vector>();
+        ABRSimulator360::Fork(streamingConfig, *controllerOptions, *allocatorOptions, forkSegmentID,
+                              _branchControllerOptions, _branchAllocatorOptions, networkData, viewportData, forkData,
+                              {
+                                  .ThroughputPredictorOptions = *throughputPredictorOptions,
+                                  .ViewportPredictorOptions = *viewportPredictorOptions,
+                                  .ViewportSimulatorOptions = viewportSimulatorOptions,
+                                  .DilationStep = dilationStep,
+                                  .DistributionCache = distributionCache.get(),
+                                  .UsesNetworkIndex = usesNetworkIndex,
+                                  .Tracer = tracer.get(),
+                                  .Seed = static_cast<uint64_t>(seed)
+                              });
 
         LLU::DataList<LLU::NodeType::Any> _out;
         _out.push_back("RebufferingSeconds", move(rebufferingSeconds));
@@ -150,6 +496,10 @@ int ABRSimulate360(WolframLibraryData, int64_t argc, MArgument *args, MArgument
         _out.push_back("ViewportDistributions", move(distributions));
         _out.push_back("PredictedViewportDistributions", move(predictedDistributions));
         _out.push_back("AllocationUs", move(allocationUs));
+        if (viewportSimulatorOptions.GridDegrees > 0.)
+            _out.push_back("ViewportApproximationErrors",
+                           ViewportApproximationErrors(streamingConfig, viewportData, viewportSimulatorOptions));
+        PushStatistics(_out, distributionCache.get(), tracer.get());
         argQueue.SetOutput(_out);
     });
 }
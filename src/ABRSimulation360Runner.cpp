@@ -0,0 +1,207 @@
+import LibraryLinkUtilities.WXFStream;
+import System.Base;
+import System.JSON;
+import System.MDArray;
+
+import ABRSimulation360.ABRSimulator360;
+import ABRSimulation360.AggregateControllers.IAggregateController;
+import ABRSimulation360.AggregateControllers.ModelPredictiveController;
+import ABRSimulation360.AggregateControllers.ThroughputBasedController;
+import ABRSimulation360.Base;
+import ABRSimulation360.BatchRunner;
+import ABRSimulation360.BitrateAllocators.BOLAAllocator;
+import ABRSimulation360.BitrateAllocators.DragonflyAllocator;
+import ABRSimulation360.BitrateAllocators.FlareAllocator;
+import ABRSimulation360.BitrateAllocators.HybridAllocator;
+import ABRSimulation360.BitrateAllocators.IBitrateAllocator;
+import ABRSimulation360.BitrateAllocators.OnlineLearningAllocator;
+import ABRSimulation360.BitrateAllocators.ProbDASHAllocator;
+import ABRSimulation360.DistributionCache;
+import ABRSimulation360.ThroughputPredictors.EMAPredictor;
+import ABRSimulation360.ThroughputPredictors.IThroughputPredictor;
+import ABRSimulation360.ThroughputPredictors.MovingAveragePredictor;
+import ABRSimulation360.TraceFile;
+import ABRSimulation360.Tracing;
+import ABRSimulation360.ViewportPredictors.GravitationalPredictor;
+import ABRSimulation360.ViewportPredictors.IViewportPredictor;
+import ABRSimulation360.ViewportPredictors.LinearPredictor;
+import ABRSimulation360.ViewportPredictors.NavGraphPredictor;
+import ABRSimulation360.ViewportPredictors.OfflinePredictor;
+import ABRSimulation360.ViewportPredictors.StaticPredictor;
+import ABRSimulation360.ViewportSimulator;
+
+using namespace std;
+using namespace experimental;
+namespace json = boost::json;
+
+constexpr auto Usage = R"(Usage:
+  ABRSimulation360Runner simulate <config.json> <network.trace> <viewport.trace> <results.bin>
+  ABRSimulation360Runner convert (network | viewport) <input.csv | input.wxf> <intervalSeconds> <output.trace>
+
+A configuration is a JSON object with the fields "StreamingConfig", "Controller", and "Allocator",
+and optionally "ThroughputPredictor", "ViewportPredictor", "ViewportSimulator", "DilationStep",
+"DistributionCachePath", "UsesNetworkIndex", "TracePath", "Seed", and "LaneCount". Typed options are given
+as a type name or as an object with a "Type" field and any option fields to override.
+
+A CSV trace has one sample per line, which consists of a series ID followed by a throughput
+in megabits per second (network) or a pitch and yaw angle in degrees (viewport).
+A WXF trace holds a numeric array of series × samples (network) or series × samples × 2 (viewport).
+)";
+
+// Parses options of a concrete type, where absent fields keep their default values.
+template<typename TOptions>
+TOptions ParseOptions(const json::object &object) {
+    auto value = json::value_from(TOptions());
+    auto &fields = value.as_object();
+    for (const auto &[key, field] : object)
+        if (key != "Type") fields[key] = field;
+    return json::value_to<TOptions>(value);
+}
+
+// Parses options given as a type name or as an object with a "Type" field, one type name per options type.
+template<typename TBase, typename... TOptions>
+unique_ptr<TBase> ParseTypedOptions(const json::value &value, const array<string_view, sizeof...(TOptions)> &types) {
+    const auto object = value.is_string() ? json::object{{"Type", value}} : value.as_object();
+    const string_view type = object.at("Type").as_string();
+    unique_ptr<TBase> options;
+    auto typeIndex = 0;
+    const auto TryParse = [&]<typename T>() {
+        if (!options && types[typeIndex++] == type) options = make_unique<T>(ParseOptions<T>(object));
+    };
+    (TryParse.template operator()<TOptions>(), ...);
+    if (!options) throw invalid_argument(format("Unknown options type \"{}\".", type));
+    return options;
+}
+
+int Simulate(const filesystem::path &configPath, const filesystem::path &networkPath,
+             const filesystem::path &viewportPath, const filesystem::path &resultsPath) {
+    ifstream configStream(configPath);
+    if (!configStream) throw runtime_error(format("Cannot read the configuration \"{}\".", configPath.string()));
+    const auto config = json::parse(string(istreambuf_iterator(configStream), {})).as_object();
+    const auto OptionalField = [&](string_view key, json::value defaultValue) {
+        return config.contains(key) ? config.at(key) : defaultValue;
+    };
+
+    const auto streamingConfig = json::value_to<StreamingConfig>(config.at("StreamingConfig"));
+    const auto controllerOptions = ParseTypedOptions<
+        BaseAggregateControllerOptions, ModelPredictiveControllerOptions, ThroughputBasedControllerOptions>(
+        config.at("Controller"), {"ModelPredictiveController", "ThroughputBasedController"});
+    const auto allocatorOptions = ParseTypedOptions<
+        BaseBitrateAllocatorOptions, BOLAAllocatorOptions, DragonflyAllocatorOptions, FlareAllocatorOptions,
+        HybridAllocatorOptions, OnlineLearningAllocatorOptions, ProbDASHAllocatorOptions>(
+        config.at("Allocator"), {
+            "BOLAAllocator", "DragonflyAllocator", "FlareAllocator",
+            "HybridAllocator", "OnlineLearningAllocator", "ProbDASHAllocator"
+        });
+    const auto throughputPredictorOptions = ParseTypedOptions<
+        BaseThroughputPredictorOptions, EMAPredictorOptions, MovingAveragePredictorOptions>(
+        OptionalField("ThroughputPredictor", "EMAPredictor"), {"EMAPredictor", "MovingAveragePredictor"});
+    const auto viewportPredictorOptions = ParseTypedOptions<
+        BaseViewportPredictorOptions, GravitationalPredictorOptions, LinearPredictorOptions,
+        NavGraphPredictorOptions, OfflinePredictorOptions, StaticPredictorOptions>(
+        OptionalField("ViewportPredictor", "StaticPredictor"), {
+            "GravitationalPredictor", "LinearPredictor", "NavGraphPredictor", "OfflinePredictor", "StaticPredictor"
+        });
+    const auto viewportSimulatorOptions = ParseOptions<ViewportSimulatorOptions>(
+        OptionalField("ViewportSimulator", json::object()).as_object());
+    const auto dilationStep = json::value_to<double>(OptionalField("DilationStep", 0.));
+    const auto distributionCachePath = json::value_to<string>(OptionalField("DistributionCachePath", ""));
+    const auto usesNetworkIndex = json::value_to<bool>(OptionalField("UsesNetworkIndex", false));
+    const auto tracePath = json::value_to<string>(OptionalField("TracePath", ""));
+    const auto seed = json::value_to<uint64_t>(OptionalField("Seed", 0));
+    const auto laneCount = json::value_to<int>(OptionalField("LaneCount", 0));
+
+    const auto distributionCache = !distributionCachePath.empty()
+                                       ? make_unique<DistributionCache>(distributionCachePath)
+                                       : nullptr;
+    const auto tracer = !tracePath.empty() ? make_unique<Tracer>(tracePath) : nullptr;
+    const NetworkTraceFile networkTraces(networkPath);
+    const ViewportTraceFile viewportTraces(viewportPath);
+    BatchResultWriter writer(resultsPath, streamingConfig.TilingCount * streamingConfig.TilingCount * 6);
+    BatchRunner::Run(streamingConfig, *controllerOptions, *allocatorOptions, networkTraces, viewportTraces, writer,
+                     {
+                         .ThroughputPredictorOptions = *throughputPredictorOptions,
+                         .ViewportPredictorOptions = *viewportPredictorOptions,
+                         .ViewportSimulatorOptions = viewportSimulatorOptions,
+                         .DilationStep = dilationStep,
+                         .DistributionCache = distributionCache.get(),
+                         .UsesNetworkIndex = usesNetworkIndex,
+                         .Tracer = tracer.get(),
+                         .Seed = seed,
+                         .LaneCount = laneCount
+                     });
+    println("Simulated {} of {} sessions.", writer.RecordCount(), viewportTraces.PathCount());
+    if (tracer) {
+        tracer->Flush();
+        println("Traced {} records ({} dropped).", tracer->RecordCount(), tracer->DroppedCount());
+    }
+    return 0;
+}
+
+// Reads a CSV trace, ordering series by ID and the samples of each series by line.
+template<typename T>
+vector<vector<T>> ReadCSVTrace(const filesystem::path &path) {
+    ifstream stream(path);
+    if (!stream) throw runtime_error(format("Cannot read the trace \"{}\".", path.string()));
+    map<int64_t, vector<T>> paths;
+    string line;
+    while (getline(stream, line)) {
+        if (line.empty()) continue;
+        istringstream fields(line);
+        int64_t pathID;
+        array<double, sizeof(T) / sizeof(double)> components;
+        char separator;
+        fields >> pathID;
+        for (auto &component : components) fields >> separator >> component;
+        if (!fields) throw runtime_error(format("Invalid line in the trace \"{}\": {}", path.string(), line));
+        paths[pathID].push_back(bit_cast<T>(components));
+    }
+    return paths | views::values | ranges::to<vector>();
+}
+
+// Reads a WXF trace, which holds a rectangular numeric array with one row per series.
+template<typename T>
+vector<vector<T>> ReadWXFTrace(const filesystem::path &path) {
+    LLU::InWXFStream stream(path);
+    vector<vector<T>> paths;
+    if constexpr (is_same_v<T, double>) {
+        mdarray<double, dims<2>> values;
+        stream >> values;
+        for (auto i = 0; i < values.extent(0); ++i)
+            paths.emplace_back(from_range, span(&values[i, 0], values.extent(1)));
+    } else {
+        mdarray<double, extents<size_t, dynamic_extent, dynamic_extent, 2>> values;
+        stream >> values;
+        for (auto i = 0; i < values.extent(0); ++i)
+            paths.emplace_back(from_range, span(reinterpret_cast<const T *>(&values[i, 0, 0]), values.extent(1)));
+    }
+    return paths;
+}
+
+template<typename T>
+int Convert(const filesystem::path &inputPath, double intervalSeconds, const filesystem::path &outputPath) {
+    const auto paths = inputPath.extension() == ".wxf" ? ReadWXFTrace<T>(inputPath) : ReadCSVTrace<T>(inputPath);
+    const auto pathViews = paths | views::transform([](const vector<T> &values) {
+        return span<const T>(values);
+    }) | ranges::to<vector>();
+    TraceFile<T>::Write(outputPath, intervalSeconds, pathViews);
+    println("Converted {} series.", paths.size());
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    const vector<string_view> args(argv + 1, argv + argc);
+    try {
+        if (args.size() == 5 && args[0] == "simulate") return Simulate(args[1], args[2], args[3], args[4]);
+        if (args.size() == 5 && args[0] == "convert") {
+            const auto intervalSeconds = stod(string(args[3]));
+            if (args[1] == "network") return Convert<double>(args[2], intervalSeconds, args[4]);
+            if (args[1] == "viewport") return Convert<SphericalPosition>(args[2], intervalSeconds, args[4]);
+        }
+        print(stderr, "{}", Usage);
+        return 2;
+    } catch (const exception &exception) {
+        println(stderr, "Error: {}", exception.what());
+        return 1;
+    }
+}
@@ -7,10 +7,40 @@ import ABRSimulation360.ABRSimulator360;
 import ABRSimulation360.AggregateControllers.ThroughputBasedController;
 import ABRSimulation360.Base;
 import ABRSimulation360.BitrateAllocators.HybridAllocator;
+import ABRSimulation360.Instrumentation;
+import ABRSimulation360.NetworkSimulator;
+import ABRSimulation360.Random;
+import ABRSimulation360.ThroughputPredictors.EMAPredictor;
+import ABRSimulation360.TraceFile;
+import ABRSimulation360.ViewportPredictors.LinearPredictor;
+import ABRSimulation360.ViewportPredictors.OfflinePredictor;
 
 using namespace std;
 using namespace experimental;
 
+namespace {
+    /// Trace files written to the temporary directory and removed when the writer goes out of scope.
+    struct TemporaryTraceFiles {
+        filesystem::path NetworkPath;
+        filesystem::path ViewportPath;
+
+        TemporaryTraceFiles(const string_view name, const span<const span<const double>> networkPaths,
+                            const span<const span<const SphericalPosition>> viewportPaths) :
+            NetworkPath(filesystem::temp_directory_path() / format("ABRSimulator360Test.{}.network.trace", name)),
+            ViewportPath(filesystem::temp_directory_path() / format("ABRSimulator360Test.{}.viewport.trace", name)) {
+            NetworkTraceFile::Write(NetworkPath, 1., networkPaths);
+            ViewportTraceFile::Write(ViewportPath, 0.1, viewportPaths);
+        }
+
+        TemporaryTraceFiles(const TemporaryTraceFiles &) = delete;
+
+        ~TemporaryTraceFiles() {
+            filesystem::remove(NetworkPath);
+            filesystem::remove(ViewportPath);
+        }
+    };
+}
+
 TEST(ABRSimulator360Test, BasicSimulation) {
     const StreamingConfig streamingConfig = {1., {1., 2., 4., 8.}, 1, {60., 1.}, 5.};
     const vector throughputsMbps = {8., 32., 24., 16.};
@@ -48,3 +78,436 @@ TEST(ABRSimulator360Test, BasicSimulation) {
                   0., 0., 0., 0., 0., 1.
               }));
 }
+
+TEST(ABRSimulator360Test, InstrumentedSimulation) {
+    const StreamingConfig streamingConfig = {1., {1., 2., 4., 8.}, 1, {60., 1.}, 5.};
+    const vector throughputsMbps = {8., 32., 24., 16.};
+    const NetworkSeriesView networkSeries = {1., throughputsMbps};
+    const vector<SphericalPosition> positions(40);
+    const ViewportSeriesView viewportSeries = {0.1, positions};
+
+    double rebufferingSeconds;
+    mdarray<double, dims<2>> bufferedBitratesMbps(4, 6);
+    mdarray<double, dims<2>> distributions(4, 6);
+    mdarray<double, dims<2>> predictedDistributions(3, 6);
+    vector<double> allocationMs(3);
+    mdarray<double, dims<2>> stageUs(3, SimulationStageCount);
+    mdarray<int64_t, dims<2>> counters(3, SimulationCounterCount);
+    StageHistograms stageHistograms;
+    ABRSimulator360::Simulate(streamingConfig, ThroughputBasedControllerOptions(), HybridAllocatorOptions(),
+                              networkSeries, viewportSeries, {
+                                  rebufferingSeconds, bufferedBitratesMbps.to_mdspan(), distributions.to_mdspan(),
+                                  predictedDistributions.to_mdspan(), allocationMs, stageUs.to_mdspan(),
+                                  counters.to_mdspan()
+                              }, {.StageHistograms = &stageHistograms});
+    EXPECT_DOUBLE_EQ(rebufferingSeconds, 0.);
+    EXPECT_EQ(bufferedBitratesMbps.container(), vector({
+                  1., 1., 1., 1., 1., 1.,
+                  1., 1., 1., 1., 1., 4.,
+                  1., 1., 1., 1., 1., 4.,
+                  1., 1., 1., 1., 1., 8.
+              }));
+    for (auto i = 0; i < 3; ++i) {
+        for (auto stageID = 0; stageID < SimulationStageCount; ++stageID) EXPECT_GE((stageUs[i, stageID]), 0.);
+        EXPECT_DOUBLE_EQ((stageUs[i, to_underlying(SimulationStage::BitrateAllocation)]), allocationMs[i]);
+        EXPECT_EQ((counters[i, to_underlying(SimulationCounter::FrustumTests)]), 10);
+        EXPECT_GE((counters[i, to_underlying(SimulationCounter::NetworkIntervals)]), 1);
+        EXPECT_EQ((counters[i, to_underlying(SimulationCounter::ScratchAllocations)]), 1);
+    }
+
+    ASSERT_EQ(stageHistograms.ThreadCount(), 1);
+    mdarray<int64_t, dims<3>> histograms(1, StageHistograms::BucketCount, SimulationStageCount);
+    stageHistograms.CopyTo(histograms.to_mdspan());
+    for (auto stageID = 0; stageID < SimulationStageCount; ++stageID) {
+        auto segmentCount = 0;
+        for (auto bucketID = 0; bucketID < StageHistograms::BucketCount; ++bucketID)
+            segmentCount += histograms[0, bucketID, stageID];
+        EXPECT_EQ(segmentCount, 3);
+    }
+    EXPECT_EQ(StageHistograms::Bucket(0.5), 0);
+    EXPECT_EQ(StageHistograms::Bucket(1.), 1);
+    EXPECT_EQ(StageHistograms::Bucket(3.), 2);
+    EXPECT_EQ(StageHistograms::Bucket(1e30), StageHistograms::BucketCount - 1);
+}
+
+TEST(ABRSimulator360Test, ForkedSimulation) {
+    const StreamingConfig streamingConfig = {1., {1., 2., 4., 8.}, 1, {60., 1.}, 5.};
+    const vector throughputsMbps = {8., 32., 24., 16.};
+    const NetworkSeriesView networkSeries = {1., throughputsMbps};
+    const vector<SphericalPosition> positions(40);
+    const ViewportSeriesView viewportSeries = {0.1, positions};
+    const ThroughputBasedControllerOptions controllerOptions;
+    const HybridAllocatorOptions allocatorOptions;
+
+    double rebufferingSeconds;
+    mdarray<double, dims<2>> bufferedBitratesMbps(4, 6);
+    mdarray<double, dims<2>> distributions(4, 6);
+    mdarray<double, dims<2>> predictedDistributions(3, 6);
+    vector<double> allocationMs(3);
+    ABRSimulator360::Simulate(streamingConfig, controllerOptions, allocatorOptions, networkSeries, viewportSeries, {
+                                  rebufferingSeconds, bufferedBitratesMbps.to_mdspan(),
+                                  distributions.to_mdspan(), predictedDistributions.to_mdspan(), allocationMs
+                              });
+
+    double prefixRebufferingSeconds, forkRebufferingSeconds;
+    mdarray<double, dims<2>> prefixBitratesMbps(4, 6), forkBitratesMbps(4, 6);
+    mdarray<double, dims<2>> forkDistributions(4, 6);
+    mdarray<double, dims<2>> prefixPredictedDistributions(3, 6), forkPredictedDistributions(3, 6);
+    vector<double> prefixAllocationMs(3), forkAllocationMs(3);
+    ABRSession360 session(streamingConfig, controllerOptions, allocatorOptions, NetworkSimulator(networkSeries),
+                          viewportSeries, {
+                              prefixRebufferingSeconds, prefixBitratesMbps.to_mdspan(), distributions.to_mdspan(),
+                              prefixPredictedDistributions.to_mdspan(), prefixAllocationMs
+                          });
+    session.RunUntil(2);
+    EXPECT_EQ(session.SegmentID(), 2);
+    auto fork = session.Fork({
+        forkRebufferingSeconds, forkBitratesMbps.to_mdspan(), forkDistributions.to_mdspan(),
+        forkPredictedDistributions.to_mdspan(), forkAllocationMs
+    });
+    EXPECT_EQ(forkDistributions.container(), distributions.container());
+    session.Run(), fork.Run();
+    EXPECT_TRUE(session.IsFinished());
+    EXPECT_TRUE(fork.IsFinished());
+    for (const auto *const _bitratesMbps : {&prefixBitratesMbps, &forkBitratesMbps})
+        EXPECT_EQ(_bitratesMbps->container(), bufferedBitratesMbps.container());
+    for (const auto *const _predictedDistributions : {&prefixPredictedDistributions, &forkPredictedDistributions})
+        EXPECT_EQ(_predictedDistributions->container(), predictedDistributions.container());
+    EXPECT_DOUBLE_EQ(prefixRebufferingSeconds, rebufferingSeconds);
+    EXPECT_DOUBLE_EQ(forkRebufferingSeconds, rebufferingSeconds);
+}
+
+TEST(ABRSimulator360Test, BranchedSimulation) {
+    const StreamingConfig streamingConfig = {1., {1., 2., 4., 8.}, 2, {90., 16 / 9.}, 4.};
+    const vector throughputsMbps = {8., 32., 24., 16., 4., 12., 40., 20.};
+    vector<SphericalPosition> positions(80);
+    for (auto i = 0; i < 80; ++i) positions[i] = {30. * sin(i * 0.1), i * 4.5 - 180.};
+
+    const array networkPaths = {span<const double>(throughputsMbps)};
+    const array viewportPaths = {span<const SphericalPosition>(positions)};
+    const TemporaryTraceFiles traceFiles("branched", networkPaths, viewportPaths);
+    const NetworkTraceFile networkTraces(traceFiles.NetworkPath);
+    const ViewportTraceFile viewportTraces(traceFiles.ViewportPath);
+
+    // Branches continue from stateful predictors, one with the prefix components and one with another allocator.
+    const ThroughputBasedControllerOptions controllerOptions;
+    const HybridAllocatorOptions allocatorOptions;
+    HybridAllocatorOptions trustingAllocatorOptions;
+    trustingAllocatorOptions.TrustLevel = 1.;
+    const array<const BaseAggregateControllerOptions *, 2> branchControllerOptions = {nullptr, &controllerOptions};
+    const array<const BaseBitrateAllocatorOptions *, 2> branchAllocatorOptions = {nullptr, &trustingAllocatorOptions};
+    LinearPredictorOptions viewportPredictorOptions;
+    viewportPredictorOptions.HistorySeconds = 1.;
+    const ABRSimulation360Options options = {.ViewportPredictorOptions = viewportPredictorOptions};
+
+    constexpr auto ForkSegmentID = 3;
+    mdarray<double, dims<2>> rebufferingSeconds(2, 1);
+    mdarray<double, dims<4>> bufferedBitratesMbps(2, 1, 8, 24);
+    mdarray<double, dims<3>> distributions(1, 8, 24);
+    mdarray<double, dims<4>> predictedDistributions(2, 1, 7, 24);
+    mdarray<double, dims<3>> allocationUs(2, 1, 7);
+    const SweepDataRef branchData = {
+        rebufferingSeconds.to_mdspan(), bufferedBitratesMbps.to_mdspan(), distributions.to_mdspan(),
+        predictedDistributions.to_mdspan(), allocationUs.to_mdspan()
+    };
+    ABRSimulator360::Fork(streamingConfig, controllerOptions, allocatorOptions, ForkSegmentID,
+                          branchControllerOptions, branchAllocatorOptions, networkTraces, viewportTraces, branchData,
+                          options);
+
+    // The branch that continues with the prefix components matches an unforked simulation,
+    // and the other branch matches it until the fork segment.
+    SimulationSeriesBuffer buffer(8, 24);
+    ABRSimulator360::Simulate(streamingConfig, controllerOptions, allocatorOptions, networkTraces[0],
+                              viewportTraces[0], buffer.Ref(), options);
+    EXPECT_DOUBLE_EQ((rebufferingSeconds[0, 0]), buffer.RebufferingSeconds);
+    for (auto segmentID = 0; segmentID < 8; ++segmentID)
+        for (auto tileID = 0; tileID < 24; ++tileID) {
+            const auto bitrateMbps = buffer.BufferedBitratesMbps[segmentID, tileID];
+            EXPECT_EQ((bufferedBitratesMbps[0, 0, segmentID, tileID]), bitrateMbps);
+            if (segmentID < ForkSegmentID) EXPECT_EQ((bufferedBitratesMbps[1, 0, segmentID, tileID]), bitrateMbps);
+            EXPECT_EQ((distributions[0, segmentID, tileID]), (buffer.ViewportDistributions[segmentID, tileID]));
+            if (segmentID < 7)
+                EXPECT_EQ((predictedDistributions[0, 0, segmentID, tileID]),
+                          (buffer.PredictedViewportDistributions[segmentID, tileID]));
+        }
+}
+
+TEST(ABRSimulator360Test, ReplicatedSimulation) {
+    const StreamingConfig streamingConfig = {1., {1., 2., 4., 8.}, 1, {60., 1.}, 5.};
+    const vector throughputsMbps = {8., 32., 24., 16.};
+    const NetworkSeriesView networkSeries = {1., throughputsMbps};
+    const vector<SphericalPosition> positions(40);
+    const ViewportSeriesView viewportSeries = {0.1, positions};
+    const ThroughputBasedControllerOptions controllerOptions;
+    const HybridAllocatorOptions allocatorOptions;
+    OfflinePredictorOptions viewportPredictorOptions;
+    viewportPredictorOptions.Randomness = 0.5;
+    const ABRSimulation360Options options = {.ViewportPredictorOptions = viewportPredictorOptions};
+
+    // Sessions with the same random key draw the same random numbers.
+    SimulationSeriesBuffer buffer(4, 6), sameBuffer(4, 6);
+    for (auto *const _buffer : {&buffer, &sameBuffer}) {
+        const RandomScope randomScope(42, 0, 1);
+        ABRSimulator360::Simulate(streamingConfig, controllerOptions, allocatorOptions, networkSeries, viewportSeries,
+                                  _buffer->Ref(), options);
+    }
+    EXPECT_EQ(sameBuffer.BufferedBitratesMbps.container(), buffer.BufferedBitratesMbps.container());
+    EXPECT_EQ(sameBuffer.PredictedViewportDistributions.container(), buffer.PredictedViewportDistributions.container());
+
+    // Replicas forked after the first segment draw the random numbers of their own keys.
+    SimulationSeriesBuffer replicaBuffer0(4, 6), replicaBuffer1(4, 6);
+    replicaBuffer0.ViewportDistributions = buffer.ViewportDistributions;
+    ABRSession360 replica0(streamingConfig, controllerOptions, allocatorOptions, NetworkSimulator(networkSeries),
+                           viewportSeries, replicaBuffer0.Ref(), options);
+    auto replica1 = replica0.Fork(replicaBuffer1.Ref());
+    {
+        const RandomScope randomScope(42, 0, 1);
+        replica1.Run();
+    }
+    {
+        const RandomScope randomScope(42, 0, 0);
+        replica0.Run();
+    }
+    EXPECT_EQ(replicaBuffer1.BufferedBitratesMbps.container(), buffer.BufferedBitratesMbps.container());
+    EXPECT_EQ(replicaBuffer1.PredictedViewportDistributions.container(),
+              buffer.PredictedViewportDistributions.container());
+    EXPECT_NE(replicaBuffer0.PredictedViewportDistributions.container(),
+              buffer.PredictedViewportDistributions.container());
+}
+
+TEST(ABRSimulator360Test, SimulatedReplicas) {
+    const StreamingConfig streamingConfig = {1., {1., 2., 4., 8.}, 1, {60., 1.}, 5.};
+    const vector<vector<double>> throughputsMbps = {{8., 32., 24., 16.}, {4., 2., 40., 12.}};
+    vector<vector<SphericalPosition>> positions(2, vector<SphericalPosition>(40));
+    for (auto i = 0; i < 40; ++i) positions[1][i] = {i * 2., i * 9. - 180.};
+
+    const array networkPaths = {span<const double>(throughputsMbps[0]), span<const double>(throughputsMbps[1])};
+    const array viewportPaths = {
+        span<const SphericalPosition>(positions[0]), span<const SphericalPosition>(positions[1])
+    };
+    const TemporaryTraceFiles traceFiles("replicas", networkPaths, viewportPaths);
+    const NetworkTraceFile networkTraces(traceFiles.NetworkPath);
+    const ViewportTraceFile viewportTraces(traceFiles.ViewportPath);
+
+    const ThroughputBasedControllerOptions controllerOptions;
+    const HybridAllocatorOptions allocatorOptions;
+    OfflinePredictorOptions viewportPredictorOptions;
+    viewportPredictorOptions.Randomness = 0.5;
+    const ABRSimulation360Options options = {.ViewportPredictorOptions = viewportPredictorOptions, .Seed = 42};
+
+    struct ReplicaData {
+        mdarray<double, dims<2>> RebufferingSeconds{2, 2};
+        mdarray<double, dims<4>> BufferedBitratesMbps{2, 2, 4, 6};
+        mdarray<double, dims<3>> ViewportDistributions{2, 4, 6};
+        mdarray<double, dims<4>> PredictedViewportDistributions{2, 2, 3, 6};
+        mdarray<double, dims<3>> AllocationUs{2, 2, 3};
+
+        void Simulate(const StreamingConfig &streamingConfig, const BaseAggregateControllerOptions &controllerOptions,
+                      const BaseBitrateAllocatorOptions &allocatorOptions, const NetworkTraceFile &networkTraces,
+                      const ViewportTraceFile &viewportTraces, const ABRSimulation360Options &options) {
+            ABRSimulator360::SimulateReplicas(streamingConfig, controllerOptions, allocatorOptions, networkTraces,
+                                              viewportTraces, {
+                                                  RebufferingSeconds.to_mdspan(), BufferedBitratesMbps.to_mdspan(),
+                                                  ViewportDistributions.to_mdspan(),
+                                                  PredictedViewportDistributions.to_mdspan(), AllocationUs.to_mdspan()
+                                              }, options);
+        }
+    };
+    ReplicaData data;
+    data.Simulate(streamingConfig, controllerOptions, allocatorOptions, networkTraces, viewportTraces, options);
+
+    // Each replica of each session matches a single-session simulation under its random key.
+    const ABRSimulation360Options sessionOptions = {.ViewportPredictorOptions = viewportPredictorOptions};
+    for (auto replicaIndex = 0; replicaIndex < 2; ++replicaIndex)
+        for (auto sessionIndex = 0; sessionIndex < 2; ++sessionIndex) {
+            SimulationSeriesBuffer buffer(4, 6);
+            {
+                const RandomScope randomScope(42, sessionIndex, replicaIndex);
+                ABRSimulator360::Simulate(streamingConfig, controllerOptions, allocatorOptions,
+                                          networkTraces[sessionIndex], viewportTraces[sessionIndex], buffer.Ref(),
+                                          sessionOptions);
+            }
+            EXPECT_DOUBLE_EQ((data.RebufferingSeconds[replicaIndex, sessionIndex]), buffer.RebufferingSeconds);
+            for (auto segmentID = 0; segmentID < 4; ++segmentID)
+                for (auto tileID = 0; tileID < 6; ++tileID) {
+                    EXPECT_EQ((data.BufferedBitratesMbps[replicaIndex, sessionIndex, segmentID, tileID]),
+                              (buffer.BufferedBitratesMbps[segmentID, tileID]));
+                    EXPECT_EQ((data.ViewportDistributions[sessionIndex, segmentID, tileID]),
+                              (buffer.ViewportDistributions[segmentID, tileID]));
+                    if (segmentID < 3)
+                        EXPECT_EQ((data.PredictedViewportDistributions[replicaIndex, sessionIndex, segmentID, tileID]),
+                                  (buffer.PredictedViewportDistributions[segmentID, tileID]));
+                }
+        }
+    const auto Predictions = [&](int replicaIndex) {
+        const auto *const predictions = &data.PredictedViewportDistributions[replicaIndex, 0, 0, 0];
+        return vector(predictions, predictions + 3 * 6);
+    };
+    EXPECT_NE(Predictions(0), Predictions(1));
+
+    // Replicas do not depend on how many threads run them, which changes when two simulations share the threads.
+    array<ReplicaData, 2> concurrentData;
+    {
+        array<jthread, 2> threads;
+        for (auto k = 0; k < 2; ++k)
+            threads[k] = jthread([&, k] {
+                concurrentData[k].Simulate(streamingConfig, controllerOptions, allocatorOptions, networkTraces,
+                                           viewportTraces, options);
+            });
+    }
+    for (const auto &_data : concurrentData) {
+        EXPECT_EQ(_data.RebufferingSeconds.container(), data.RebufferingSeconds.container());
+        EXPECT_EQ(_data.BufferedBitratesMbps.container(), data.BufferedBitratesMbps.container());
+        EXPECT_EQ(_data.PredictedViewportDistributions.container(), data.PredictedViewportDistributions.container());
+    }
+
+    // Simulations of single series draw from the enclosing random scope rather than the seed.
+    SimulationSeriesBuffer buffer(4, 6);
+    EXPECT_THROW(ABRSimulator360::Simulate(streamingConfig, controllerOptions, allocatorOptions, networkTraces[0],
+                                           viewportTraces[0], buffer.Ref(), options), invalid_argument);
+}
+
+TEST(ABRSimulator360Test, SweptSimulation) {
+    const StreamingConfig streamingConfig = {1., {1., 2., 4., 8.}, 1, {60., 1.}, 5.};
+    const vector<vector<double>> throughputsMbps = {{8., 32., 24., 16.}, {4., 2., 40., 12.}};
+    vector<vector<SphericalPosition>> positions(2, vector<SphericalPosition>(40));
+    for (auto i = 0; i < 40; ++i) positions[1][i] = {i * 2., i * 9. - 180.};
+
+    const array networkPaths = {span<const double>(throughputsMbps[0]), span<const double>(throughputsMbps[1])};
+    const array viewportPaths = {
+        span<const SphericalPosition>(positions[0]), span<const SphericalPosition>(positions[1])
+    };
+    const TemporaryTraceFiles traceFiles("swept", networkPaths, viewportPaths);
+    const NetworkTraceFile networkTraces(traceFiles.NetworkPath);
+    const ViewportTraceFile viewportTraces(traceFiles.ViewportPath);
+
+    const ThroughputBasedControllerOptions controllerOptions;
+    const HybridAllocatorOptions allocatorOptions;
+    HybridAllocatorOptions trustingAllocatorOptions;
+    trustingAllocatorOptions.TrustLevel = 1.;
+    const array<const BaseAggregateControllerOptions *, 2> controllerOptionsList = {
+        &controllerOptions, &controllerOptions
+    };
+    const array<const BaseBitrateAllocatorOptions *, 2> allocatorOptionsList = {
+        &allocatorOptions, &trustingAllocatorOptions
+    };
+
+    mdarray<double, dims<2>> rebufferingSeconds(2, 2);
+    mdarray<double, dims<4>> bufferedBitratesMbps(2, 2, 4, 6);
+    mdarray<double, dims<3>> distributions(2, 4, 6);
+    mdarray<double, dims<4>> predictedDistributions(2, 2, 3, 6);
+    mdarray<double, dims<3>> allocationUs(2, 2, 3);
+    const SweepDataRef sweepData = {
+        rebufferingSeconds.to_mdspan(), bufferedBitratesMbps.to_mdspan(), distributions.to_mdspan(),
+        predictedDistributions.to_mdspan(), allocationUs.to_mdspan()
+    };
+    ABRSimulator360::Sweep(streamingConfig, controllerOptionsList, allocatorOptionsList, networkTraces, viewportTraces,
+                           sweepData);
+
+    // Each configuration and session matches an independent simulation.
+    for (auto configIndex = 0; configIndex < 2; ++configIndex)
+        for (auto sessionIndex = 0; sessionIndex < 2; ++sessionIndex) {
+            SimulationSeriesBuffer buffer(4, 6);
+            ABRSimulator360::Simulate(streamingConfig, *controllerOptionsList[configIndex],
+                                      *allocatorOptionsList[configIndex], networkTraces[sessionIndex],
+                                      viewportTraces[sessionIndex], buffer.Ref());
+            EXPECT_DOUBLE_EQ((rebufferingSeconds[configIndex, sessionIndex]), buffer.RebufferingSeconds);
+            for (auto segmentID = 0; segmentID < 4; ++segmentID)
+                for (auto tileID = 0; tileID < 6; ++tileID) {
+                    EXPECT_EQ((bufferedBitratesMbps[configIndex, sessionIndex, segmentID, tileID]),
+                              (buffer.BufferedBitratesMbps[segmentID, tileID]));
+                    EXPECT_EQ((distributions[sessionIndex, segmentID, tileID]),
+                              (buffer.ViewportDistributions[segmentID, tileID]));
+                    if (segmentID < 3)
+                        EXPECT_EQ((predictedDistributions[configIndex, sessionIndex, segmentID, tileID]),
+                                  (buffer.PredictedViewportDistributions[segmentID, tileID]));
+                }
+        }
+}
+
+TEST(ABRSimulator360Test, SharedLinkSimulation) {
+    const StreamingConfig streamingConfig = {1., {1., 2., 4., 8.}, 1, {60., 1.}, 5.};
+    const vector throughputsMbps = {8., 32., 24., 16.};
+    const NetworkSeriesView networkSeries = {1., throughputsMbps};
+    const vector<SphericalPosition> positions(40);
+    const ViewportSeriesView viewportSeries = {0.1, positions};
+    const ThroughputBasedControllerOptions controllerOptions;
+    const HybridAllocatorOptions allocatorOptions;
+
+    SimulationSeriesBuffer buffer(4, 6);
+    ABRSimulator360::Simulate(streamingConfig, controllerOptions, allocatorOptions, networkSeries, viewportSeries,
+                              buffer.Ref());
+
+    // A single client on the link downloads exactly as a session on its own network.
+    SimulationSeriesBuffer singleBuffer(4, 6);
+    const array singleOut = {singleBuffer.Ref()};
+    const array singleViewportSeries = {viewportSeries};
+    const array singleStartSeconds = {0.};
+    ABRSimulator360::SimulateSharedLink(streamingConfig, controllerOptions, allocatorOptions, networkSeries,
+                                        singleViewportSeries, singleStartSeconds, EqualSharePolicy(), singleOut);
+    EXPECT_EQ(singleBuffer.BufferedBitratesMbps.container(), buffer.BufferedBitratesMbps.container());
+    EXPECT_EQ(singleBuffer.ViewportDistributions.container(), buffer.ViewportDistributions.container());
+    EXPECT_NEAR(singleBuffer.RebufferingSeconds, buffer.RebufferingSeconds, 1e-9);
+
+    // Two identical clients on a link of twice the capacity each see the network of a single client.
+    vector<double> doubledThroughputsMbps;
+    for (const auto throughputMbps : throughputsMbps) doubledThroughputsMbps.push_back(throughputMbps * 2);
+    SimulationSeriesBuffer buffer0(4, 6), buffer1(4, 6);
+    const array pairOut = {buffer0.Ref(), buffer1.Ref()};
+    const array pairViewportSeries = {viewportSeries, viewportSeries};
+    const array pairStartSeconds = {0., 0.};
+    ABRSimulator360::SimulateSharedLink(streamingConfig, controllerOptions, allocatorOptions,
+                                        {1., doubledThroughputsMbps}, pairViewportSeries, pairStartSeconds,
+                                        EqualSharePolicy(), pairOut);
+    for (const auto *const _buffer : {&buffer0, &buffer1}) {
+        EXPECT_EQ(_buffer->BufferedBitratesMbps.container(), buffer.BufferedBitratesMbps.container());
+        EXPECT_NEAR(_buffer->RebufferingSeconds, buffer.RebufferingSeconds, 1e-9);
+    }
+
+    EXPECT_THROW(ABRSimulator360::SimulateSharedLink(streamingConfig, controllerOptions, allocatorOptions,
+                                                     networkSeries, pairViewportSeries, singleStartSeconds,
+                                                     EqualSharePolicy(), pairOut), invalid_argument);
+}
+
+TEST(ABRSimulator360Test, BatchedSimulation) {
+    const StreamingConfig streamingConfig = {1., {1., 2., 4., 8.}, 1, {60., 1.}, 5.};
+    const vector<vector<double>> throughputsMbps = {{8., 32., 24., 16.}, {0.5, 2., 1.}, {64., 48.}};
+    vector<vector<SphericalPosition>> positions = {vector<SphericalPosition>(40), {}, {}};
+    for (auto i = 0; i < 80; ++i) positions[1].push_back({0., i * 4.5 - 180});
+    for (auto i = 0; i < 60; ++i) positions[2].push_back({i * 3. - 90, 0.});
+
+    // Each lane of a batch, including those that rebuffer, idle, or finish early, matches a session on its own.
+    deque<SimulationSeriesBuffer> buffers, batchBuffers;
+    vector<NetworkSimulator> networkSimulators;
+    vector<ViewportSeriesView> viewportSeries;
+    vector<SimulationSeriesRef> batchOut;
+    for (auto i = 0; i < 3; ++i) {
+        const NetworkSeriesView networkSeries = {1., throughputsMbps[i]};
+        viewportSeries.push_back({0.1, positions[i]});
+        const auto segmentCount = static_cast<int>(positions[i].size() / 10);
+        auto &buffer = buffers.emplace_back(segmentCount, 6);
+        ABRSimulator360::Simulate(streamingConfig, ThroughputBasedControllerOptions(), HybridAllocatorOptions(),
+                                  networkSeries, viewportSeries[i], buffer.Ref());
+
+        auto &batchBuffer = batchBuffers.emplace_back(segmentCount, 6);
+        batchBuffer.ViewportDistributions = buffer.ViewportDistributions;
+        networkSimulators.emplace_back(networkSeries);
+        batchOut.push_back(batchBuffer.Ref());
+    }
+    BasicABRSessionBatch360<EMAPredictor, ThroughputBasedController, HybridAllocator> batch(
+        streamingConfig, ThroughputBasedController(streamingConfig), HybridAllocator(streamingConfig),
+        EMAPredictor(), networkSimulators, viewportSeries, batchOut);
+    batch.Run();
+    EXPECT_TRUE(batch.IsFinished());
+    EXPECT_GT(buffers[1].RebufferingSeconds, 0.);
+    for (auto i = 0; i < 3; ++i) {
+        EXPECT_EQ(batchBuffers[i].RebufferingSeconds, buffers[i].RebufferingSeconds);
+        EXPECT_EQ(batchBuffers[i].BufferedBitratesMbps.container(), buffers[i].BufferedBitratesMbps.container());
+        EXPECT_EQ(batchBuffers[i].PredictedViewportDistributions.container(),
+                  buffers[i].PredictedViewportDistributions.container());
+    }
+
+    EXPECT_THROW((BasicABRSessionBatch360<EMAPredictor, ThroughputBasedController, HybridAllocator>(
+                     streamingConfig, ThroughputBasedController(streamingConfig), HybridAllocator(streamingConfig),
+                     EMAPredictor(), span(networkSimulators).first(2), viewportSeries, batchOut)), invalid_argument);
+}
@@ -39,3 +39,26 @@ TEST(ModelPredictiveControllerTest, BasicControl) {
     context.ThroughputMbps = 25.;
     EXPECT_DOUBLE_EQ(controller.GetAggregateBitrateMbps(context), 24.);
 }
+
+TEST(ModelPredictiveControllerTest, DynamicProgramming) {
+    // Download times are multiples of the buffer resolution, so the dynamic program is exact.
+    const StreamingConfig streamingConfig = {
+        .SegmentSeconds = 1.,
+        .BitratesPerFaceMbps = {1., 4., 16.},
+        .MaxBufferSeconds = 5.
+    };
+    for (auto windowLength = 1; windowLength <= 4; ++windowLength) {
+        ModelPredictiveControllerOptions options;
+        options.WindowLength = windowLength;
+        ModelPredictiveController exhaustiveController(streamingConfig, options);
+        options.BufferResolutionSeconds = 0.125;
+        ModelPredictiveController dpController(streamingConfig, options);
+
+        for (const auto throughputMbps : {6., 12., 24., 48.})
+            for (auto i = 0; i <= 40; ++i) {
+                const AggregateControllerContext context = {throughputMbps, i * 0.125};
+                EXPECT_DOUBLE_EQ(dpController.GetAggregateBitrateMbps(context),
+                                 exhaustiveController.GetAggregateBitrateMbps(context));
+            }
+    }
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+import System.Base;
+
+import ABRSimulation360.AggregateControllers.ThroughputBasedController;
+import ABRSimulation360.Base;
+import ABRSimulation360.BatchRunner;
+import ABRSimulation360.BitrateAllocators.HybridAllocator;
+import ABRSimulation360.TraceFile;
+
+using namespace std;
+
+TEST(BatchRunnerTest, StreamedResults) {
+    const StreamingConfig streamingConfig = {1., {1., 2., 4., 8.}, 1, {60., 1.}, 5.};
+    const auto directory = filesystem::temp_directory_path() / "BatchRunnerTest";
+    filesystem::create_directories(directory);
+    const vector throughputsMbps = {8., 32., 24., 16.};
+    const array networkPaths = {span<const double>(throughputsMbps), span<const double>(throughputsMbps)};
+    NetworkTraceFile::Write(directory / "network.trace", 1., networkPaths);
+    const vector<SphericalPosition> positions(40);
+    const array viewportPaths = {span<const SphericalPosition>(positions), span<const SphericalPosition>(positions)};
+    ViewportTraceFile::Write(directory / "viewport.trace", 0.1, viewportPaths);
+
+    const auto resultsPath = directory / "results.bin";
+    {
+        const NetworkTraceFile networkTraces(directory / "network.trace");
+        const ViewportTraceFile viewportTraces(directory / "viewport.trace");
+        BatchResultWriter writer(resultsPath, 6);
+        BatchRunner::Run(streamingConfig, ThroughputBasedControllerOptions(), HybridAllocatorOptions(),
+                         networkTraces, viewportTraces, writer);
+        EXPECT_EQ(writer.RecordCount(), 2);
+    }
+
+    // Each record holds 4 × 6 buffered bitrates, 4 × 6 distributions, 3 × 6 predicted distributions, and 3 timings.
+    const auto recordSize = sizeof(SessionRecordHeader) + (24 + 24 + 18 + 3) * sizeof(double);
+    ASSERT_EQ(filesystem::file_size(resultsPath), sizeof(BatchResultFileHeader) + 2 * recordSize);
+    ifstream stream(resultsPath, ios::binary);
+    stream.seekg(sizeof(BatchResultFileHeader));
+    vector<int> sessionIndices;
+    for (auto i = 0; i < 2; ++i) {
+        SessionRecordHeader header;
+        stream.read(reinterpret_cast<char *>(&header), sizeof(header));
+        EXPECT_EQ(header.SegmentCount, 4);
+        EXPECT_DOUBLE_EQ(header.RebufferingSeconds, 0.);
+        vector<double> bitratesMbps(24);
+        stream.read(reinterpret_cast<char *>(bitratesMbps.data()), 24 * sizeof(double));
+        EXPECT_EQ(bitratesMbps, vector({
+                      1., 1., 1., 1., 1., 1.,
+                      1., 1., 1., 1., 1., 4.,
+                      1., 1., 1., 1., 1., 4.,
+                      1., 1., 1., 1., 1., 8.
+                  }));
+        stream.seekg((24 + 18 + 3) * sizeof(double), ios::cur);
+        sessionIndices.push_back(static_cast<int>(header.SessionIndex));
+    }
+    stream.close();
+    ranges::sort(sessionIndices);
+    EXPECT_EQ(sessionIndices, vector({0, 1}));
+    filesystem::remove_all(directory);
+}
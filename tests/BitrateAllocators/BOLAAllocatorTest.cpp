@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 import System.Base;
+import System.Math;
 
 import ABRSimulation360.Base;
 import ABRSimulation360.BitrateAllocators.BOLAAllocator;
@@ -31,3 +32,54 @@ TEST(BOLAAllocatorTest, BasicAllocation) {
     context.BufferSeconds = 3.;
     EXPECT_EQ(allocator.GetBitrateIDs(context), vector({3, 0, 0, 0, 0, 0}));
 }
+
+TEST(BOLAAllocatorTest, RandomizedEquivalence) {
+    mt19937 generator(1);
+    uniform_real_distribution<> uniform;
+    for (auto trial = 0; trial < 200; ++trial) {
+        const auto bitrateCount = 2 + static_cast<int>(generator() % 15);
+        const auto tilingCount = 1 + static_cast<int>(generator() % 13);
+        StreamingConfig streamingConfig = {
+            .SegmentSeconds = 0.5 + 2 * uniform(generator),
+            .TilingCount = tilingCount
+        };
+        streamingConfig.MaxBufferSeconds = streamingConfig.SegmentSeconds * (1 + 10 * uniform(generator));
+        for (auto bitrateMbps = 1 + uniform(generator); streamingConfig.BitratesPerFaceMbps.size() < bitrateCount;
+             bitrateMbps *= 1.1 + uniform(generator))
+            streamingConfig.BitratesPerFaceMbps.push_back(bitrateMbps);
+        BOLAAllocatorOptions options;
+        options.BufferWeight = 3 * uniform(generator);
+        BOLAAllocator allocator(streamingConfig, options);
+
+        // Evaluates the objective of every bitrate for every tile, which the decision table must reproduce.
+        const auto tileCountPerFace = tilingCount * tilingCount;
+        const auto bitratesMbps = streamingConfig.BitratesPerFaceMbps / tileCountPerFace;
+        const auto utilityNormalizer = Math::Log(bitratesMbps.back() / bitratesMbps.front());
+        const auto controlFactor = (streamingConfig.MaxBufferSeconds / streamingConfig.SegmentSeconds - 1)
+            / (options.BufferWeight + 1);
+        const auto ReferenceBitrateID = [&](double probability, double bufferSeconds) {
+            auto optBitrateID = 0;
+            auto optObjective = -numeric_limits<double>::infinity();
+            for (auto bitrateID = 0; bitrateID < bitrateCount; ++bitrateID) {
+                const auto utility = Math::Log(bitratesMbps[bitrateID] / bitratesMbps.front()) / utilityNormalizer;
+                const auto objective = (controlFactor * (probability * utility + options.BufferWeight)
+                    - probability * bufferSeconds / streamingConfig.SegmentSeconds) / bitratesMbps[bitrateID];
+                if (objective > optObjective) optBitrateID = bitrateID, optObjective = objective;
+            }
+            return optBitrateID;
+        };
+
+        vector<double> distribution(tileCountPerFace * 6);
+        for (auto &probability : distribution) {
+            const auto sample = uniform(generator);
+            probability = sample < 0.3 ? 0. : sample < 0.35 ? 1. : uniform(generator) * uniform(generator);
+        }
+        BitrateAllocatorContext context = {.ViewportDistribution = distribution};
+        for (auto i = 0; i < 5; ++i) {
+            context.BufferSeconds = 1.2 * streamingConfig.MaxBufferSeconds * uniform(generator);
+            const auto bitrateIDs = allocator.GetBitrateIDs(context);
+            for (auto tileID = 0; tileID < distribution.size(); ++tileID)
+                ASSERT_EQ(bitrateIDs[tileID], ReferenceBitrateID(distribution[tileID], context.BufferSeconds));
+        }
+    }
+}
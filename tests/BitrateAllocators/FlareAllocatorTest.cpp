@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 import System.Base;
+import System.Math;
 
 import ABRSimulation360.Base;
 import ABRSimulation360.BitrateAllocators.FlareAllocator;
@@ -15,10 +16,11 @@ TEST(FlareAllocatorTest, BasicAllocation) {
     options.InitialAccuracy = 0.;
     FlareAllocator allocator(streamingConfig, options);
 
+    vector<double> dilatedDistribution(6);
     const auto DilatedDistribution = [&](double dilation) {
-        return views::iota(0, 6) | views::transform([&](int tileID) {
-            return predictedDistribution[tileID] * (1 - dilation) + dilation / 6;
-        }) | ranges::to<vector>();
+        for (auto tileID = 0; tileID < 6; ++tileID)
+            dilatedDistribution[tileID] = predictedDistribution[tileID] * (1 - dilation) + dilation / 6;
+        return span<const double>(dilatedDistribution);
     };
     BitrateAllocatorContext context = {
         .AggregateBitrateMbps = 15.,
@@ -37,3 +39,75 @@ TEST(FlareAllocatorTest, BasicAllocation) {
     EXPECT_EQ(allocator.GetBitrateIDs(context), vector({2, 1, 1, 1, 1, 1}));
     EXPECT_EQ(allocator.GetBitrateIDs(context), vector({2, 1, 1, 1, 1, 1}));
 }
+
+TEST(FlareAllocatorTest, RandomizedEquivalence) {
+    mt19937 generator(1);
+    uniform_real_distribution<> uniform;
+    for (auto trial = 0; trial < 2000; ++trial) {
+        const auto bitrateCount = 2 + static_cast<int>(generator() % 19);
+        const auto tilingCount = 1 + static_cast<int>(generator() % 13);
+        const auto tileCount = tilingCount * tilingCount * 6;
+        StreamingConfig streamingConfig = {.TilingCount = tilingCount};
+        for (auto bitrateMbps = 0.2 + uniform(generator); streamingConfig.BitratesPerFaceMbps.size() < bitrateCount;
+             bitrateMbps *= 1.05 + uniform(generator))
+            streamingConfig.BitratesPerFaceMbps.push_back(bitrateMbps);
+        FlareAllocatorOptions options;
+        options.SwitchingCostWeight = trial % 4 == 0 ? 0. : uniform(generator);
+        FlareAllocator allocator(streamingConfig, options);
+
+        // Mixes a uniform distribution with a random set of in-sight tiles, or draws arbitrary probabilities.
+        vector<double> mixedDistribution(tileCount);
+        const auto inSightCount = 1 + static_cast<int>(generator() % tileCount);
+        const auto accuracy = uniform(generator);
+        for (auto tileID = 0; tileID < tileCount; ++tileID) {
+            const auto inSightProbability = tileID < inSightCount ? accuracy / inSightCount : 0.;
+            mixedDistribution[tileID] = trial % 7 == 0
+                                            ? uniform(generator) / tileCount
+                                            : (1 - accuracy) / tileCount + inSightProbability;
+        }
+        ranges::shuffle(mixedDistribution, generator);
+        const auto DilatedDistribution = [&](double) {
+            return span<const double>(mixedDistribution);
+        };
+        const auto aggregateBitrateMbps = 1.2 * uniform(generator) * streamingConfig.BitratesPerFaceMbps.back() * 6;
+        const BitrateAllocatorContext context = {
+            .AggregateBitrateMbps = aggregateBitrateMbps,
+            .ViewportDistribution = mixedDistribution,
+            .DilatedViewportDistribution = DilatedDistribution
+        };
+
+        // Searches all feasible pairs of bitrates, which the pruned search must reproduce.
+        const auto bitratesMbps = streamingConfig.BitratesPerFaceMbps / (tilingCount * tilingCount);
+        const auto utilityNormalizer = Math::Log(bitratesMbps.back() / bitratesMbps.front());
+        const auto Utility = [&](int bitrateID) {
+            return Math::Log(bitratesMbps[bitrateID] / bitratesMbps.front()) / utilityNormalizer;
+        };
+        const auto [class1Probability, class0Probability] = ranges::minmax(mixedDistribution);
+        const auto class0Count = static_cast<int>(ranges::count(mixedDistribution, class0Probability));
+        const auto class1Count = tileCount - class0Count;
+        const auto totalClass0Probability = class0Probability * class0Count;
+        const auto totalClass1Probability = class1Probability * class1Count;
+        auto optBitrateID0 = 0, optBitrateID1 = 0;
+        auto optObjective = -numeric_limits<double>::infinity();
+        for (auto bitrateID0 = 0; bitrateID0 < bitrateCount; ++bitrateID0) {
+            const auto totalClass0BitrateMbps = bitratesMbps[bitrateID0] * class0Count;
+            if (totalClass0BitrateMbps > aggregateBitrateMbps) break;
+            for (auto bitrateID1 = 0; bitrateID1 <= bitrateID0; ++bitrateID1) {
+                if (totalClass0BitrateMbps + bitratesMbps[bitrateID1] * class1Count > aggregateBitrateMbps) break;
+                const auto utility360 = totalClass0Probability * Utility(bitrateID0)
+                    + totalClass1Probability * Utility(bitrateID1);
+                const auto spatialSwitching =
+                    Math::Sqrt(totalClass0Probability * Math::Pow(Utility(bitrateID0) - utility360, 2)
+                        + totalClass1Probability * Math::Pow(Utility(bitrateID1) - utility360, 2));
+                const auto objective = utility360 - options.SwitchingCostWeight
+                    * (spatialSwitching + Math::Abs(utility360));
+                if (objective > optObjective)
+                    optBitrateID0 = bitrateID0, optBitrateID1 = bitrateID1, optObjective = objective;
+            }
+        }
+        const auto bitrateIDs = allocator.GetBitrateIDs(context);
+        for (auto tileID = 0; tileID < tileCount; ++tileID)
+            ASSERT_EQ(bitrateIDs[tileID],
+                      mixedDistribution[tileID] == class0Probability ? optBitrateID0 : optBitrateID1);
+    }
+}
@@ -46,4 +46,17 @@ TEST(HybridAllocatorTest, BasicAllocation) {
 
     context.AggregateBitrateMbps = 25.;
     EXPECT_EQ(allocator.GetBitrateIDs(context), vector({3, 0, 0, 0, 0, 0}));
+
+    // Decides the same bitrates from the sparse form of the distribution.
+    const vector tileIDs = {0};
+    const vector weights = {1.};
+    options.TrustLevel = 0.5;
+    allocator = HybridAllocator(streamingConfig, options);
+    for (const auto aggregateBitrateMbps : {5., 15., 25.}) {
+        context.AggregateBitrateMbps = aggregateBitrateMbps;
+        context.SparseViewportDistribution = {};
+        const auto bitrateIDs = allocator.GetBitrateIDs(context);
+        context.SparseViewportDistribution = {6, tileIDs, weights};
+        EXPECT_EQ(allocator.GetBitrateIDs(context), bitrateIDs);
+    }
 }
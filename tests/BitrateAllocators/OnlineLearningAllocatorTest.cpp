@@ -28,3 +28,21 @@ TEST(OnlineLearningAllocatorTest, BasicAllocation) {
     EXPECT_EQ(allocator.GetBitrateIDs(context), vector({1, 1, 1, 1, 1, 1}));
     EXPECT_EQ(allocator.GetBitrateIDs(context), vector({1, 1, 1, 1, 1, 1}));
 }
+
+TEST(OnlineLearningAllocatorTest, SparseAllocation) {
+    const StreamingConfig streamingConfig = {.BitratesPerFaceMbps = {1., 2., 4., 8.}, .TilingCount = 1};
+    const vector predictedDistribution = {0.75, 0.25, 0., 0., 0., 0.};
+    const vector tileIDs = {0, 1};
+    const vector weights = {0.75, 0.25};
+    OnlineLearningAllocator denseAllocator(streamingConfig), sparseAllocator(streamingConfig);
+
+    BitrateAllocatorContext denseContext = {.AggregateBitrateMbps = 15., .ViewportDistribution = predictedDistribution};
+    auto sparseContext = denseContext;
+    sparseContext.SparseViewportDistribution = {6, tileIDs, weights};
+    for (const auto &prevDistribution : {
+             vector({1., 0., 0., 0., 0., 0.}), vector({0.5, 0., 0.5, 0., 0., 0.}), vector({0., 0., 0., 0.5, 0.5, 0.})
+         }) {
+        denseContext.PrevViewportDistribution = sparseContext.PrevViewportDistribution = prevDistribution;
+        EXPECT_EQ(sparseAllocator.GetBitrateIDs(sparseContext), denseAllocator.GetBitrateIDs(denseContext));
+    }
+}
@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+import System.Base;
+import System.MDArray;
+
+import ABRSimulation360.Base;
+import ABRSimulation360.DistributionCache;
+import ABRSimulation360.ViewportSimulator;
+
+using namespace std;
+using namespace experimental;
+
+TEST(DistributionCacheTest, BasicCaching) {
+    const auto directory = filesystem::temp_directory_path() / "DistributionCacheTest";
+    filesystem::remove_all(directory);
+    DistributionCache cache(directory);
+
+    const StreamingConfig streamingConfig = {1., {1., 2., 4., 8.}, 1, {60., 1.}, 5.};
+    const vector<SphericalPosition> positions(20);
+    const ViewportSeriesView viewportSeries = {0.1, positions};
+    const auto key = DistributionCache::Key(viewportSeries, streamingConfig, {});
+
+    mdarray<double, dims<2>> distributions(2, 6);
+    EXPECT_FALSE(cache.TryLoad(key, distributions.to_mdspan()));
+
+    mdarray<double, dims<2>> storedDistributions(2, 6);
+    storedDistributions[0, 5] = 1., storedDistributions[1, 4] = 0.5, storedDistributions[1, 5] = 0.5;
+    cache.Store(key, storedDistributions.to_mdspan());
+    cache.Store(key, storedDistributions.to_mdspan());
+    EXPECT_EQ(ranges::distance(filesystem::directory_iterator(directory)), 1);
+    EXPECT_TRUE(cache.TryLoad(key, distributions.to_mdspan()));
+    EXPECT_EQ(distributions.container(), storedDistributions.container());
+
+    const auto otherKey = DistributionCache::Key(viewportSeries, streamingConfig, {.GridDegrees = 1.});
+    EXPECT_NE(otherKey, key);
+    EXPECT_FALSE(cache.TryLoad(otherKey, distributions.to_mdspan()));
+
+    const auto statistics = cache.Statistics();
+    EXPECT_EQ(statistics.LookupCount, 3);
+    EXPECT_EQ(statistics.HitCount, 1);
+    EXPECT_EQ(statistics.MappedBytes, 32 + 12 * 8);
+    filesystem::remove_all(directory);
+}
@@ -18,3 +18,78 @@ TEST(NetworkSimulatorTest, BasicSimulation) {
     EXPECT_EQ(simulator.Download(4., 1.), (TimedValue{2.5, 1.}));
     EXPECT_EQ(simulator.Download(1.5, 2.), (TimedValue{1.5, 1.}));
 }
+
+TEST(NetworkSimulatorTest, IndexedSimulation) {
+    const vector throughputsMbps = {8., 32., 24., 16.};
+    const NetworkSeriesView networkSeries = {1., throughputsMbps};
+    const NetworkTraceIndex index(networkSeries);
+    NetworkSimulator simulator(index);
+
+    EXPECT_DOUBLE_EQ(simulator.Download(0.5).Seconds, 0.5);
+    EXPECT_DOUBLE_EQ(simulator.Download(2.5).Seconds, 1.);
+    simulator.WaitFor(1.);
+    auto downloadInfo = simulator.Download(4., 1.);
+    EXPECT_DOUBLE_EQ(downloadInfo.Value, 2.5);
+    EXPECT_DOUBLE_EQ(downloadInfo.Seconds, 1.);
+    downloadInfo = simulator.Download(1.5, 2.);
+    EXPECT_DOUBLE_EQ(downloadInfo.Value, 1.5);
+    EXPECT_DOUBLE_EQ(downloadInfo.Seconds, 1.);
+
+    // Wraps around the network series several times.
+    EXPECT_DOUBLE_EQ(simulator.Download(30.).Seconds, 12.);
+}
+
+TEST(NetworkSimulatorTest, ZeroThroughputSimulation) {
+    const vector throughputsMbps = {8., 0., 16., 0.};
+    const NetworkSeriesView networkSeries = {1., throughputsMbps};
+    const NetworkTraceIndex index(networkSeries);
+    NetworkSimulator simulator(networkSeries), indexedSimulator(index);
+
+    // Completes at the boundary before a zero-throughput interval rather than after it.
+    EXPECT_DOUBLE_EQ(simulator.Download(1.).Seconds, 1.);
+    EXPECT_DOUBLE_EQ(indexedSimulator.Download(1.).Seconds, 1.);
+
+    const vector<tuple<double, double, double>> actions = {
+        {1., numeric_limits<double>::infinity(), 0.}, {2., 2., 0.}, {0.5, numeric_limits<double>::infinity(), 1.},
+        {3., numeric_limits<double>::infinity(), 0.}, {2., 1., 0.5}, {0., 1., 0.}, {6., 3., 0.}
+    };
+    for (const auto [sizeMB, timeoutSeconds, waitSeconds] : actions) {
+        simulator.WaitFor(waitSeconds), indexedSimulator.WaitFor(waitSeconds);
+        const auto downloadInfo = simulator.Download(sizeMB, timeoutSeconds);
+        const auto indexedDownloadInfo = indexedSimulator.Download(sizeMB, timeoutSeconds);
+        EXPECT_DOUBLE_EQ(indexedDownloadInfo.Value, downloadInfo.Value);
+        EXPECT_DOUBLE_EQ(indexedDownloadInfo.Seconds, downloadInfo.Seconds);
+    }
+}
+
+TEST(NetworkSimulatorTest, SharedLinkSimulation) {
+    const vector capacitiesMbps = {8., 32., 24., 16.};
+    const NetworkSeriesView linkSeries = {1., capacitiesMbps};
+    SharedLinkSimulator link(linkSeries);
+
+    // Shares the link equally once the second download starts.
+    link.Start(0, 2., 1.);
+    EXPECT_EQ(link.AdvanceUntil(0.5), nullopt);
+    EXPECT_DOUBLE_EQ(link.Seconds(), 0.5);
+    link.Start(1, 1., 1.);
+    EXPECT_EQ(link.DownloadCount(), 2);
+    EXPECT_EQ(link.AdvanceUntil(numeric_limits<double>::infinity()), 1);
+    EXPECT_DOUBLE_EQ(link.Seconds(), 1.375);
+    EXPECT_EQ(link.AdvanceUntil(numeric_limits<double>::infinity()), 0);
+    EXPECT_DOUBLE_EQ(link.Seconds(), 1.5);
+
+    // Skips idle time, and shares the link in proportion to weights.
+    EXPECT_EQ(link.AdvanceUntil(2.), nullopt);
+    link.Start(0, 1.5, 1.);
+    link.Start(1, 4., 2.);
+    EXPECT_EQ(link.AdvanceUntil(numeric_limits<double>::infinity()), 0);
+    EXPECT_DOUBLE_EQ(link.Seconds(), 3.75);
+    EXPECT_EQ(link.AdvanceUntil(numeric_limits<double>::infinity()), 1);
+    EXPECT_DOUBLE_EQ(link.Seconds(), 4.5);
+    EXPECT_EQ(link.DownloadCount(), 0);
+
+    EXPECT_DOUBLE_EQ(EqualSharePolicy().Weight(0, 2.), 1.);
+    EXPECT_DOUBLE_EQ(WeightedSharePolicy({1., 3.}).Weight(1, 2.), 3.);
+    EXPECT_DOUBLE_EQ(SizeProportionalSharePolicy().Weight(0, 2.), 2.);
+    EXPECT_THROW(SharedLinkSimulator(NetworkSeriesView{1., vector(4, 0.)}), invalid_argument);
+}
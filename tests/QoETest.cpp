@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+
+import System.Base;
+import System.MDArray;
+
+import ABRSimulation360.Base;
+import ABRSimulation360.QoE;
+
+using namespace std;
+using namespace experimental;
+
+TEST(QoETest, Evaluate) {
+    const StreamingConfig streamingConfig = {1., {1., 2., 4., 8.}, 1, {60., 1.}, 5.};
+    const QoEEvaluator evaluator(streamingConfig);
+    EXPECT_EQ(evaluator.BitrateID(1.), 0);
+    EXPECT_EQ(evaluator.BitrateID(4.), 2);
+    EXPECT_EQ(evaluator.BitrateID(8.), 3);
+
+    const vector bufferedBitratesMbps = {
+        1., 1., 1., 1., 1., 1.,
+        1., 1., 1., 1., 8., 1.
+    };
+    const vector distributions = {
+        0., 0., 0., 0., 0., 1.,
+        0., 0., 0., 0., 0.5, 0.5
+    };
+    array<double, SessionMetricCount> sessionQoE;
+    mdarray<double, dims<2>> segmentQoE(2, SegmentMetricCount);
+    evaluator.Evaluate(mdspan(bufferedBitratesMbps.data(), 2, 6), mdspan(distributions.data(), 2, 6), 1.5,
+                       sessionQoE, segmentQoE.to_mdspan());
+    EXPECT_EQ(segmentQoE.container(), vector({
+                  0., 0., 0., 0.625,
+                  0.5, 0.25, 0.5, 0.5
+              }));
+    EXPECT_DOUBLE_EQ(sessionQoE[to_underlying(SessionMetric::ViewportQuality)], 0.25);
+    EXPECT_DOUBLE_EQ(sessionQoE[to_underlying(SessionMetric::SpatialVariance)], 0.125);
+    EXPECT_DOUBLE_EQ(sessionQoE[to_underlying(SessionMetric::TemporalVariance)], 0.0625);
+    EXPECT_DOUBLE_EQ(sessionQoE[to_underlying(SessionMetric::WastedMB)], 1.125);
+    EXPECT_DOUBLE_EQ(sessionQoE[to_underlying(SessionMetric::RebufferingSeconds)], 1.5);
+}
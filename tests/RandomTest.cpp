@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+import System.Base;
+
+import ABRSimulation360.Random;
+
+using namespace std;
+
+TEST(RandomTest, PhiloxBlocks) {
+    // Known-answer tests of the reference implementation of Philox4x32-10.
+    EXPECT_EQ(RandomStream::Philox({0, 0, 0, 0}, {0, 0}),
+              (array<uint32_t, 4>{0x6627E8D5, 0xE169C58D, 0xBC57AC4C, 0x9B00DBD8}));
+    EXPECT_EQ(RandomStream::Philox({0x243F6A88, 0x85A308D3, 0x13198A2E, 0x03707344}, {0xA4093822, 0x299F31D0}),
+              (array<uint32_t, 4>{0xD16CFE09, 0x94FDCCEB, 0x5001E420, 0x24126EA1}));
+}
+
+TEST(RandomTest, KeyedStreams) {
+    const RandomKey key = {42, 3, 1, 7};
+    RandomStream stream(key), sameStream(key);
+    RandomStream otherStream({42, 3, 2, 7});
+    vector<uint32_t> words(10), sameWords(10), otherWords(10);
+    ranges::generate(words, ref(stream));
+    ranges::generate(sameWords, ref(sameStream));
+    ranges::generate(otherWords, ref(otherStream));
+    EXPECT_EQ(words, sameWords);
+    EXPECT_NE(words, otherWords);
+
+    // Batches consume whole blocks and match blocks generated one at a time.
+    vector<double> uniforms(7);
+    RandomStream(key).Uniforms(uniforms);
+    RandomStream blockStream(key);
+    for (auto i = 0; i < 6; ++i) EXPECT_EQ(uniforms[i], blockStream.Uniform());
+    EXPECT_EQ(uniforms[6], blockStream.Uniform());
+    for (const auto uniform : uniforms) {
+        EXPECT_GE(uniform, 0.);
+        EXPECT_LT(uniform, 1.);
+    }
+}
+
+TEST(RandomTest, RandomScopes) {
+    double uniform;
+    {
+        const RandomScope scope(42, 3, 1);
+        RandomScope::SetSegmentID(7);
+        uniform = RandomScope::Stream().Uniform();
+        {
+            const RandomScope innerScope(42, 4);
+            EXPECT_NE(RandomScope::Stream().Uniform(), uniform);
+        }
+        EXPECT_NE(RandomScope::Stream().Uniform(), uniform);
+        // Restarts the stream of the segment.
+        RandomScope::SetSegmentID(7);
+        EXPECT_EQ(RandomScope::Stream().Uniform(), uniform);
+    }
+    EXPECT_EQ(uniform, RandomStream({42, 3, 1, 7}).Uniform());
+
+    // Streams do not depend on the thread that draws from them.
+    double threadUniform;
+    jthread([&] {
+        const RandomScope scope(42, 3, 1);
+        RandomScope::SetSegmentID(7);
+        threadUniform = RandomScope::Stream().Uniform();
+    }).join();
+    EXPECT_EQ(threadUniform, uniform);
+}
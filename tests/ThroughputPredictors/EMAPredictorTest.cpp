@@ -1,7 +1,11 @@
 #include <gtest/gtest.h>
 
+import System.Base;
+
 import ABRSimulation360.ThroughputPredictors.EMAPredictor;
 
+using namespace std;
+
 TEST(EMAPredictorTest, BasicPrediction) {
     EMAPredictor predictor;
 
@@ -14,3 +18,18 @@ TEST(EMAPredictorTest, BasicPrediction) {
     predictor.Update(4., 4.);
     EXPECT_NEAR(predictor.PredictThroughputMbps(), 12.9, 0.05);
 }
+
+TEST(EMAPredictorTest, LanePrediction) {
+    const vector<double> downloadedMB = {4., 16., 4.}, downloadSeconds = {2., 4., 4.};
+    vector<EMAPredictor> predictors(3);
+    EMAPredictorLanes lanes(EMAPredictor(), 3);
+    vector<double> throughputsMbps(3);
+    for (auto laneCount = 3; laneCount > 0; --laneCount) {
+        for (auto laneID = 0; laneID < laneCount; ++laneID)
+            predictors[laneID].Update(downloadedMB[laneID], downloadSeconds[laneID]);
+        lanes.Update(span(downloadedMB).first(laneCount), span(downloadSeconds).first(laneCount));
+        lanes.PredictThroughputsMbps(span(throughputsMbps).first(laneCount));
+        for (auto laneID = 0; laneID < laneCount; ++laneID)
+            EXPECT_EQ(throughputsMbps[laneID], predictors[laneID].PredictThroughputMbps());
+    }
+}
@@ -1,7 +1,11 @@
 #include <gtest/gtest.h>
 
+import System.Base;
+
 import ABRSimulation360.ThroughputPredictors.MovingAveragePredictor;
 
+using namespace std;
+
 TEST(MovingAveragePredictorTest, BasicPrediction) {
     MovingAveragePredictor predictor;
 
@@ -17,3 +21,26 @@ TEST(MovingAveragePredictorTest, BasicPrediction) {
     predictor.Update(4., 4.);
     EXPECT_DOUBLE_EQ(predictor.PredictThroughputMbps(), 8.);
 }
+
+TEST(MovingAveragePredictorTest, LanePrediction) {
+    // Lanes retire one by one, and their windows hold different numbers of downloads.
+    mt19937 generator(1);
+    uniform_real_distribution sizeDistribution(0.5, 8.), secondsDistribution(0.2, 3.);
+    MovingAveragePredictor predictor;
+    predictor.Update(4., 2.);
+    vector predictors(4, predictor);
+    MovingAveragePredictorLanes lanes(predictor, 4);
+    vector<double> downloadedMB(4), downloadSeconds(4), throughputsMbps(4);
+    for (auto stepID = 0; stepID < 40; ++stepID) {
+        const auto laneCount = 4 - stepID / 10;
+        for (auto laneID = 0; laneID < laneCount; ++laneID) {
+            downloadedMB[laneID] = sizeDistribution(generator);
+            downloadSeconds[laneID] = secondsDistribution(generator) * (laneID + 1);
+            predictors[laneID].Update(downloadedMB[laneID], downloadSeconds[laneID]);
+        }
+        lanes.Update(span(downloadedMB).first(laneCount), span(downloadSeconds).first(laneCount));
+        lanes.PredictThroughputsMbps(span(throughputsMbps).first(laneCount));
+        for (auto laneID = 0; laneID < laneCount; ++laneID)
+            EXPECT_EQ(throughputsMbps[laneID], predictors[laneID].PredictThroughputMbps());
+    }
+}
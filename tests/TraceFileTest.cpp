@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+import System.Base;
+
+import ABRSimulation360.Base;
+import ABRSimulation360.TraceFile;
+
+using namespace std;
+
+TEST(TraceFileTest, RoundTrip) {
+    const auto directory = filesystem::temp_directory_path() / "TraceFileTest.RoundTrip";
+    filesystem::create_directories(directory);
+
+    const auto networkPath = directory / "network.trace";
+    const vector<vector<double>> throughputsMbps = {{8., 32., 24.}, {}, {16.}};
+    const auto networkPaths = throughputsMbps | views::transform([](const vector<double> &values) {
+        return span<const double>(values);
+    }) | ranges::to<vector>();
+    NetworkTraceFile::Write(networkPath, 0.5, networkPaths);
+    {
+        const NetworkTraceFile networkTraces(networkPath);
+        ASSERT_EQ(networkTraces.PathCount(), 3);
+        EXPECT_DOUBLE_EQ(networkTraces.IntervalSeconds(), 0.5);
+        for (auto i = 0; i < 3; ++i) {
+            EXPECT_DOUBLE_EQ(networkTraces[i].IntervalSeconds, 0.5);
+            EXPECT_TRUE(ranges::equal(networkTraces[i].Values, throughputsMbps[i]));
+        }
+    }
+
+    const auto viewportPath = directory / "viewport.trace";
+    const vector<SphericalPosition> positions = {{10., -20.}, {15., 170.}};
+    const array viewportPaths = {span<const SphericalPosition>(positions)};
+    ViewportTraceFile::Write(viewportPath, 0.1, viewportPaths);
+    {
+        const ViewportTraceFile viewportTraces(viewportPath);
+        ASSERT_EQ(viewportTraces.PathCount(), 1);
+        EXPECT_TRUE(ranges::equal(viewportTraces[0].Values, positions));
+    }
+
+    EXPECT_THROW(ViewportTraceFile{networkPath}, runtime_error);
+    filesystem::remove_all(directory);
+}
+
+TEST(TraceFileTest, OverflowingHeader) {
+    const auto directory = filesystem::temp_directory_path() / "TraceFileTest.OverflowingHeader";
+    filesystem::create_directories(directory);
+
+    // The header is followed by the offsets, so the path count is at byte 16 and the last offset is at byte 32 + 8n.
+    const auto path = directory / "network.trace";
+    const vector throughputsMbps = {8., 32., 24., 16.};
+    const array networkPaths = {span<const double>(throughputsMbps)};
+    const auto Patch = [&](streamoff position, uint64_t value) {
+        NetworkTraceFile::Write(path, 1., networkPaths);
+        fstream stream(path, ios::binary | ios::in | ios::out);
+        stream.seekp(position);
+        stream.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    };
+
+    // Neither the size of the offsets nor the size of the samples may wrap around to match the file size.
+    Patch(16, (uint64_t{1} << 61) - 1);
+    EXPECT_THROW(NetworkTraceFile{path}, runtime_error);
+    Patch(40, (uint64_t{1} << 61) + 4);
+    EXPECT_THROW(NetworkTraceFile{path}, runtime_error);
+    Patch(40, 4);
+    EXPECT_EQ(NetworkTraceFile(path).PathCount(), 1);
+    filesystem::remove_all(directory);
+}
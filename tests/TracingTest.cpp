@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+import System.Base;
+import System.MDArray;
+
+import ABRSimulation360.ABRSimulator360;
+import ABRSimulation360.AggregateControllers.ThroughputBasedController;
+import ABRSimulation360.Base;
+import ABRSimulation360.BitrateAllocators.OnlineLearningAllocator;
+import ABRSimulation360.Tracing;
+
+using namespace std;
+using namespace experimental;
+
+TEST(TracingTest, ConcurrentSessions) {
+    const auto path = filesystem::temp_directory_path() / "TracingTest.ConcurrentSessions.log";
+    const TraceChannel channel("TracingTest.Segment");
+    {
+        Tracer tracer(path);
+        vector<jthread> threads;
+        for (auto sessionID = 0u; sessionID < 4; ++sessionID)
+            threads.emplace_back([&, sessionID] {
+                const TraceScope scope(&tracer, sessionID);
+                for (auto segmentID = 0u; segmentID < 1000; ++segmentID) {
+                    TraceScope::SetSegmentID(segmentID);
+                    Tracer::Emit(channel, segmentID + sessionID * 0.25);
+                }
+            });
+        threads.clear();
+        // Values traced outside trace scopes are ignored.
+        Tracer::Emit(channel, -1.);
+    }
+
+    const auto log = Tracer::Read(path);
+    EXPECT_EQ(log.ChannelNames[channel.ID()], "TracingTest.Segment");
+    EXPECT_EQ(log.DroppedCount, 0);
+    ASSERT_EQ(log.Records.size(), 4000);
+    vector<uint32_t> nextSegmentIDs(4);
+    for (const auto &record : log.Records) {
+        ASSERT_LT(record.SessionID, 4);
+        EXPECT_EQ(record.ChannelID, channel.ID());
+        EXPECT_EQ(record.SegmentID, nextSegmentIDs[record.SessionID]++);
+        EXPECT_EQ(record.Value, static_cast<float>(record.SegmentID + record.SessionID * 0.25));
+    }
+}
+
+TEST(TracingTest, BoundedRings) {
+    const auto path = filesystem::temp_directory_path() / "TracingTest.BoundedRings.log";
+    const TraceChannel channel("TracingTest.Index");
+    int64_t recordCount, droppedCount;
+    {
+        Tracer tracer(path, {.RingCapacity = 16, .FlushSeconds = 60.});
+        const TraceScope scope(&tracer, 0);
+        for (auto i = 0; i < 1000; ++i) Tracer::Emit(channel, i);
+        tracer.Flush();
+        recordCount = tracer.RecordCount(), droppedCount = tracer.DroppedCount();
+    }
+    EXPECT_GE(recordCount, 16);
+    EXPECT_EQ(recordCount + droppedCount, 1000);
+
+    const auto log = Tracer::Read(path);
+    EXPECT_EQ(log.Records.size(), recordCount);
+    EXPECT_EQ(log.DroppedCount, droppedCount);
+}
+
+TEST(TracingTest, TracedSession) {
+    const StreamingConfig streamingConfig = {1., {1., 2., 4., 8.}, 1, {60., 1.}, 5.};
+    const vector throughputsMbps = {8., 32., 24., 16.};
+    const NetworkSeriesView networkSeries = {1., throughputsMbps};
+    const vector<SphericalPosition> positions(40);
+    const ViewportSeriesView viewportSeries = {0.1, positions};
+
+    const auto path = filesystem::temp_directory_path() / "TracingTest.TracedSession.log";
+    {
+        Tracer tracer(path);
+        const TraceScope scope(&tracer, 7);
+        SimulationSeriesBuffer buffer(4, 6);
+        ABRSimulator360::Simulate(streamingConfig, ThroughputBasedControllerOptions(),
+                                  OnlineLearningAllocatorOptions(), networkSeries, viewportSeries, buffer.Ref());
+    }
+
+    const auto log = Tracer::Read(path);
+    const auto channelID = ranges::find(log.ChannelNames, "OnlineLearningAllocator.TrustLevel"sv)
+                           - log.ChannelNames.cbegin();
+    ASSERT_LT(channelID, log.ChannelNames.size());
+    ASSERT_EQ(log.Records.size(), 3);
+    for (auto i = 0; i < 3; ++i) {
+        EXPECT_EQ(log.Records[i].SessionID, 7);
+        EXPECT_EQ(log.Records[i].SegmentID, i + 1);
+        EXPECT_EQ(log.Records[i].ChannelID, channelID);
+    }
+    EXPECT_EQ(log.Records[0].Value, 0.5f);
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+import System.Base;
+import System.MDArray;
+
+import ABRSimulation360.Base;
+import ABRSimulation360.ViewportPredictors.GravitationalPredictor;
+
+using namespace std;
+using namespace experimental;
+
+namespace {
+    // Predicts positions by accumulating the velocity induced by each cluster center in turn,
+    // as gravitational predictors did before they moved to struct-of-arrays cluster data.
+    class ReferencePredictor {
+        const GravitationalPredictorOptions &_options;
+        const mdarray<double, extents<size_t, dynamic_extent, dynamic_extent, 2>> &_clusterCenters;
+        const mdarray<double, dims<2>> &_clusterWeights;
+        double _smoothingWeight;
+
+        int _time = 0;
+        SphericalPosition _prevPosition = {};
+        double _pitchVelocity = 0., _yawVelocity = 0.;
+
+    public:
+        ReferencePredictor(const GravitationalPredictorOptions &options,
+                           const mdarray<double, extents<size_t, dynamic_extent, dynamic_extent, 2>> &clusterCenters,
+                           const mdarray<double, dims<2>> &clusterWeights) :
+            _options(options), _clusterCenters(clusterCenters), _clusterWeights(clusterWeights),
+            _smoothingWeight(pow(0.5, 1. / options.SmoothingHalfLifeSeconds)) {}
+
+        void Update(SphericalPosition position) {
+            ++_time;
+            const auto pitchVelocity = position.PitchDegrees - _prevPosition.PitchDegrees,
+                       yawVelocity = SphericalPosition::YawDifferenceDegrees(_prevPosition.YawDegrees,
+                                                                             position.YawDegrees);
+            _pitchVelocity = _smoothingWeight * _pitchVelocity + (1 - _smoothingWeight) * pitchVelocity;
+            _yawVelocity = _smoothingWeight * _yawVelocity + (1 - _smoothingWeight) * yawVelocity;
+            _prevPosition = position;
+        }
+
+        [[nodiscard]] vector<SphericalPosition> PredictPositions(int offset, int windowLength) const {
+            auto position = _prevPosition;
+            vector<SphericalPosition> positions(windowLength);
+            for (auto k = 0; k < offset + windowLength; ++k) {
+                auto pitchVelocity = _pitchVelocity, yawVelocity = _yawVelocity;
+                if (const auto t = k + _time; t < _clusterCenters.extent(0))
+                    for (auto i = 0; i < _clusterCenters.extent(1); ++i) {
+                        const auto pitchDiffDegrees = _clusterCenters[t, i, 0] - position.PitchDegrees,
+                                   yawDiffDegrees = SphericalPosition::YawDifferenceDegrees(
+                                       position.YawDegrees, _clusterCenters[t, i, 1]);
+                        pitchVelocity += GravitationalVelocity(pitchDiffDegrees) * _clusterWeights[t, i];
+                        yawVelocity += GravitationalVelocity(yawDiffDegrees) * _clusterWeights[t, i];
+                    }
+                position.PitchDegrees = SphericalPosition::ClampPitchDegrees(position.PitchDegrees + pitchVelocity);
+                position.YawDegrees = SphericalPosition::WrapYawDegrees(position.YawDegrees + yawVelocity);
+                if (k >= offset) positions[k - offset] = position;
+            }
+            return positions;
+        }
+
+    private:
+        [[nodiscard]] double GravitationalVelocity(double diffDegrees) const {
+            auto direction = 0;
+            if (diffDegrees > 0 && diffDegrees <= _options.GravitationalFieldRangeDegrees) direction = 1;
+            else if (diffDegrees >= -_options.GravitationalFieldRangeDegrees && diffDegrees < 0) direction = -1;
+            return _options.GravitationalSpeedDps * direction;
+        }
+    };
+}
+
+TEST(GravitationalPredictorTest, ReferencePrediction) {
+    // Random clusters near a random walk, so that some clusters are in range and some wrap around in yaw.
+    constexpr auto TimeCount = 40, ClusterCount = 7;
+    mt19937 generator(1);
+    uniform_real_distribution stepDistribution(-15., 15.), offsetDistribution(-60., 60.), weightDistribution(0., 0.3);
+    vector<SphericalPosition> positions(30);
+    for (auto i = 1; i < positions.size(); ++i)
+        positions[i] = {
+            SphericalPosition::ClampPitchDegrees(positions[i - 1].PitchDegrees + stepDistribution(generator)),
+            SphericalPosition::WrapYawDegrees(positions[i - 1].YawDegrees + 4 * stepDistribution(generator))
+        };
+    mdarray<double, extents<size_t, dynamic_extent, dynamic_extent, 2>> clusterCenters(TimeCount, ClusterCount);
+    mdarray<double, dims<2>> clusterWeights(TimeCount, ClusterCount);
+    for (auto t = 0; t < TimeCount; ++t)
+        for (auto i = 0; i < ClusterCount; ++i) {
+            const auto position = positions[min(t, static_cast<int>(positions.size()) - 1)];
+            clusterCenters[t, i, 0] = SphericalPosition::ClampPitchDegrees(
+                position.PitchDegrees + offsetDistribution(generator));
+            clusterCenters[t, i, 1] = SphericalPosition::WrapYawDegrees(
+                position.YawDegrees + offsetDistribution(generator));
+            clusterWeights[t, i] = weightDistribution(generator);
+        }
+
+    GravitationalPredictorOptions options;
+    options.SmoothingHalfLifeSeconds = 2.;
+    options.GravitationalSpeedDps = 20.;
+    GravitationalPredictor predictor(1., clusterCenters.to_mdspan(), clusterWeights.to_mdspan(), options);
+    ReferencePredictor referencePredictor(options, clusterCenters, clusterWeights);
+    for (const auto position : positions) {
+        predictor.Update(span(&position, 1));
+        referencePredictor.Update(position);
+        // Windows extend past the end of the cluster data for the last positions.
+        for (const auto [offset, windowLength] : {pair(0, 3), pair(2, 5), pair(4, 8)}) {
+            const auto predictedPositions = predictor.PredictPositions(offset, windowLength);
+            const auto expectedPositions = referencePredictor.PredictPositions(offset, windowLength);
+            ASSERT_EQ(predictedPositions.size(), expectedPositions.size());
+            for (auto k = 0; k < windowLength; ++k) {
+                EXPECT_DOUBLE_EQ(predictedPositions[k].PitchDegrees, expectedPositions[k].PitchDegrees);
+                EXPECT_DOUBLE_EQ(predictedPositions[k].YawDegrees, expectedPositions[k].YawDegrees);
+            }
+        }
+    }
+}
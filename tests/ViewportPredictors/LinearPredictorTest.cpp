@@ -24,3 +24,37 @@ TEST(LinearPredictorTest, BasicPrediction) {
     predictor.Update(positions);
     EXPECT_EQ(predictor.PredictPositions(0., 2.), vector<SphericalPosition>({{0., -110.}, {0., -60.}}));
 }
+
+TEST(LinearPredictorTest, BufferedPrediction) {
+    LinearPredictorOptions options;
+    options.HistorySeconds = 4.;
+    LinearPredictor predictor(1., options);
+    const vector<SphericalPosition> positions = {{0., 0.}, {10., 10.}};
+    predictor.Update(positions);
+
+    vector<SphericalPosition> buffer;
+    const auto predictedPositions = predictor.PredictPositions(0., 2., buffer);
+    EXPECT_EQ(predictedPositions.data(), buffer.data());
+    EXPECT_EQ(vector(from_range, predictedPositions), predictor.PredictPositions(0., 2.));
+
+    const auto capacity = buffer.capacity();
+    predictor.Update(positions);
+    EXPECT_EQ(predictor.PredictPositions(0., 2., buffer).size(), 2);
+    EXPECT_EQ(buffer.capacity(), capacity);
+}
+
+TEST(LinearPredictorTest, RollingPrediction) {
+    LinearPredictorOptions options;
+    options.HistorySeconds = 4.;
+    LinearPredictor predictor(1., options);
+
+    for (auto i = 0; i < 20; ++i) {
+        const vector<SphericalPosition> positions = {{i % 2 * 10., SphericalPosition::WrapYawDegrees(i * 70.)}};
+        predictor.Update(positions);
+    }
+    const auto predictedPositions = predictor.PredictPositions(1., 2.);
+    EXPECT_NEAR(predictedPositions[0].PitchDegrees, 12., 1e-9);
+    EXPECT_NEAR(predictedPositions[0].YawDegrees, SphericalPosition::WrapYawDegrees(21 * 70.), 1e-9);
+    EXPECT_NEAR(predictedPositions[1].PitchDegrees, 14., 1e-9);
+    EXPECT_NEAR(predictedPositions[1].YawDegrees, SphericalPosition::WrapYawDegrees(22 * 70.), 1e-9);
+}
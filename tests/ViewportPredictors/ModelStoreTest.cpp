@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+
+import System.Base;
+
+import ABRSimulation360.ViewportPredictors.ModelStore;
+
+using namespace std;
+
+TEST(ModelStoreTest, SharedLoading) {
+    const auto path = filesystem::temp_directory_path() / "ModelStoreTest.txt";
+    ofstream(path) << 1;
+    ModelStore::Clear();
+
+    atomic loadCount = 0;
+    const auto Load = [&](const filesystem::path &modelPath) {
+        ++loadCount;
+        int value;
+        ifstream(modelPath) >> value;
+        return value;
+    };
+    vector<shared_ptr<const int>> models(8);
+    vector<thread> threads;
+    for (auto &model : models) threads.emplace_back([&] { model = ModelStore::Load<int>(path, Load); });
+    for (auto &thread : threads) thread.join();
+    EXPECT_EQ(loadCount, 1);
+    for (const auto &model : models) EXPECT_EQ(model, models.front());
+    EXPECT_EQ(*models.front(), 1);
+
+    EXPECT_NE(static_pointer_cast<const void>(ModelStore::Load<double>(path, Load)),
+              static_pointer_cast<const void>(models.front()));
+    EXPECT_EQ(loadCount, 2);
+
+    ofstream(path) << 2;
+    filesystem::last_write_time(path, filesystem::last_write_time(path) + 1s);
+    EXPECT_EQ(*ModelStore::Load<int>(path, Load), 2);
+    EXPECT_EQ(*models.front(), 1);
+    EXPECT_EQ(loadCount, 3);
+}
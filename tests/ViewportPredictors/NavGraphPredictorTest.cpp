@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+import System.Base;
+import System.MDArray;
+
+import ABRSimulation360.Base;
+import ABRSimulation360.ViewportPredictors.NavGraphPredictor;
+
+using namespace std;
+using namespace experimental;
+
+namespace {
+    using Node = pair<int, int>;
+
+    // Predicts positions by propagating distributions over a map of transitions per time step,
+    // as navigation graph predictors did before they moved to compressed sparse rows.
+    vector<SphericalPosition> ReferencePredictions(const vector<map<Node, vector<pair<Node, double>>>> &navGraph,
+                                                   double binWidthDegrees, int time, Node prevNode,
+                                                   int offset, int windowLength) {
+        map<Node, double> prevDistribution = {{prevNode, 1.}};
+        vector<SphericalPosition> positions(windowLength);
+        for (auto k = 0; k < offset + windowLength; ++k) {
+            map<Node, double> distribution;
+            if (const auto t = k + time; t < navGraph.size())
+                for (const auto [node, prevProbability] : prevDistribution)
+                    if (const auto it = navGraph[t].find(node); it != navGraph[t].cend())
+                        for (const auto [destinationNode, probability] : it->second)
+                            distribution[destinationNode] += probability * prevProbability;
+                    else distribution[node] += prevProbability;
+            if (k >= offset)
+                for (const auto [node, probability] : distribution) {
+                    positions[k - offset].PitchDegrees += node.first * binWidthDegrees * probability;
+                    positions[k - offset].YawDegrees += node.second * binWidthDegrees * probability;
+                }
+            if (!distribution.empty()) prevDistribution = move(distribution);
+        }
+        return positions;
+    }
+}
+
+TEST(NavGraphPredictorTest, ReferencePrediction) {
+    // A random navigation graph with repeated sources, sources without transitions, and unused padding.
+    constexpr auto TimeCount = 12, SourceCount = 4, DestinationCount = 3;
+    mt19937 generator(1);
+    uniform_int_distribution pitchDistribution(-2, 2), yawDistribution(-3, 3), countDistribution(1, SourceCount);
+    uniform_real_distribution probabilityDistribution(0.1, 1.);
+    mdarray<int, extents<size_t, dynamic_extent, dynamic_extent, 2>> sourceNodes(TimeCount, SourceCount);
+    mdarray<int, extents<size_t, dynamic_extent, dynamic_extent, dynamic_extent, 2>> destinationNodes(
+        TimeCount, SourceCount, DestinationCount);
+    mdarray<double, dims<3>> probabilities(TimeCount, SourceCount, DestinationCount);
+    vector<map<Node, vector<pair<Node, double>>>> navGraph(TimeCount);
+    for (auto t = 0; t < TimeCount; ++t) {
+        const auto sourceCount = countDistribution(generator);
+        for (auto s = 0; s < sourceCount; ++s) {
+            const Node sourceNode = {pitchDistribution(generator), yawDistribution(generator)};
+            sourceNodes[t, s, 0] = sourceNode.first, sourceNodes[t, s, 1] = sourceNode.second;
+            const auto destinationCount = min(countDistribution(generator), DestinationCount);
+            vector<pair<Node, double>> transitions;
+            for (auto d = 0; d < destinationCount; ++d) {
+                const Node destinationNode = {pitchDistribution(generator), yawDistribution(generator)};
+                destinationNodes[t, s, d, 0] = destinationNode.first;
+                destinationNodes[t, s, d, 1] = destinationNode.second;
+                probabilities[t, s, d] = probabilityDistribution(generator);
+                transitions.emplace_back(destinationNode, probabilities[t, s, d]);
+            }
+            navGraph[t].emplace(sourceNode, move(transitions));
+        }
+    }
+
+    NavGraphPredictorOptions options;
+    options.BinWidthDegrees = 10.;
+    NavGraphPredictor predictor(1., sourceNodes.to_mdspan(), destinationNodes.to_mdspan(),
+                                probabilities.to_mdspan(), options);
+    const vector<SphericalPosition> positions = {{0., 0.}, {12., -8.}, {-21., 29.}, {0., 0.}, {80., 150.}};
+    auto time = 0;
+    for (const auto position : positions) {
+        predictor.Update(span(&position, 1));
+        ++time;
+        const Node prevNode = {
+            static_cast<int>(lround(position.PitchDegrees / 10.)), static_cast<int>(lround(position.YawDegrees / 10.))
+        };
+        // Overlapping windows share propagation, and windows extend past the end of the navigation graph.
+        for (const auto [offset, windowLength] : {pair(0, 3), pair(2, 4), pair(1, 2), pair(5, 10)}) {
+            const auto predictedPositions = predictor.PredictPositions(offset, windowLength);
+            const auto expectedPositions = ReferencePredictions(navGraph, 10., time, prevNode, offset, windowLength);
+            ASSERT_EQ(predictedPositions.size(), expectedPositions.size());
+            for (auto k = 0; k < windowLength; ++k) {
+                EXPECT_DOUBLE_EQ(predictedPositions[k].PitchDegrees, expectedPositions[k].PitchDegrees);
+                EXPECT_DOUBLE_EQ(predictedPositions[k].YawDegrees, expectedPositions[k].YawDegrees);
+            }
+        }
+    }
+}
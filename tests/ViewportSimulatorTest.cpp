@@ -107,3 +107,149 @@ TEST(ViewportSimulatorTest, WithoutTiling) {
     EXPECT_EQ(simulator.ToDistribution({0., 45.}), vector({0., 0.5, 0., 0., 0., 0.5}));
     EXPECT_EQ(simulator.ToDistribution({0., 135.}), vector({0., 0.5, 0., 0., 0.5, 0.}));
 }
+
+TEST(ViewportSimulatorTest, Precomputation) {
+    ViewportSimulator exactSimulator({60., 1.}, 2);
+    ViewportSimulator lookupSimulator({60., 1.}, 2, {.GridDegrees = 45.});
+    ViewportSimulator interpolatingSimulator({60., 1.}, 2, {.GridDegrees = 45., .Interpolates = true});
+
+    const vector<SphericalPosition> positions = {
+        {0., -180.}, {0., -135.}, {0., -90.}, {0., -45.}, {0., 0.}, {0., 45.}, {0., 90.}, {0., 135.},
+        {45., 0.}, {-45., 90.}, {90., 0.}, {-90., 0.}
+    };
+    for (const auto position : positions) {
+        EXPECT_EQ(lookupSimulator.ToDistribution(position), exactSimulator.ToDistribution(position));
+        EXPECT_EQ(interpolatingSimulator.ToDistribution(position), exactSimulator.ToDistribution(position));
+    }
+    EXPECT_DOUBLE_EQ(lookupSimulator.ApproximationError(positions), 0.);
+    EXPECT_DOUBLE_EQ(interpolatingSimulator.ApproximationError(positions), 0.);
+
+    // Positions between grid points are looked up from the surrounding grid points.
+    const vector<SphericalPosition> offGridPositions = {{10., 20.}, {-30., 100.}, {60., -150.}, {5., -40.}};
+    for (const auto position : offGridPositions) {
+        EXPECT_EQ(lookupSimulator.ToDistribution(position), exactSimulator.ToDistribution(position));
+        EXPECT_NEAR(ranges::fold_left(interpolatingSimulator.ToDistribution(position), 0., plus()), 1., 1e-12);
+    }
+    EXPECT_DOUBLE_EQ(lookupSimulator.ApproximationError(offGridPositions), 0.);
+    const auto error = interpolatingSimulator.ApproximationError(offGridPositions);
+    EXPECT_GT(error, 0.1);
+    EXPECT_LT(error, 0.25);
+    ViewportSimulator fineSimulator({60., 1.}, 2, {.GridDegrees = 5., .Interpolates = true});
+    EXPECT_LT(fineSimulator.ApproximationError(offGridPositions), error);
+}
+
+TEST(ViewportSimulatorTest, BatchedSimulation) {
+    ViewportSimulator simulator({90., 16 / 9.}, 4);
+
+    vector<SphericalPosition> positions;
+    for (auto pitchDegrees = -90.; pitchDegrees <= 90.; pitchDegrees += 15.)
+        for (auto yawDegrees = -180.; yawDegrees < 180.; yawDegrees += 10.)
+            positions.push_back({pitchDegrees, yawDegrees});
+
+    vector expectedDistribution(6 * 4 * 4, 0.);
+    for (const auto position : positions) expectedDistribution += simulator.ToDistribution(position);
+    expectedDistribution /= static_cast<double>(positions.size());
+    EXPECT_EQ(simulator.ToDistribution(positions), expectedDistribution);
+}
+
+TEST(ViewportSimulatorTest, Kernels) {
+    mt19937 generator(42);
+    uniform_real_distribution pitchDistribution(-90., 90.), yawDistribution(-180., 180.);
+    vector<SphericalPosition> positions(200);
+    for (auto &position : positions) position = {pitchDistribution(generator), yawDistribution(generator)};
+
+    for (const auto tilingCount : {1, 3, 4, 8}) {
+        ViewportSimulator scalarSimulator({90., 16 / 9.}, tilingCount);
+        scalarSimulator.SetKernel(VisibilityKernel::Scalar);
+        for (const auto kernel : {VisibilityKernel::AVX2, VisibilityKernel::AVX512}) {
+            if (!ViewportSimulator::IsSupported(kernel)) continue;
+            ViewportSimulator simulator({90., 16 / 9.}, tilingCount);
+            simulator.SetKernel(kernel);
+            EXPECT_EQ(simulator.Kernel(), kernel);
+            for (const auto position : positions)
+                EXPECT_EQ(simulator.ToDistribution(position), scalarSimulator.ToDistribution(position));
+        }
+    }
+    EXPECT_TRUE(ViewportSimulator::IsSupported(ViewportSimulator::SupportedKernel()));
+}
+
+TEST(ViewportSimulatorTest, SparseSimulation) {
+    vector<SphericalPosition> positions;
+    for (auto pitchDegrees = -10.; pitchDegrees <= 10.; pitchDegrees += 5.)
+        for (auto yawDegrees = 20.; yawDegrees <= 40.; yawDegrees += 5.)
+            positions.push_back({pitchDegrees, yawDegrees});
+
+    for (const auto gridDegrees : {0., 1.}) {
+        ViewportSimulator simulator({60., 16 / 9.}, 8, {.GridDegrees = gridDegrees});
+        const auto expectedDistribution = simulator.ToDistribution(positions);
+        const auto distribution = simulator.ToSparseDistribution(positions);
+        EXPECT_EQ(distribution.TileCount, 6 * 8 * 8);
+        EXPECT_LT(distribution.TileIDs.size(), 6 * 8 * 8 / 4);
+        EXPECT_TRUE(ranges::is_sorted(distribution.TileIDs));
+        vector<double> denseDistribution(6 * 8 * 8);
+        distribution.ToDense(denseDistribution);
+        EXPECT_EQ(denseDistribution, expectedDistribution);
+    }
+
+    const vector tileIDs = {1, 4};
+    const vector weights = {0.25, 0.75};
+    const SparseDistributionView distribution = {6, tileIDs, weights};
+    vector<double> mixedDistribution(6);
+    distribution.MixUniform(0.4).ToDense(mixedDistribution);
+    const vector expectedDistribution = {0.1, 0.2, 0.1, 0.1, 0.4, 0.1};
+    for (auto i = 0; i < 6; ++i) EXPECT_DOUBLE_EQ(mixedDistribution[i], expectedDistribution[i]);
+    SparseDistribution denseDistribution;
+    denseDistribution.Assign(span<const double>(vector({0., 0.25, 0., 0., 0.75, 0.})));
+    EXPECT_EQ(denseDistribution.TileIDs, tileIDs);
+    EXPECT_EQ(denseDistribution.Weights, weights);
+}
+
+TEST(ViewportSimulatorTest, DilatedSimulation) {
+    DilatedViewportSimulator simulator({60., 1.}, 2, 0.25);
+
+    const vector<SphericalPosition> positions = {{0., -90.}, {0., 0.}};
+    simulator.SetPositions(positions);
+    EXPECT_EQ(vector(from_range, simulator.ToDistribution(0.)),
+              ViewportSimulator({60., 1.}, 2).ToDistribution(positions));
+    EXPECT_EQ(vector(from_range, simulator.ToDistribution(0.45)),
+              ViewportSimulator({120., 1.}, 2).ToDistribution(positions));
+    EXPECT_EQ(vector(from_range, simulator.ToDistribution(0.55)),
+              ViewportSimulator({120., 1.}, 2).ToDistribution(positions));
+    EXPECT_EQ(simulator.HitCount(), 1);
+    EXPECT_EQ(simulator.MissCount(), 2);
+
+    simulator.SetPositions(positions);
+    EXPECT_EQ(vector(from_range, simulator.ToDistribution(0.5)),
+              ViewportSimulator({120., 1.}, 2).ToDistribution(positions));
+    EXPECT_EQ(simulator.HitCount(), 1);
+    EXPECT_EQ(simulator.MissCount(), 3);
+    EXPECT_EQ(simulator.SimulatorCount(), 2);
+}
+
+TEST(ViewportSimulatorTest, UnquantizedDilatedSimulation) {
+    DilatedViewportSimulator simulator({60., 1.}, 2);
+
+    const vector<SphericalPosition> positions = {{0., -90.}, {0., 0.}};
+    const auto Dilation = [](int segmentID) { return 0.3 + segmentID * 0.001; };
+    for (auto segmentID = 0; segmentID < 100; ++segmentID) {
+        simulator.SetPositions(positions);
+        const auto dilation = Dilation(segmentID);
+        EXPECT_EQ(vector(from_range, simulator.ToDistribution<true>(dilation)),
+                  ViewportSimulator({(1 - dilation) * 60. + dilation * 180., 1.}, 2).ToDistribution(positions));
+        EXPECT_LE(simulator.SimulatorCount(), DilatedViewportSimulator::MaxSimulatorCount);
+    }
+    EXPECT_EQ(simulator.SimulatorCount(), DilatedViewportSimulator::MaxSimulatorCount);
+    EXPECT_EQ(simulator.MissCount(), 100);
+    EXPECT_EQ(simulator.FrustumTestCount(), 100 * ssize(positions));
+
+    // Recently used dilations are kept while older ones are evicted and rebuilt.
+    simulator.SetPositions(positions);
+    const auto distribution = vector(from_range, simulator.ToDistribution(Dilation(99)));
+    EXPECT_EQ(vector(from_range, simulator.ToDistribution(Dilation(99))), distribution);
+    EXPECT_EQ(simulator.HitCount(), 1);
+    EXPECT_EQ(vector(from_range, simulator.ToDistribution(Dilation(0))),
+              ViewportSimulator({(1 - Dilation(0)) * 60. + Dilation(0) * 180., 1.}, 2).ToDistribution(positions));
+    EXPECT_EQ(simulator.MissCount(), 102);
+    EXPECT_EQ(simulator.FrustumTestCount(), 100 * ssize(positions));
+    EXPECT_EQ(simulator.SimulatorCount(), DilatedViewportSimulator::MaxSimulatorCount);
+}